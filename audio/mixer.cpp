@@ -31,6 +31,68 @@
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
 
+#pragma mark -
+#pragma mark --- Atomics ---
+#pragma mark -
+
+// The control methods and mixCallback() exchange 32-bit words with acquire
+// and release semantics. Without compiler support, a full barrier is used,
+// or nothing at all for compilers only targeting single core systems.
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+
+static inline uint32 loadAcquire(const volatile uint32 *ptr) {
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void storeRelease(volatile uint32 *ptr, uint32 value) {
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline void fullBarrier() {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#else
+
+#if defined(__GNUC__)
+static inline void fullBarrier() {
+	__sync_synchronize();
+}
+#elif defined(_MSC_VER)
+#include <intrin.h>
+
+static inline void fullBarrier() {
+	long barrier = 0;
+	_InterlockedExchange(&barrier, 0);
+}
+#else
+static inline void fullBarrier() {
+}
+#endif
+
+static inline uint32 loadAcquire(const volatile uint32 *ptr) {
+	const uint32 value = *ptr;
+	fullBarrier();
+	return value;
+}
+
+static inline void storeRelease(volatile uint32 *ptr, uint32 value) {
+	fullBarrier();
+	*ptr = value;
+}
+
+#endif
+
+// Set on the thread running mixCallback() while it mixes, for the control
+// methods to tell when a stream calls them from the mixer.
+#if defined(__GNUC__)
+static __thread bool s_mixerThread = false;
+#elif defined(_MSC_VER)
+static __declspec(thread) bool s_mixerThread = false;
+#else
+static bool s_mixerThread = false;
+#endif
+
 
 namespace Audio {
 
@@ -80,8 +142,9 @@ public:
 	 *
 	 * @param paused true, when the channel should be paused.
 	 *               false when it should be unpaused.
+	 * @param time   time of the request, as returned by OSystem::getMillis()
 	 */
-	void pause(bool paused);
+	void pause(bool paused, uint32 time);
 
 	/**
 	 * Queries whether the channel is currently paused.
@@ -117,15 +180,21 @@ public:
 	int8 getBalance();
 
 	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
+	 * Sets the volume of the channel's sound type.
+	 *
+	 * @param volume new volume, 0 when the sound type is muted
 	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
+	void setTypeVolume(int volume);
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Queries the state getElapsedTime() computes the playing time from.
 	 */
-	Timestamp getElapsedTime();
+	void getTiming(uint32 &samplesConsumed, uint32 &mixerTimeStamp, uint32 &pauseTime, uint32 &pauseStartTime) const;
+
+	/**
+	 * Computes how long a channel has been playing from its timing state.
+	 */
+	static Timestamp getElapsedTime(uint rate, uint32 samplesConsumed, uint32 mixerTimeStamp, uint32 pauseTime, uint32 pauseStartTime, bool paused);
 
 	/**
 	 * Queries the channel's sound type.
@@ -153,6 +222,7 @@ private:
 
 	byte _volume;
 	int8 _balance;
+	int _typeVolume;
 
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
@@ -173,9 +243,22 @@ private:
 #pragma mark --- Mixer ---
 #pragma mark -
 
+/*
+ * The control methods only work on _channelInfo and queue the matching
+ * channel mutations, under _mutex. mixCallback() applies them before
+ * mixing, and publishes the status of each channel in _channelStatus for
+ * the control side to read, without ever taking _mutex.
+ *
+ * The mixer thread is the only one applying commands, and never blocks:
+ * the stop methods wait for a mixing in progress by watching _mixState.
+ * Nothing ever waits for the mixer while holding _mutex, as streams may
+ * call the control methods while mixed.
+ */
+
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _commandsQueued(0), _commandsApplied(0), _mixState(0) {
 
 	assert(sampleRate > 0);
 
@@ -184,6 +267,8 @@ MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
 }
 
 MixerImpl::~MixerImpl() {
+	applyCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
 }
@@ -196,10 +281,131 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
+bool MixerImpl::isActive(int index) const {
+	const uint32 handle = _channelInfo[index].handle;
+	return handle != 0xFFFFFFFF && loadAcquire(&_channelStatus[index].retired) != handle;
+}
+
+int MixerImpl::getTypeVolume(SoundType type) const {
+	return _soundTypeSettings[type].mute ? 0 : _soundTypeSettings[type].volume;
+}
+
+void MixerImpl::queueCommand(const Command &command) {
+	// The ring only fills up when the backend stops calling mixCallback().
+	// Let the mixer catch up then, without holding _mutex for a stream
+	// calling the control methods meanwhile. The last slots are kept for
+	// these streams, as the mixer thread cannot wait for itself.
+	if (!s_mixerThread && _commandsQueued - loadAcquire(&_commandsApplied) >= NUM_COMMANDS - NUM_MIXER_COMMANDS) {
+		warning("MixerImpl::queueCommand: waiting for the mixer");
+		while (_commandsQueued - loadAcquire(&_commandsApplied) >= NUM_COMMANDS - NUM_MIXER_COMMANDS) {
+			_mutex.unlock();
+			g_system->delayMillis(1);
+			_mutex.lock();
+		}
+	}
+
+	if (_commandsQueued - loadAcquire(&_commandsApplied) == NUM_COMMANDS) {
+		warning("MixerImpl::queueCommand: too many commands from the mixer thread");
+		return;
+	}
+
+	_commands[_commandsQueued % NUM_COMMANDS] = command;
+	storeRelease(&_commandsQueued, _commandsQueued + 1);
+}
+
+void MixerImpl::waitForMixing() {
+	// Callers may free streams not disposed by the mixer as soon as their
+	// channel is stopped. Any later mixCallback() stops the channel before
+	// mixing, so only a mixing already in progress has to be waited for.
+	// This is called without holding _mutex. A stream stopping a sound from
+	// the mixer thread has its command applied by the next mixCallback().
+	if (s_mixerThread)
+		return;
+
+	// Either the mixing seen here is waited for, or the next one sees the
+	// commands queued before
+	fullBarrier();
+	const uint32 state = loadAcquire(&_mixState);
+	while ((state & 1) && loadAcquire(&_mixState) == state)
+		g_system->delayMillis(1);
+}
+
+void MixerImpl::applyCommands() {
+	const uint32 queued = loadAcquire(&_commandsQueued);
+
+	for (uint32 applied = _commandsApplied; applied != queued; applied++) {
+		const Command &command = _commands[applied % NUM_COMMANDS];
+		Channel *chan = command.type == Command::kSetTypeVolume ? 0 : _channels[command.index];
+
+		switch (command.type) {
+		case Command::kPlay:
+			delete chan;
+			_channels[command.index] = command.channel;
+			break;
+
+		case Command::kStop:
+			if (chan && chan->getHandle()._val == command.handle) {
+				delete chan;
+				_channels[command.index] = 0;
+			}
+			break;
+
+		case Command::kPause:
+			if (chan && chan->getHandle()._val == command.handle)
+				chan->pause(command.value != 0, command.time);
+			break;
+
+		case Command::kSetVolume:
+			if (chan && chan->getHandle()._val == command.handle)
+				chan->setVolume(command.value);
+			break;
+
+		case Command::kSetBalance:
+			if (chan && chan->getHandle()._val == command.handle)
+				chan->setBalance(command.value);
+			break;
+
+		case Command::kSetTypeVolume:
+			for (int i = 0; i != NUM_CHANNELS; i++) {
+				if (_channels[i] && _channels[i]->getType() == command.index)
+					_channels[i]->setTypeVolume(command.value);
+			}
+			break;
+		}
+	}
+
+	storeRelease(&_commandsApplied, queued);
+}
+
+void MixerImpl::publishStatus(int index) {
+	ChannelStatus &status = _channelStatus[index];
+	const Channel *chan = _channels[index];
+
+	const uint32 seq = status.seq;
+	status.seq = seq + 1;
+	fullBarrier();
+
+	if (chan) {
+		uint32 samplesConsumed, mixerTimeStamp, pauseTime, pauseStartTime;
+		chan->getTiming(samplesConsumed, mixerTimeStamp, pauseTime, pauseStartTime);
+
+		status.handle = chan->getHandle()._val;
+		status.samplesConsumed = samplesConsumed;
+		status.mixerTimeStamp = mixerTimeStamp;
+		status.pauseTime = pauseTime;
+		status.pauseStartTime = pauseStartTime;
+		status.paused = chan->isPaused();
+	} else {
+		status.handle = 0xFFFFFFFF;
+	}
+
+	storeRelease(&status.seq, seq + 2);
+}
+
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
+		if (!isActive(i)) {
 			index = i;
 			break;
 		}
@@ -210,8 +416,6 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
@@ -219,6 +423,23 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	ChannelInfo &info = _channelInfo[index];
+	info.handle = chanHandle._val;
+	info.id = chan->getId();
+	info.type = chan->getType();
+	info.permanent = chan->isPermanent();
+	info.volume = chan->getVolume();
+	info.balance = chan->getBalance();
+
+	Command command = { Command::kPlay, index, chanHandle._val, chan, 0, 0 };
+	queueCommand(command);
+}
+
+void MixerImpl::stopChannel(int index) {
+	Command command = { Command::kStop, index, _channelInfo[index].handle, 0, 0, 0 };
+	_channelInfo[index].handle = 0xFFFFFFFF;
+	queueCommand(command);
 }
 
 void MixerImpl::playStream(
@@ -242,7 +463,7 @@ void MixerImpl::playStream(
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+			if (isActive(i) && _channelInfo[i].id == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -261,6 +482,7 @@ void MixerImpl::playStream(
 
 	// Create the channel
 	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	chan->setTypeVolume(getTypeVolume(type));
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -269,8 +491,6 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -282,13 +502,23 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
+	// Odd while mixing, for the stop methods to wait on
+	const uint32 state = _mixState;
+	_mixState = state + 1;
+	fullBarrier();
+	s_mixerThread = true;
+
+	applyCommands();
+
 	// mix all channels
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
+				const uint32 handle = _channels[i]->getHandle()._val;
 				delete _channels[i];
 				_channels[i] = 0;
+				storeRelease(&_channelStatus[i].retired, handle);
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
 
@@ -297,49 +527,58 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 			}
 		}
 
+		publishStatus(i);
+	}
+
+	s_mixerThread = false;
+	storeRelease(&_mixState, state + 2);
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	{
+		Common::StackLock lock(_mutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (isActive(i) && !_channelInfo[i].permanent)
+				stopChannel(i);
 		}
 	}
+	waitForMixing();
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	{
+		Common::StackLock lock(_mutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (isActive(i) && _channelInfo[i].id == id)
+				stopChannel(i);
 		}
 	}
+	waitForMixing();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	delete _channels[index];
-	_channels[index] = 0;
+	{
+		Common::StackLock lock(_mutex);
+
+		// Simply ignore stop requests for handles of sounds that already terminated.
+		// A stream may have stopped it from the mixer, which is still waited for.
+		const int index = handle._val % NUM_CHANNELS;
+		if (isActive(index) && _channelInfo[index].handle == handle._val)
+			stopChannel(index);
+	}
+	waitForMixing();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	Command command = { Command::kSetTypeVolume, type, 0, 0, getTypeVolume(type), 0 };
+	queueCommand(command);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
@@ -351,36 +590,44 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isActive(index) || _channelInfo[index].handle != handle._val)
 		return;
 
-	_channels[index]->setVolume(volume);
+	_channelInfo[index].volume = volume;
+	Command command = { Command::kSetVolume, index, handle._val, 0, volume, 0 };
+	queueCommand(command);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isActive(index) || _channelInfo[index].handle != handle._val)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _channelInfo[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isActive(index) || _channelInfo[index].handle != handle._val)
 		return;
 
-	_channels[index]->setBalance(balance);
+	_channelInfo[index].balance = balance;
+	Command command = { Command::kSetBalance, index, handle._val, 0, balance, 0 };
+	queueCommand(command);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isActive(index) || _channelInfo[index].handle != handle._val)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _channelInfo[index].balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -388,20 +635,36 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const ChannelStatus &status = _channelStatus[index];
+
+	uint32 seq, samplesConsumed, mixerTimeStamp, pauseTime, pauseStartTime, paused;
+	bool valid;
+	do {
+		seq = loadAcquire(&status.seq);
+		valid = status.handle == handle._val;
+		samplesConsumed = status.samplesConsumed;
+		mixerTimeStamp = status.mixerTimeStamp;
+		pauseTime = status.pauseTime;
+		pauseStartTime = status.pauseStartTime;
+		paused = status.paused;
+		fullBarrier();
+	} while ((seq & 1) || status.seq != seq);
+
+	// Sounds which did not get mixed yet did not start playing either
+	if (!valid)
 		return Timestamp(0, _sampleRate);
 
-	return _channels[index]->getElapsedTime();
+	return Channel::getElapsedTime(_sampleRate, samplesConsumed, mixerTimeStamp, pauseTime, pauseStartTime, paused != 0);
 }
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
+	const uint32 time = g_system->getMillis(true);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
+		if (isActive(i)) {
+			Command command = { Command::kPause, i, _channelInfo[i].handle, 0, paused, time };
+			queueCommand(command);
 		}
 	}
 }
@@ -409,8 +672,9 @@ void MixerImpl::pauseAll(bool paused) {
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
+		if (isActive(i) && _channelInfo[i].id == id) {
+			Command command = { Command::kPause, i, _channelInfo[i].handle, 0, paused, g_system->getMillis(true) };
+			queueCommand(command);
 			return;
 		}
 	}
@@ -421,10 +685,11 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 
 	// Simply ignore (un)pause requests for sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isActive(index) || _channelInfo[index].handle != handle._val)
 		return;
 
-	_channels[index]->pause(paused);
+	Command command = { Command::kPause, index, handle._val, 0, paused, g_system->getMillis(true) };
+	queueCommand(command);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
@@ -435,7 +700,7 @@ bool MixerImpl::isSoundIDActive(int id) {
 #endif
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (isActive(i) && _channelInfo[i].id == id)
 			return true;
 	return false;
 }
@@ -443,8 +708,8 @@ bool MixerImpl::isSoundIDActive(int id) {
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	if (isActive(index) && _channelInfo[index].handle == handle._val)
+		return _channelInfo[index].id;
 	return 0;
 }
 
@@ -456,13 +721,13 @@ bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 #endif
 
 	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return isActive(index) && _channelInfo[index].handle == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (isActive(i) && _channelInfo[i].type == type)
 			return true;
 	return false;
 }
@@ -482,10 +747,8 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].volume = volume;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	Command command = { Command::kSetTypeVolume, type, 0, 0, getTypeVolume(type), 0 };
+	queueCommand(command);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -502,7 +765,7 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
                  DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
+      _balance(0), _typeVolume(Mixer::kMaxMixerVolume), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
@@ -534,6 +797,11 @@ int8 Channel::getBalance() {
 	return _balance;
 }
 
+void Channel::setTypeVolume(int volume) {
+	_typeVolume = volume;
+	updateChannelVolumes();
+}
+
 void Channel::updateChannelVolumes() {
 	// From the channel balance/volume and the global volume, we compute
 	// the effective volume for the left and right channel. Note the
@@ -543,59 +811,61 @@ void Channel::updateChannelVolumes() {
 	// volume is in the range 0 - kMaxMixerVolume.
 	// Hence, the vol_l/vol_r values will be in that range, too
 
-	if (!_mixer->isSoundTypeMuted(_type)) {
-		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
-
-		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
-		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
-		}
+	int vol = _typeVolume * _volume;
+
+	if (_balance == 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = vol / Mixer::kMaxChannelVolume;
+	} else if (_balance < 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 	} else {
-		_volL = _volR = 0;
+		_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+		_volR = vol / Mixer::kMaxChannelVolume;
 	}
 }
 
-void Channel::pause(bool paused) {
+void Channel::pause(bool paused, uint32 time) {
 	//assert((paused && _pauseLevel >= 0) || (!paused && _pauseLevel));
 
 	if (paused) {
 		_pauseLevel++;
 
 		if (_pauseLevel == 1)
-			_pauseStartTime = g_system->getMillis(true);
+			_pauseStartTime = time;
 	} else if (_pauseLevel > 0) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
+			_pauseTime = (time - _pauseStartTime);
 			_pauseStartTime = 0;
 		}
 	}
 }
 
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
+void Channel::getTiming(uint32 &samplesConsumed, uint32 &mixerTimeStamp, uint32 &pauseTime, uint32 &pauseStartTime) const {
+	samplesConsumed = _samplesConsumed;
+	mixerTimeStamp = _mixerTimeStamp;
+	pauseTime = _pauseTime;
+	pauseStartTime = _pauseStartTime;
+}
+
+Timestamp Channel::getElapsedTime(uint rate, uint32 samplesConsumed, uint32 mixerTimeStamp, uint32 pauseTime, uint32 pauseStartTime, bool paused) {
 	uint32 delta = 0;
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	if (mixerTimeStamp == 0)
 		return ts;
 
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
+	if (paused)
+		delta = pauseStartTime - mixerTimeStamp;
 	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
+		delta = g_system->getMillis(true) - mixerTimeStamp - pauseTime;
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
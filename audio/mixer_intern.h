@@ -51,9 +51,63 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		NUM_COMMANDS = 1024,        ///< pending commands, well beyond what a mixing interval sees
+		NUM_MIXER_COMMANDS = 64     ///< slots only used by streams calling from the mixer thread
 	};
 
+	/**
+	 * A channel mutation, queued by the control methods and applied by
+	 * mixCallback() before it mixes.
+	 */
+	struct Command {
+		enum Type {
+			kPlay,
+			kStop,
+			kPause,
+			kSetVolume,
+			kSetBalance,
+			kSetTypeVolume
+		};
+
+		Type type;
+		int index;          ///< channel slot, or sound type for kSetTypeVolume
+		uint32 handle;      ///< handle of the sound the command applies to
+		Channel *channel;   ///< channel to start, for kPlay
+		int value;          ///< pause flag, volume or balance
+		uint32 time;        ///< time of the call, for kPause
+	};
+
+	/** The control side view of a channel slot. */
+	struct ChannelInfo {
+		ChannelInfo() : handle(0xFFFFFFFF), id(-1), type(kPlainSoundType), permanent(false), volume(kMaxChannelVolume), balance(0) {}
+
+		uint32 handle;      ///< sound last started in the slot, 0xFFFFFFFF once stopped
+		int id;
+		SoundType type;
+		bool permanent;
+		byte volume;
+		int8 balance;
+	};
+
+	/**
+	 * The mixing side status of a channel slot, published by mixCallback()
+	 * for the control side to read without locking.
+	 */
+	struct ChannelStatus {
+		ChannelStatus() : seq(0), handle(0xFFFFFFFF), retired(0xFFFFFFFF), samplesConsumed(0), mixerTimeStamp(0), pauseTime(0), pauseStartTime(0), paused(0) {}
+
+		volatile uint32 seq;        ///< odd while the fields below are updated
+		volatile uint32 handle;
+		volatile uint32 retired;    ///< last sound of the slot that ended on its own
+		volatile uint32 samplesConsumed;
+		volatile uint32 mixerTimeStamp;
+		volatile uint32 pauseTime;
+		volatile uint32 pauseStartTime;
+		volatile uint32 paused;
+	};
+
+	/** Serializes the control methods, mixCallback() never takes it. */
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
@@ -68,6 +122,23 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+	ChannelInfo _channelInfo[NUM_CHANNELS];
+
+	/**
+	 * Single producer single consumer ring of pending channel mutations,
+	 * indexed by the running counts of queued and applied commands. The
+	 * control side queues under _mutex, only the mixer thread applies.
+	 */
+	Command _commands[NUM_COMMANDS];
+	volatile uint32 _commandsQueued;
+	volatile uint32 _commandsApplied;
+
+	/** Incremented when mixCallback() starts and ends mixing: odd while mixing. */
+	volatile uint32 _mixState;
+
+	ChannelStatus _channelStatus[NUM_CHANNELS];
+
+	/** Owned by the mixing side, only touched while applying commands or mixing. */
 	Channel *_channels[NUM_CHANNELS];
 
 
@@ -121,6 +192,15 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+private:
+	bool isActive(int index) const;
+	int getTypeVolume(SoundType type) const;
+	void stopChannel(int index);
+	void queueCommand(const Command &command);
+	void waitForMixing();
+	void applyCommands();
+	void publishStatus(int index);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -31,10 +31,19 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/config-manager.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RATE_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define RATE_USE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace Audio {
 
 
@@ -57,6 +66,119 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+#if defined(RATE_USE_SSE2)
+/**
+ * Multiply eight samples by their volume and divide by kMaxMixerVolume,
+ * rounding towards zero like the integer division of the scalar code.
+ */
+static inline __m128i applyVolume(__m128i samples, __m128i volume) {
+	const __m128i lo = _mm_mullo_epi16(samples, volume);
+	const __m128i hi = _mm_mulhi_epi16(samples, volume);
+	const __m128i mask = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), mask)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), mask)), 8);
+	return _mm_packs_epi32(p0, p1);
+}
+#elif defined(RATE_USE_NEON)
+static inline int16x4_t applyVolume(int16x4_t samples, int16x4_t volume) {
+	const int32x4_t mask = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+	int32x4_t p = vmull_s16(samples, volume);
+	p = vshrq_n_s32(vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), mask)), 8);
+	return vmovn_s32(p);
+}
+
+static inline int16x8_t applyVolume(int16x8_t samples, int16x8_t volume) {
+	return vcombine_s16(applyVolume(vget_low_s16(samples), vget_low_s16(volume)),
+	                    applyVolume(vget_high_s16(samples), vget_high_s16(volume)));
+}
+#endif
+
+/**
+ * Mix @p frames frames of converted samples from @p in into @p obuf, with
+ * the given volumes. @p in holds one sample per frame for mono, or
+ * interleaved left and right samples for stereo.
+ *
+ * The vector code needs the products to stay in 16 bits after dividing by
+ * kMaxMixerVolume: then the saturated sum is the same as clampedAdd().
+ * Larger volumes, which the mixer never passes, go through the scalar loop.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixBuffer(st_sample_t *obuf, const st_sample_t *in, int frames, st_volume_t vol_l, st_volume_t vol_r) {
+#if !defined(OUTPUT_UNSIGNED_AUDIO) && (defined(RATE_USE_SSE2) || defined(RATE_USE_NEON))
+	if (vol_l <= Audio::Mixer::kMaxMixerVolume && vol_r <= Audio::Mixer::kMaxMixerVolume) {
+		// Volumes in output order
+		const int16 vol0 = reverseStereo ? vol_r : vol_l;
+		const int16 vol1 = reverseStereo ? vol_l : vol_r;
+
+#if defined(RATE_USE_SSE2)
+		const __m128i volume = _mm_set_epi16(vol1, vol0, vol1, vol0, vol1, vol0, vol1, vol0);
+
+		if (stereo) {
+			for (; frames >= 4; frames -= 4) {
+				__m128i samples = _mm_loadu_si128((const __m128i *)in);
+				if (reverseStereo) {
+					samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+					samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+				}
+				const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+				_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, applyVolume(samples, volume)));
+				in += 8;
+				obuf += 8;
+			}
+		} else {
+			for (; frames >= 8; frames -= 8) {
+				const __m128i samples = _mm_loadu_si128((const __m128i *)in);
+				const __m128i out0 = _mm_loadu_si128((const __m128i *)obuf);
+				const __m128i out1 = _mm_loadu_si128((const __m128i *)(obuf + 8));
+				_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out0, applyVolume(_mm_unpacklo_epi16(samples, samples), volume)));
+				_mm_storeu_si128((__m128i *)(obuf + 8), _mm_adds_epi16(out1, applyVolume(_mm_unpackhi_epi16(samples, samples), volume)));
+				in += 8;
+				obuf += 16;
+			}
+		}
+#else
+		const int16 volumes[8] = { vol0, vol1, vol0, vol1, vol0, vol1, vol0, vol1 };
+		const int16x8_t volume = vld1q_s16(volumes);
+
+		if (stereo) {
+			for (; frames >= 4; frames -= 4) {
+				int16x8_t samples = vld1q_s16(in);
+				if (reverseStereo)
+					samples = vrev32q_s16(samples);
+				vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), applyVolume(samples, volume)));
+				in += 8;
+				obuf += 8;
+			}
+		} else {
+			for (; frames >= 8; frames -= 8) {
+				const int16x8x2_t samples = vzipq_s16(vld1q_s16(in), vld1q_s16(in));
+				vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), applyVolume(samples.val[0], volume)));
+				vst1q_s16(obuf + 8, vqaddq_s16(vld1q_s16(obuf + 8), applyVolume(samples.val[1], volume)));
+				in += 8;
+				obuf += 16;
+			}
+		}
+#endif
+	}
+#endif
+
+	for (; frames > 0; frames--) {
+		st_sample_t out0, out1;
+		out0 = *in++;
+		out1 = (stereo ? *in++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -178,6 +300,9 @@ protected:
 	/** fractional position increment in the output stream */
 	frac_t opos_inc;
 
+	/** interpolated samples waiting to be mixed */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 	/** last sample(s) in the input stream (left/right channel) */
 	st_sample_t ilast0, ilast1;
 	/** current sample(s) in the input stream (left/right channel) */
@@ -228,47 +353,51 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+		// Interpolate into outBuf first, then mix it into the output buffer
+		// in one go
+		st_sample_t *optr = outBuf;
+		const st_sample_t *optrEnd = outBuf + MIN<long>(ARRAYSIZE(outBuf), (oend - obuf) / (stereo ? 1 : 2));
+
+		while (optr < optrEnd) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						const int frames = (optr - outBuf) / (stereo ? 2 : 1);
+						mixBuffer<stereo, reverseStereo>(obuf, outBuf, frames, vol_l, vol_r);
+						obuf += frames * 2;
+						return (obuf - ostart) / 2;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			opos -= FRAC_ONE_LOW;
-		}
-
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
 
-			obuf += 2;
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && optr < optrEnd) {
+				// interpolate
+				*optr++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*optr++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
 
-			// Increment output position
-			opos += opos_inc;
+				// Increment output position
+				opos += opos_inc;
+			}
 		}
+
+		const int frames = (optr - outBuf) / (stereo ? 2 : 1);
+		mixBuffer<stereo, reverseStereo>(obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -293,10 +422,7 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
-		st_size_t len;
-
-		st_sample_t *ostart = obuf;
+		int len;
 
 		if (stereo)
 			osamp *= 2;
@@ -313,23 +439,13 @@ public:
 
 		// Read up to 'osamp' samples into our temporary buffer
 		len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		const int frames = len / (stereo ? 2 : 1);
+		mixBuffer<stereo, reverseStereo>(obuf, _buffer, frames, vol_l, vol_r);
+		return frames;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -341,9 +457,9 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool forceLinear) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if ((inrate % outrate) == 0 && (inrate < 65536) && !forceLinear) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -357,13 +473,22 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
  * Create and return a RateConverter object for the specified input and output rates.
  */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	const Common::String resampler = ConfMan.get("resampler");
+	const bool forceLinear = (resampler == "linear");
+
+	if (resampler == "sinc" && inrate != outrate) {
+		RateConverter *converter = makeSincRateConverter(inrate, outrate, stereo, reverseStereo);
+		if (converter)
+			return converter;
+	}
+
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, forceLinear);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, forceLinear);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, forceLinear);
 }
 
 } // End of namespace Audio
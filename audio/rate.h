@@ -46,7 +46,7 @@ enum {
 };
 
 static inline void clampedAdd(int16& a, int b) {
-	register int val;
+	int val;
 #ifdef OUTPUT_UNSIGNED_AUDIO
 	val = (a ^ 0x8000) + b;
 #else
@@ -78,8 +78,21 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
+/**
+ * Create a RateConverter for the given rates. The "resampler" config key
+ * selects the algorithm: "default" picks the cheapest exact converter,
+ * "linear" always interpolates and "sinc" uses the polyphase windowed sinc
+ * converter whenever it supports the rates.
+ */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
 
+/**
+ * Create a polyphase windowed sinc RateConverter. Returns 0 if the rates
+ * need too many filter phases, i.e. if outrate / gcd(inrate, outrate)
+ * exceeds 1024.
+ */
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+
 } // End of namespace Audio
 
 #endif
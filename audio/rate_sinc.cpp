@@ -0,0 +1,329 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * Polyphase windowed sinc rate converter.
+ *
+ * For input and output rates reducing to outrate/inrate = L/M, the output
+ * samples fall on L distinct positions (phases) between two input samples.
+ * A Blackman windowed sinc filter is computed for each of them when the
+ * converter is created, in 2.14 fixed point. Converting is then a matter of
+ * one dot product per output sample and channel, done in integer
+ * arithmetic with SSE2 or NEON where available.
+ *
+ * The filter spans 32 input samples when upsampling, and is widened
+ * accordingly when downsampling so that the cutoff follows the output rate.
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/mixer.h"
+#include "common/util.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SINC_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define SINC_USE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Audio {
+
+enum {
+	/** Largest number of phases, other rate pairs are left to the other converters. */
+	SINC_MAX_PHASES = 1024,
+	/** Filter length in input samples when upsampling. */
+	SINC_TAPS = 32,
+	/** Longest filter, limiting the downsampling ratio with a correct cutoff. */
+	SINC_MAX_TAPS = 256,
+	/** Fractional bits of the coefficients. */
+	SINC_COEF_BITS = 14,
+	/** Input samples read from the stream at once. */
+	SINC_INPUT_SIZE = 512
+};
+
+/**
+ * Dot product of @p count 16-bit values, @p count being a multiple of 8.
+ */
+static inline int32 sincDotProduct(const int16 *coefs, const int16 *samples, int count) {
+#if defined(SINC_USE_SSE2)
+	__m128i acc = _mm_setzero_si128();
+	for (int i = 0; i < count; i += 8) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coefs + i));
+		const __m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(c, s));
+	}
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(acc);
+#elif defined(SINC_USE_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for (int i = 0; i < count; i += 8) {
+		const int16x8_t c = vld1q_s16(coefs + i);
+		const int16x8_t s = vld1q_s16(samples + i);
+		acc = vmlal_s16(acc, vget_low_s16(c), vget_low_s16(s));
+		acc = vmlal_s16(acc, vget_high_s16(c), vget_high_s16(s));
+	}
+	int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	return vget_lane_s32(vpadd_s32(sum, sum), 0);
+#else
+	int32 acc0 = 0, acc1 = 0;
+	for (int i = 0; i < count; i += 2) {
+		acc0 += coefs[i] * samples[i];
+		acc1 += coefs[i + 1] * samples[i + 1];
+	}
+	return acc0 + acc1;
+#endif
+}
+
+static inline st_sample_t sincRound(int32 acc) {
+	acc = (acc + (1 << (SINC_COEF_BITS - 1))) >> SINC_COEF_BITS;
+	return (st_sample_t)CLIP<int32>(acc, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+}
+
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	st_sample_t _inBuf[SINC_INPUT_SIZE];
+
+	/** Filter coefficients, _taps for each of the _phases phases. */
+	int16 *_coefs;
+	int _phases;
+	int _taps;
+
+	/** Input samples, one row per channel, with _taps - 1 of history. */
+	int16 *_history[2];
+	int _historySize;
+	int _historyEnd;
+
+	/** First input sample of the filter window, in _history. */
+	int _pos;
+	/** Phase of the next output sample. */
+	int _phase;
+
+	/** Whole and fractional input samples between two output samples. */
+	int _posInc;
+	int _phaseInc;
+
+	bool fill(AudioStream &input);
+
+public:
+	SincRateConverter(int phases, int step, int taps, const int16 *coefs);
+	~SincRateConverter();
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(int phases, int step, int taps, const int16 *coefs)
+	: _phases(phases), _taps(taps), _pos(0), _phase(0), _posInc(step / phases), _phaseInc(step % phases) {
+	_coefs = new int16[phases * taps];
+	memcpy(_coefs, coefs, phases * taps * sizeof(int16));
+
+	_historySize = taps + SINC_INPUT_SIZE;
+	_history[0] = new int16[_historySize];
+	_history[1] = stereo ? new int16[_historySize] : 0;
+
+	// Start with the filter centered on the first input sample
+	_historyEnd = taps / 2 - 1;
+	memset(_history[0], 0, _historySize * sizeof(int16));
+	if (stereo)
+		memset(_history[1], 0, _historySize * sizeof(int16));
+}
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::~SincRateConverter() {
+	delete[] _coefs;
+	delete[] _history[0];
+	delete[] _history[1];
+}
+
+/*
+ * Make the window of the next output sample available in _history.
+ * Returns false if the input ran out first.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::fill(AudioStream &input) {
+	while (_pos + _taps > _historyEnd) {
+		// Drop the samples before the window
+		if (_pos > 0) {
+			const int keep = MAX(_historyEnd - _pos, 0);
+			memmove(_history[0], _history[0] + _pos, keep * sizeof(int16));
+			if (stereo)
+				memmove(_history[1], _history[1] + _pos, keep * sizeof(int16));
+			_historyEnd = keep;
+			_pos = 0;
+		}
+
+		const int room = MIN<int>(_historySize - _historyEnd, SINC_INPUT_SIZE / 2);
+		const int len = input.readBuffer(_inBuf, room * (stereo ? 2 : 1));
+		if (len <= 0)
+			return false;
+
+		const st_sample_t *in = _inBuf;
+		int16 *out0 = _history[0] + _historyEnd;
+		if (stereo) {
+			int16 *out1 = _history[1] + _historyEnd;
+			for (int i = 0; i < len / 2; i++) {
+				*out0++ = *in++;
+				*out1++ = *in++;
+			}
+			_historyEnd += len / 2;
+		} else {
+			for (int i = 0; i < len; i++)
+				*out0++ = *in++;
+			_historyEnd += len;
+		}
+	}
+
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+int SincRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart = obuf;
+	st_sample_t *oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		if (_pos + _taps > _historyEnd && !fill(input))
+			break;
+
+		// Produce as many samples as the buffered input allows
+		while (obuf < oend && _pos + _taps <= _historyEnd) {
+			const int16 *coefs = _coefs + _phase * _taps;
+
+			st_sample_t out0, out1;
+			out0 = sincRound(sincDotProduct(coefs, _history[0] + _pos, _taps));
+			out1 = (stereo ? sincRound(sincDotProduct(coefs, _history[1] + _pos, _taps)) : out0);
+
+			// output left channel
+			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+			// output right channel
+			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+			obuf += 2;
+
+			// Increment output position
+			_pos += _posInc;
+			_phase += _phaseInc;
+			if (_phase >= _phases) {
+				_phase -= _phases;
+				_pos++;
+			}
+		}
+	}
+
+	return (obuf - ostart) / 2;
+}
+
+#pragma mark -
+
+static st_rate_t gcd(st_rate_t a, st_rate_t b) {
+	while (b) {
+		const st_rate_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/**
+ * Compute the filter of each phase. Phase p gives the output sample at
+ * p / phases input samples past the center of the window.
+ */
+static void computeSincFilter(int16 *coefs, int phases, int taps, double cutoff) {
+	const double half = taps / 2.0;
+
+	for (int p = 0; p < phases; p++) {
+		double filter[SINC_MAX_TAPS];
+		double sum = 0.0;
+
+		for (int k = 0; k < taps; k++) {
+			// Distance between the input sample and the output sample
+			const double d = k - (taps / 2 - 1) - (double)p / phases;
+			const double x = d * cutoff * M_PI;
+			const double sinc = (x == 0.0) ? 1.0 : sin(x) / x;
+			const double w = d / half;
+			const double window = (fabs(w) >= 1.0) ? 0.0 : 0.42 + 0.5 * cos(M_PI * w) + 0.08 * cos(2.0 * M_PI * w);
+
+			filter[k] = sinc * window;
+			sum += filter[k];
+		}
+
+		// Normalize each phase to unity gain, and put the rounding error of
+		// the fixed point conversion on the largest coefficient
+		int total = 0, largest = 0;
+		for (int k = 0; k < taps; k++) {
+			coefs[p * taps + k] = (int16)floor(filter[k] / sum * (1 << SINC_COEF_BITS) + 0.5);
+			total += coefs[p * taps + k];
+			if (coefs[p * taps + k] > coefs[p * taps + largest])
+				largest = k;
+		}
+		coefs[p * taps + largest] += (1 << SINC_COEF_BITS) - total;
+	}
+}
+
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	const st_rate_t div = gcd(inrate, outrate);
+	const int phases = outrate / div;
+	const int step = inrate / div;
+
+	if (phases > SINC_MAX_PHASES)
+		return 0;
+
+	// Downsampling lowers the cutoff below the input Nyquist frequency,
+	// which takes a longer filter for the same transition band
+	double cutoff = 1.0;
+	int taps = SINC_TAPS;
+	if (step > phases) {
+		cutoff = (double)phases / step;
+		taps = MIN<int>((int)ceil(SINC_TAPS / cutoff), SINC_MAX_TAPS);
+		taps = (taps + 7) & ~7;
+	}
+	// Keep some room for the transition band below Nyquist
+	cutoff *= 0.95;
+
+	int16 *coefs = new int16[phases * taps];
+	computeSincFilter(coefs, phases, taps, cutoff);
+
+	RateConverter *converter;
+	if (stereo) {
+		if (reverseStereo)
+			converter = new SincRateConverter<true, true>(phases, step, taps, coefs);
+		else
+			converter = new SincRateConverter<true, false>(phases, step, taps, coefs);
+	} else {
+		converter = new SincRateConverter<false, false>(phases, step, taps, coefs);
+	}
+
+	delete[] coefs;
+	return converter;
+}
+
+} // End of namespace Audio
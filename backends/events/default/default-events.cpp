@@ -27,6 +27,8 @@
 #include "common/system.h"
 #include "common/config-manager.h"
 #include "common/translation.h"
+#include "common/memory-stats.h"
+
 #include "backends/events/default/default-events.h"
 #include "backends/keymapper/keymapper.h"
 #include "backends/keymapper/remap-dialog.h"
@@ -41,7 +43,9 @@ DefaultEventManager::DefaultEventManager(Common::EventSource *boss) :
 	_shouldQuit(false),
 	_shouldRTL(false),
 	_confirmExitDialogActive(false),
-	_shouldGenerateKeyRepeatEvents(true) {
+	_shouldGenerateKeyRepeatEvents(true),
+	_memoryStatsInterval(0),
+	_memoryStatsTime(0) {
 
 	assert(boss);
 
@@ -82,6 +86,10 @@ void DefaultEventManager::init() {
 		_vk->loadKeyboardPack("vkeybd_default");
 	}
 #endif
+
+	_memoryStatsFile = ConfMan.get("memstats_file");
+	if (!_memoryStatsFile.empty())
+		_memoryStatsInterval = MAX(ConfMan.getInt("memstats_interval"), 1) * 1000;
 }
 
 bool DefaultEventManager::pollEvent(Common::Event &event) {
@@ -91,6 +99,10 @@ bool DefaultEventManager::pollEvent(Common::Event &event) {
 		handleKeyRepeat();
 	}
 
+	if (_memoryStatsInterval) {
+		handleMemoryStatsDump();
+	}
+
 	if (_eventQueue.empty()) {
 		return false;
 	}
@@ -226,6 +238,18 @@ bool DefaultEventManager::pollEvent(Common::Event &event) {
 	return forwardEvent;
 }
 
+void DefaultEventManager::handleMemoryStatsDump() {
+	const uint32 time = g_system->getMillis(true);
+	if (time - _memoryStatsTime < _memoryStatsInterval)
+		return;
+
+	_memoryStatsTime = time;
+	if (!Common::MemoryStats::dumpToFile(_memoryStatsFile)) {
+		warning("Could not write memory statistics to '%s'", _memoryStatsFile.c_str());
+		_memoryStatsInterval = 0;
+	}
+}
+
 void DefaultEventManager::handleKeyRepeat() {
 	uint32 time = g_system->getMillis(true);
 
@@ -72,6 +72,13 @@ class DefaultEventManager : public Common::EventManager, Common::EventObserver {
 	uint32 _keyRepeatTime;
 
 	void handleKeyRepeat();
+
+	// for periodic dumps of the memory statistics
+	Common::String _memoryStatsFile;
+	uint32 _memoryStatsInterval;
+	uint32 _memoryStatsTime;
+
+	void handleMemoryStatsDump();
 public:
 	DefaultEventManager(Common::EventSource *boss);
 	~DefaultEventManager();
@@ -173,6 +173,15 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieve the size and last modification time of the file referred by
+	 * this path. Backends which cannot tell keep the default implementation.
+	 *
+	 * @return bool true on success, false if the path is not a file or its
+	 *         stats are unavailable.
+	 */
+	virtual bool getFileStats(uint32 &size, uint32 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -0,0 +1,76 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Re-enable some forbidden symbols to avoid clashes with stat.h and unistd.h.
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+#define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
+
+#include "backends/fs/posix/mmapstream.h"
+
+#ifdef USE_MMAP_STREAM
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Smaller files are read through stdio, which costs less than setting up and
+// tearing down a mapping for a few buffered reads.
+#define MMAP_STREAM_MIN_SIZE (64 * 1024)
+
+// Bigger files are read through stdio on 32 bit hosts, so that a few large
+// videos or archives do not exhaust the address space.
+#ifdef SCUMM_64BITS
+#define MMAP_STREAM_MAX_SIZE 0x7FFFFFFF
+#else
+#define MMAP_STREAM_MAX_SIZE (64 * 1024 * 1024)
+#endif
+
+MmapReadStream *MmapReadStream::makeFromPath(const Common::String &path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= MMAP_STREAM_MIN_SIZE && st.st_size <= MMAP_STREAM_MAX_SIZE)
+		data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping stays valid once the file is closed
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return 0;
+	return new MmapReadStream((const byte *)data, (uint32)st.st_size);
+}
+
+MmapReadStream::MmapReadStream(const byte *data, uint32 size)
+	: Common::MemoryReadStream(data, size, DisposeAfterUse::NO) {
+}
+
+MmapReadStream::~MmapReadStream() {
+	munmap(const_cast<byte *>(getData()), size());
+}
+
+#endif
@@ -0,0 +1,60 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/memstream.h"
+#include "common/str.h"
+
+// mmap() is available on the desktop and mobile Unix flavours, but not on
+// the consoles which share the POSIX filesystem code.
+#if defined(__unix__) || defined(__APPLE__)
+#define USE_MMAP_STREAM
+#endif
+
+#ifdef USE_MMAP_STREAM
+
+/**
+ * Read stream over a file mapped into memory. Reads and seeks do not involve
+ * any system call, and getData() gives access to the whole file in place.
+ */
+class MmapReadStream : public Common::MemoryReadStream {
+public:
+	/**
+	 * Map the file at the given path. Fails for anything but regular files
+	 * of at least 64 KB (and at most 64 MB on 32 bit hosts), in which case
+	 * the caller should fall back to a StdioStream.
+	 *
+	 * @return the new stream, or 0 if the file could not be mapped
+	 */
+	static MmapReadStream *makeFromPath(const Common::String &path);
+
+	virtual ~MmapReadStream();
+
+private:
+	MmapReadStream(const byte *data, uint32 size);
+};
+
+#endif
+
+#endif
@@ -29,12 +29,14 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/mmapstream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
 #include "../../platform/libretro/libretro-common/include/retro_dirent.h"
 #include "../../platform/libretro/libretro-common/include/retro_stat.h"
 #include "../../platform/libretro/libretro-common/include/file/file_path.h"
+#include <sys/stat.h>
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -47,6 +49,18 @@ void POSIXFilesystemNode::setFlags()
    _isDirectory = path_is_directory(fspath);
 }
 
+bool POSIXFilesystemNode::getFileStats(uint32 &size, uint32 &modificationTime) const
+{
+   struct stat st;
+
+   if (stat(_path.c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+      return false;
+
+   size             = (uint32)st.st_size;
+   modificationTime = (uint32)st.st_mtime;
+   return true;
+}
+
 POSIXFilesystemNode::POSIXFilesystemNode(const Common::String &p)
 {
 	assert(p.size() > 0);
@@ -158,6 +172,11 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const
 }
 
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#ifdef USE_MMAP_STREAM
+	Common::SeekableReadStream *stream = MmapReadStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+#endif
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
@@ -17,6 +17,7 @@ MODULE_OBJS := \
 	midi/timidity.o \
 	saves/savefile.o \
 	saves/default/default-saves.o \
+	saves/default/savefile-writer.o \
 	timer/default/default-timer.o
 
 ifdef USE_CLOUD
@@ -167,6 +168,7 @@ endif
 
 ifdef POSIX
 MODULE_OBJS += \
+	fs/posix/mmapstream.o \
 	fs/posix/posix-fs.o \
 	fs/posix/posix-fs-factory.o \
 	fs/chroot/chroot-fs-factory.o \
@@ -218,6 +220,7 @@ endif
 
 ifdef PLAYSTATION3
 MODULE_OBJS += \
+	fs/posix/mmapstream.o \
 	fs/posix/posix-fs.o \
 	fs/posix/posix-fs-factory.o \
 	fs/ps3/ps3-fs-factory.o \
@@ -297,6 +300,7 @@ endif
 
 ifeq ($(BACKEND),psp2)
 MODULE_OBJS += \
+	fs/posix/mmapstream.o \
 	fs/posix/posix-fs.o \
 	fs/psp2/psp2-fs-factory.o \
 	fs/psp2/psp2-dirent.o \
@@ -0,0 +1,178 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * Microbenchmark for the RGB565 output converters in blit.cpp.
+ *
+ * Every compiled-in implementation the host CPU supports is checked against
+ * the PixelFormat based reference and timed at common game resolutions.
+ * Build and run with "make blit_bench" from the build directory.
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "blit.h"
+#include "libretro.h"
+#include "common/util.h"
+#include "graphics/pixelformat.h"
+
+static const Graphics::PixelFormat kRGB565(2, 5, 6, 5, 0, 11, 5, 0, 0);
+static const Graphics::PixelFormat kRGB555(2, 5, 5, 5, 1, 10, 5, 0, 15);
+static const Graphics::PixelFormat kRGBA8888(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+static const struct {
+   int w, h;
+} kSizes[] = {
+   { 320, 200 },
+   { 640, 480 },
+   { 800, 600 }
+};
+
+static double getSeconds()
+{
+   struct timeval t;
+   gettimeofday(&t, 0);
+   return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+static bool isSupported(RetroBlitImpl impl)
+{
+   switch(impl)
+   {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+      case kRetroBlitSSE2:
+         return __builtin_cpu_supports("sse2");
+      case kRetroBlitAVX2:
+         return __builtin_cpu_supports("avx2");
+#endif
+      default:
+         return retroBlitGetImpl(impl) != NULL;
+   }
+}
+
+static void printReport(const char *kindName, int w, int h, const char *implName, uint count, int iterations, double elapsed, bool match)
+{
+   printf("%-9s %3dx%-3d %-7s %9.1f Mpixel/s %8.1f frames/s %s\n", kindName, w, h, implName,
+      count * (double)iterations / elapsed / 1000000.0, iterations / elapsed, match ? "ok" : "MISMATCH");
+}
+
+enum Kind
+{
+   kKindCLUT8,
+   kKindRGBA8888,
+   kKindRGB555
+};
+
+static void runKind(Kind kind, const char *kindName, const byte *palette, const uint16 *lut)
+{
+   for(uint s = 0; s < ARRAYSIZE(kSizes); s ++)
+   {
+      const uint count = kSizes[s].w * kSizes[s].h;
+      const uint bpp = (kind == kKindCLUT8) ? 1 : (kind == kKindRGB555) ? 2 : 4;
+
+      byte *src = (byte *)malloc(count * bpp);
+      uint16 *ref = (uint16 *)malloc(count * 2);
+      uint16 *dst = (uint16 *)malloc(count * 2);
+
+      for(uint i = 0; i < count * bpp; i ++)
+         src[i] = rand() & 0xFF;
+
+      // Reference output, as the generic per pixel blitters compute it
+      const int iterations = (int)(200000000ULL / (count * 4)) + 1;
+      double start = getSeconds();
+      for(int it = 0; it < iterations; it ++)
+      {
+         for(uint i = 0; i < count; i ++)
+         {
+            uint8 r, g, b;
+            if(kind == kKindCLUT8)
+            {
+               r = palette[src[i] * 3 + 0];
+               g = palette[src[i] * 3 + 1];
+               b = palette[src[i] * 3 + 2];
+            }
+            else if(kind == kKindRGB555)
+               kRGB555.colorToRGB(((const uint16 *)src)[i], r, g, b);
+            else
+               kRGBA8888.colorToRGB(((const uint32 *)src)[i], r, g, b);
+            ref[i] = kRGB565.RGBToColor(r, g, b);
+         }
+      }
+      printReport(kindName, kSizes[s].w, kSizes[s].h, "generic", count, iterations, getSeconds() - start, true);
+
+      for(int impl = 0; impl < kRetroBlitImplCount; impl ++)
+      {
+         const RetroBlitFuncs *funcs = retroBlitGetImpl((RetroBlitImpl)impl);
+         if(!funcs || !isSupported((RetroBlitImpl)impl))
+            continue;
+
+         start = getSeconds();
+         for(int it = 0; it < iterations; it ++)
+         {
+            // Convert line by line, as updateScreen() does
+            for(int y = 0; y < kSizes[s].h; y ++)
+            {
+               const uint offset = y * kSizes[s].w;
+               switch(kind)
+               {
+                  case kKindCLUT8:
+                     funcs->clut8(dst + offset, src + offset, lut, kSizes[s].w);
+                     break;
+                  case kKindRGBA8888:
+                     funcs->rgba8888(dst + offset, (const uint32 *)src + offset, kSizes[s].w);
+                     break;
+                  case kKindRGB555:
+                     funcs->rgb555(dst + offset, (const uint16 *)src + offset, kSizes[s].w);
+                     break;
+               }
+            }
+         }
+         printReport(kindName, kSizes[s].w, kSizes[s].h, funcs->name, count, iterations, getSeconds() - start, !memcmp(dst, ref, count * 2));
+      }
+
+      free(src);
+      free(ref);
+      free(dst);
+   }
+}
+
+int main(void)
+{
+   byte palette[256 * 3];
+   uint16 lut[RETRO_BLIT_LUT_SIZE];
+   for(int i = 0; i < 256 * 3; i ++)
+      palette[i] = rand() & 0xFF;
+   for(int i = 0; i < 256; i ++)
+      lut[i] = kRGB565.RGBToColor(palette[i * 3 + 0], palette[i * 3 + 1], palette[i * 3 + 2]);
+   lut[256] = 0;
+
+   runKind(kKindCLUT8, "clut8", palette, lut);
+   runKind(kKindRGBA8888, "rgba8888", palette, lut);
+   runKind(kKindRGB555, "rgb555", palette, lut);
+
+   return 0;
+}
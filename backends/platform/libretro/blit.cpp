@@ -0,0 +1,352 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "blit.h"
+#include "libretro.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RETRO_BLIT_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 kernels are built with a function level target so that the rest of
+// the core keeps running on CPUs without AVX2.
+#if defined(RETRO_BLIT_SSE2) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define RETRO_BLIT_AVX2
+#include <immintrin.h>
+#define RETRO_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if (defined(__aarch64__) || defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(SCUMM_BIG_ENDIAN)
+#define RETRO_BLIT_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+ * The bit manipulations below are the exact equivalent of going through
+ * PixelFormat::colorToRGB() and PixelFormat::RGBToColor() for RGB565.
+ */
+
+static inline uint16 rgba8888ToRGB565(uint32 c)
+{
+   return ((c >> 16) & 0xF800) | ((c >> 13) & 0x07E0) | ((c >> 11) & 0x001F);
+}
+
+static inline uint16 rgb555ToRGB565(uint16 c)
+{
+   // Green is widened by replicating its top bit, as ColorComponent<5>::expand() does
+   return ((c & 0x7FE0) << 1) | ((c >> 4) & 0x0020) | (c & 0x001F);
+}
+
+static void blitCLUT8Scalar(uint16 *dst, const uint8 *src, const uint16 *lut, uint count)
+{
+   for(; count >= 4; count -= 4)
+   {
+      dst[0] = lut[src[0]];
+      dst[1] = lut[src[1]];
+      dst[2] = lut[src[2]];
+      dst[3] = lut[src[3]];
+      dst += 4;
+      src += 4;
+   }
+
+   while(count--)
+      *dst++ = lut[*src++];
+}
+
+static void blitRGBA8888Scalar(uint16 *dst, const uint32 *src, uint count)
+{
+   while(count--)
+      *dst++ = rgba8888ToRGB565(*src++);
+}
+
+static void blitRGB555Scalar(uint16 *dst, const uint16 *src, uint count)
+{
+   while(count--)
+      *dst++ = rgb555ToRGB565(*src++);
+}
+
+static void blitCLUT8To32Scalar(uint32 *dst, const uint8 *src, const uint32 *lut, uint count)
+{
+   for(; count >= 4; count -= 4)
+   {
+      dst[0] = lut[src[0]];
+      dst[1] = lut[src[1]];
+      dst[2] = lut[src[2]];
+      dst[3] = lut[src[3]];
+      dst += 4;
+      src += 4;
+   }
+
+   while(count--)
+      *dst++ = lut[*src++];
+}
+
+static void blitRGBA8888To32Scalar(uint32 *dst, const uint32 *src, uint count)
+{
+   // RGBA to XRGB: the shift drops alpha and leaves the top byte zero.
+   // Compilers vectorise this on their own.
+   while(count--)
+      *dst++ = *src++ >> 8;
+}
+
+static void blitRGB565To32Scalar(uint32 *dst, const uint16 *src, uint count)
+{
+   while(count--)
+   {
+      const uint c = *src++;
+      const uint r = (c >> 11) & 0x1F;
+      const uint g = (c >> 5) & 0x3F;
+      const uint b = c & 0x1F;
+
+      // Same bit replication as ColorComponent<>::expand()
+      *dst++ = (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+   }
+}
+
+#define RETRO_BLIT_FUNCS_32 blitCLUT8To32Scalar, blitRGBA8888To32Scalar, blitRGB565To32Scalar
+
+static const RetroBlitFuncs s_blitScalar = { "scalar", blitCLUT8Scalar, blitRGBA8888Scalar, blitRGB555Scalar, RETRO_BLIT_FUNCS_32 };
+
+#ifdef RETRO_BLIT_SSE2
+
+static inline __m128i rgba8888ToRGB565SSE2(__m128i c)
+{
+   const __m128i r = _mm_and_si128(_mm_srli_epi32(c, 16), _mm_set1_epi32(0xF800));
+   const __m128i g = _mm_and_si128(_mm_srli_epi32(c, 13), _mm_set1_epi32(0x07E0));
+   const __m128i b = _mm_and_si128(_mm_srli_epi32(c, 11), _mm_set1_epi32(0x001F));
+   const __m128i p = _mm_or_si128(_mm_or_si128(r, g), b);
+
+   // Sign extend, so that the signed saturating pack keeps all 16 bits
+   return _mm_srai_epi32(_mm_slli_epi32(p, 16), 16);
+}
+
+static void blitRGBA8888SSE2(uint16 *dst, const uint32 *src, uint count)
+{
+   for(; count >= 8; count -= 8)
+   {
+      const __m128i lo = rgba8888ToRGB565SSE2(_mm_loadu_si128((const __m128i *)src));
+      const __m128i hi = rgba8888ToRGB565SSE2(_mm_loadu_si128((const __m128i *)(src + 4)));
+      _mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(lo, hi));
+      dst += 8;
+      src += 8;
+   }
+
+   blitRGBA8888Scalar(dst, src, count);
+}
+
+static void blitRGB555SSE2(uint16 *dst, const uint16 *src, uint count)
+{
+   for(; count >= 8; count -= 8)
+   {
+      const __m128i c = _mm_loadu_si128((const __m128i *)src);
+      const __m128i rg = _mm_slli_epi16(_mm_and_si128(c, _mm_set1_epi16(0x7FE0)), 1);
+      const __m128i g0 = _mm_and_si128(_mm_srli_epi16(c, 4), _mm_set1_epi16(0x0020));
+      const __m128i b = _mm_and_si128(c, _mm_set1_epi16(0x001F));
+      _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_or_si128(rg, g0), b));
+      dst += 8;
+      src += 8;
+   }
+
+   blitRGB555Scalar(dst, src, count);
+}
+
+// SSE2 has no gather, the unrolled table lookup is as fast as it gets
+static const RetroBlitFuncs s_blitSSE2 = { "sse2", blitCLUT8Scalar, blitRGBA8888SSE2, blitRGB555SSE2, RETRO_BLIT_FUNCS_32 };
+
+#endif
+
+#ifdef RETRO_BLIT_AVX2
+
+RETRO_TARGET_AVX2 static void blitCLUT8AVX2(uint16 *dst, const uint8 *src, const uint16 *lut, uint count)
+{
+   const __m256i mask = _mm256_set1_epi32(0xFFFF);
+
+   for(; count >= 16; count -= 16)
+   {
+      const __m128i idx = _mm_loadu_si128((const __m128i *)src);
+
+      // Gather 32 bits at each 16-bit entry; the top half belongs to the next entry
+      const __m256i v0 = _mm256_i32gather_epi32((const int *)lut, _mm256_cvtepu8_epi32(idx), 2);
+      const __m256i v1 = _mm256_i32gather_epi32((const int *)lut, _mm256_cvtepu8_epi32(_mm_srli_si128(idx, 8)), 2);
+
+      const __m256i p = _mm256_packus_epi32(_mm256_and_si256(v0, mask), _mm256_and_si256(v1, mask));
+      _mm256_storeu_si256((__m256i *)dst, _mm256_permute4x64_epi64(p, 0xD8));
+      dst += 16;
+      src += 16;
+   }
+
+   blitCLUT8Scalar(dst, src, lut, count);
+}
+
+RETRO_TARGET_AVX2 static inline __m256i rgba8888ToRGB565AVX2(__m256i c)
+{
+   const __m256i r = _mm256_and_si256(_mm256_srli_epi32(c, 16), _mm256_set1_epi32(0xF800));
+   const __m256i g = _mm256_and_si256(_mm256_srli_epi32(c, 13), _mm256_set1_epi32(0x07E0));
+   const __m256i b = _mm256_and_si256(_mm256_srli_epi32(c, 11), _mm256_set1_epi32(0x001F));
+   return _mm256_or_si256(_mm256_or_si256(r, g), b);
+}
+
+RETRO_TARGET_AVX2 static void blitRGBA8888AVX2(uint16 *dst, const uint32 *src, uint count)
+{
+   for(; count >= 16; count -= 16)
+   {
+      const __m256i lo = rgba8888ToRGB565AVX2(_mm256_loadu_si256((const __m256i *)src));
+      const __m256i hi = rgba8888ToRGB565AVX2(_mm256_loadu_si256((const __m256i *)(src + 8)));
+
+      // The pack works per 128-bit lane, restore the pixel order afterwards
+      const __m256i p = _mm256_packus_epi32(lo, hi);
+      _mm256_storeu_si256((__m256i *)dst, _mm256_permute4x64_epi64(p, 0xD8));
+      dst += 16;
+      src += 16;
+   }
+
+   blitRGBA8888Scalar(dst, src, count);
+}
+
+RETRO_TARGET_AVX2 static void blitRGB555AVX2(uint16 *dst, const uint16 *src, uint count)
+{
+   for(; count >= 16; count -= 16)
+   {
+      const __m256i c = _mm256_loadu_si256((const __m256i *)src);
+      const __m256i rg = _mm256_slli_epi16(_mm256_and_si256(c, _mm256_set1_epi16(0x7FE0)), 1);
+      const __m256i g0 = _mm256_and_si256(_mm256_srli_epi16(c, 4), _mm256_set1_epi16(0x0020));
+      const __m256i b = _mm256_and_si256(c, _mm256_set1_epi16(0x001F));
+      _mm256_storeu_si256((__m256i *)dst, _mm256_or_si256(_mm256_or_si256(rg, g0), b));
+      dst += 16;
+      src += 16;
+   }
+
+   blitRGB555Scalar(dst, src, count);
+}
+
+static const RetroBlitFuncs s_blitAVX2 = { "avx2", blitCLUT8AVX2, blitRGBA8888AVX2, blitRGB555AVX2, RETRO_BLIT_FUNCS_32 };
+
+#endif
+
+#ifdef RETRO_BLIT_NEON
+
+static inline uint16x4_t rgba8888ToRGB565NEON(uint32x4_t c)
+{
+   const uint32x4_t r = vandq_u32(vshrq_n_u32(c, 16), vdupq_n_u32(0xF800));
+   const uint32x4_t g = vandq_u32(vshrq_n_u32(c, 13), vdupq_n_u32(0x07E0));
+   const uint32x4_t b = vandq_u32(vshrq_n_u32(c, 11), vdupq_n_u32(0x001F));
+   return vmovn_u32(vorrq_u32(vorrq_u32(r, g), b));
+}
+
+static void blitRGBA8888NEON(uint16 *dst, const uint32 *src, uint count)
+{
+   for(; count >= 8; count -= 8)
+   {
+      const uint16x4_t lo = rgba8888ToRGB565NEON(vld1q_u32(src));
+      const uint16x4_t hi = rgba8888ToRGB565NEON(vld1q_u32(src + 4));
+      vst1q_u16(dst, vcombine_u16(lo, hi));
+      dst += 8;
+      src += 8;
+   }
+
+   blitRGBA8888Scalar(dst, src, count);
+}
+
+static void blitRGB555NEON(uint16 *dst, const uint16 *src, uint count)
+{
+   for(; count >= 8; count -= 8)
+   {
+      const uint16x8_t c = vld1q_u16(src);
+      const uint16x8_t rg = vshlq_n_u16(vandq_u16(c, vdupq_n_u16(0x7FE0)), 1);
+      const uint16x8_t g0 = vandq_u16(vshrq_n_u16(c, 4), vdupq_n_u16(0x0020));
+      const uint16x8_t b = vandq_u16(c, vdupq_n_u16(0x001F));
+      vst1q_u16(dst, vorrq_u16(vorrq_u16(rg, g0), b));
+      dst += 8;
+      src += 8;
+   }
+
+   blitRGB555Scalar(dst, src, count);
+}
+
+// NEON table lookups only reach 64 bytes, the CLUT8 path stays scalar
+static const RetroBlitFuncs s_blitNEON = { "neon", blitCLUT8Scalar, blitRGBA8888NEON, blitRGB555NEON, RETRO_BLIT_FUNCS_32 };
+
+#endif
+
+static const RetroBlitFuncs *s_blitSelected = &s_blitScalar;
+
+const RetroBlitFuncs *retroBlitGetImpl(RetroBlitImpl impl)
+{
+   switch(impl)
+   {
+      case kRetroBlitScalar:
+         return &s_blitScalar;
+#ifdef RETRO_BLIT_SSE2
+      case kRetroBlitSSE2:
+         return &s_blitSSE2;
+#endif
+#ifdef RETRO_BLIT_AVX2
+      case kRetroBlitAVX2:
+         return &s_blitAVX2;
+#endif
+#ifdef RETRO_BLIT_NEON
+      case kRetroBlitNEON:
+         return &s_blitNEON;
+#endif
+      default:
+         return NULL;
+   }
+}
+
+void retroBlitInit(uint64 cpuFeatures)
+{
+#if defined(RETRO_BLIT_AVX2) && defined(__GNUC__)
+   // Frontends without a perf interface do not report anything
+   if(!cpuFeatures && __builtin_cpu_supports("avx2"))
+      cpuFeatures |= RETRO_SIMD_AVX2;
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+   cpuFeatures |= RETRO_SIMD_SSE2;
+#endif
+#if defined(__aarch64__) || defined(__ARM_NEON__) || defined(__ARM_NEON)
+   cpuFeatures |= RETRO_SIMD_NEON;
+#endif
+
+   s_blitSelected = &s_blitScalar;
+
+#ifdef RETRO_BLIT_SSE2
+   if(cpuFeatures & RETRO_SIMD_SSE2)
+      s_blitSelected = &s_blitSSE2;
+#endif
+#ifdef RETRO_BLIT_AVX2
+   if(cpuFeatures & RETRO_SIMD_AVX2)
+      s_blitSelected = &s_blitAVX2;
+#endif
+#ifdef RETRO_BLIT_NEON
+   if(cpuFeatures & RETRO_SIMD_NEON)
+      s_blitSelected = &s_blitNEON;
+#endif
+}
+
+const RetroBlitFuncs &retroBlit()
+{
+   return *s_blitSelected;
+}
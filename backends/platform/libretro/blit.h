@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_LIBRETRO_BLIT_H
+#define BACKENDS_LIBRETRO_BLIT_H
+
+#include "common/scummsys.h"
+
+/**
+ * Number of entries of a CLUT8 lookup table. The table is indexed by the
+ * 256 palette entries and carries one padding entry, so that the AVX2
+ * kernel may gather 32 bits at the last index.
+ */
+#define RETRO_BLIT_LUT_SIZE 257
+
+/**
+ * Row converters to RGB565 and XRGB8888. Each one converts @p count pixels
+ * from @p src into @p dst; neither pointer needs any particular alignment.
+ */
+typedef void (*RetroBlitCLUT8Func)(uint16 *dst, const uint8 *src, const uint16 *lut, uint count);
+typedef void (*RetroBlitRGBA8888Func)(uint16 *dst, const uint32 *src, uint count);
+typedef void (*RetroBlitRGB555Func)(uint16 *dst, const uint16 *src, uint count);
+typedef void (*RetroBlitCLUT8To32Func)(uint32 *dst, const uint8 *src, const uint32 *lut, uint count);
+typedef void (*RetroBlitRGBA8888To32Func)(uint32 *dst, const uint32 *src, uint count);
+typedef void (*RetroBlitRGB565To32Func)(uint32 *dst, const uint16 *src, uint count);
+
+enum RetroBlitImpl
+{
+   kRetroBlitScalar = 0,
+   kRetroBlitSSE2,
+   kRetroBlitAVX2,
+   kRetroBlitNEON,
+   kRetroBlitImplCount
+};
+
+struct RetroBlitFuncs
+{
+   const char *name;
+   RetroBlitCLUT8Func clut8;           // CLUT8 through a RETRO_BLIT_LUT_SIZE table
+   RetroBlitRGBA8888Func rgba8888;     // PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+   RetroBlitRGB555Func rgb555;         // PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15)
+
+   // XRGB8888 output, PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24) with the top byte ignored
+   RetroBlitCLUT8To32Func clut8To32;   // CLUT8 through a 256 entry table
+   RetroBlitRGBA8888To32Func rgba8888To32;
+   RetroBlitRGB565To32Func rgb565To32; // PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)
+};
+
+/**
+ * Select the fastest converters supported by the host.
+ *
+ * @param cpuFeatures RETRO_SIMD_* mask as reported by the frontend, or 0 if
+ *                    unknown. Features guaranteed by the compile target are
+ *                    always assumed to be present.
+ */
+void retroBlitInit(uint64 cpuFeatures);
+
+/** The converters selected by retroBlitInit(), scalar ones until then. */
+const RetroBlitFuncs &retroBlit();
+
+/**
+ * The converters of a given implementation, or NULL if it was not compiled
+ * in. The caller is responsible for checking the CPU supports it.
+ */
+const RetroBlitFuncs *retroBlitGetImpl(RetroBlitImpl impl);
+
+#endif
@@ -30,11 +30,14 @@ USE_MT32EMU = 1
 DEFINES += -DUSE_MT32EMU
 endif
 
+# Bionic provides pthreads as part of libc
+DEFINES += -DHAVE_THREADS
+
 include $(LOCAL_PATH)/../Makefile.common
 include $(addprefix $(CORE_DIR)/, $(addsuffix /module.mk,$(MODULES)))
 OBJS_MODULES := $(addprefix $(CORE_DIR)/, $(foreach MODULE,$(MODULES),$(MODULE_OBJS-$(MODULE))))
 SOURCES_C    := $(LIBRETRO_COMM_DIR)/libco/libco.c
-SOURCES_CXX  := $(LIBRETRO_DIR)/libretro.cpp $(LIBRETRO_DIR)/os.cpp
+SOURCES_CXX  := $(LIBRETRO_DIR)/libretro.cpp $(LIBRETRO_DIR)/os.cpp $(LIBRETRO_DIR)/blit.cpp $(LIBRETRO_DIR)/savestate.cpp
 
 COREFLAGS := $(DEFINES) $(INCLUDES) -D__LIBRETRO__ -DNONSTANDARD_PORT -DUSE_RGB_COLOR -DUSE_OSD -DDISABLE_TEXT_CONSOLE -DFRONTEND_SUPPORTS_RGB565
 COREFLAGS += -Wno-multichar -Wno-undefined-var-template
@@ -5,6 +5,9 @@
 #include "graphics/surface.libretro.h"
 #include "audio/mixer_intern.h"
 #include "os.h"
+#include "blit.h"
+#include "savestate.h"
+#include "common/config-manager.h"
 #include <libco.h>
 #include "libretro.h"
 #include <unistd.h>
@@ -45,6 +48,22 @@ static bool analog_response_is_cubic = false;
 
 static bool speed_hack_is_enabled = false;
 
+static bool frame_pacing_is_enabled = false;
+
+static bool output_is_32bit = true;
+
+static unsigned audio_sample_rate = 44100;
+// Rate the mixer runs at, set when the game is loaded
+static unsigned audio_output_rate = 44100;
+// Samples per frame from the negotiated timing, and the fraction of a
+// sample carried over to the next frame
+static double audio_frame_samples = 0.0;
+static double audio_frame_remainder = 0.0;
+// Mixed into and handed to the frontend as is, a frame long at most
+static int16_t *audio_batch = NULL;
+
+static retro_perf_get_time_usec_t perf_get_time_usec = NULL;
+
 void retro_set_environment(retro_environment_t cb)
 {
 	struct retro_variable variables[] = {
@@ -52,6 +71,9 @@ void retro_set_environment(retro_environment_t cb)
 		{ "scummvm_analog_response", "Analog Cursor Response; linear|cubic" },
 		{ "scummvm_analog_deadzone", "Analog Deadzone (percent); 15|20|25|30|0|5|10" },
 		{ "scummvm_speed_hack", "Speed Hack (Restart); disabled|enabled" },
+		{ "scummvm_frame_pacing", "Frame Paced Timing (Restart); disabled|enabled" },
+		{ "scummvm_output_depth", "Output Color Depth (Restart); 32bit|16bit" },
+		{ "scummvm_audio_rate", "Audio Sample Rate (Restart); 44100|48000|32000|22050" },
 		{ NULL, NULL },
 	};
 
@@ -71,20 +93,61 @@ cothread_t emuThread;
 static char cmd_params[20][200];
 static char cmd_params_num;
 
-void retro_leave_thread(void)
+static bool emu_thread_waiting = false;
+static bool emu_thread_calling = false;
+static bool (*emu_thread_call)(void) = NULL;
+static bool emu_thread_call_result = false;
+
+/* Returns false if no frame could pass, the frontend waiting for a call to complete */
+bool retro_leave_thread(void)
 {
+   // Calls from the frontend complete within the same frame
+   if(emu_thread_calling)
+      return false;
+
+   emu_thread_waiting = true;
    co_switch(mainThread);
+
+   // The frontend may have the engine do some work in between two frames
+   while(emu_thread_call)
+   {
+      emu_thread_calling = true;
+      emu_thread_call_result = emu_thread_call();
+      emu_thread_calling = false;
+      emu_thread_call = NULL;
+      co_switch(mainThread);
+   }
+   emu_thread_waiting = false;
+   return true;
+}
+
+/* Run a call on the emulator thread, where the engine waits for the next frame */
+static bool retro_call_emulator(bool (*call)(void))
+{
+   if(!emuThread || !emu_thread_waiting || EMULATORexited)
+      return false;
+
+   emu_thread_call = call;
+   co_switch(emuThread);
+   return emu_thread_call_result;
 }
 
 static void retro_wrap_emulator(void)
 {
-   g_system = retroBuildOS(speed_hack_is_enabled);
+   g_system = retroBuildOS(speed_hack_is_enabled, frame_pacing_is_enabled);
 
    static const char* argv[20];
    for(int i=0; i<cmd_params_num; i++)
       argv[i] = cmd_params[i];
 
    scummvm_main(cmd_params_num, argv);
+
+   // The core may be unloaded right away, wait for the savefiles to be
+   // written first
+   RetroSaveFileManager *saveFileManager = (RetroSaveFileManager *)g_system->getSavefileManager();
+   if(saveFileManager)
+      saveFileManager->flushSavefiles();
+
    EMULATORexited = true;
 
    // NOTE: Deleting g_system here will crash...
@@ -123,8 +186,8 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
    info->geometry.max_width = RES_W;
    info->geometry.max_height = RES_H;
    info->geometry.aspect_ratio = 4.0f / 3.0f;
-   info->timing.fps = 60.0;
-   info->timing.sample_rate = 44100.0;
+   info->timing.fps = FRAME_RATE;
+   info->timing.sample_rate = audio_output_rate;
 }
 
 void retro_init (void)
@@ -135,6 +198,18 @@ void retro_init (void)
    else
       log_cb = NULL;
 
+   uint64 cpu_features = 0;
+   struct retro_perf_callback perf;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_PERF_INTERFACE, &perf))
+   {
+      if (perf.get_cpu_features)
+         cpu_features = perf.get_cpu_features();
+      perf_get_time_usec = perf.get_time_usec;
+   }
+
+   retroBlitInit(cpu_features);
+   if (log_cb)
+      log_cb(RETRO_LOG_INFO, "Using %s screen converters.\n", retroBlit().name);
 }
 
 void retro_deinit(void)
@@ -245,6 +320,34 @@ static void update_variables(void)
 		if (strcmp(var.value, "enabled") == 0)
 			speed_hack_is_enabled = true;
 	}
+
+	var.key = "scummvm_frame_pacing";
+	var.value = NULL;
+	frame_pacing_is_enabled = false;
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+	{
+		if (strcmp(var.value, "enabled") == 0)
+			frame_pacing_is_enabled = true;
+	}
+
+	var.key = "scummvm_output_depth";
+	var.value = NULL;
+	output_is_32bit = true;
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+	{
+		if (strcmp(var.value, "16bit") == 0)
+			output_is_32bit = false;
+	}
+
+	var.key = "scummvm_audio_rate";
+	var.value = NULL;
+	audio_sample_rate = 44100;
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+	{
+		int rate = atoi(var.value);
+		if (rate == 22050 || rate == 32000 || rate == 48000)
+			audio_sample_rate = rate;
+	}
 }
 
 static int retro_device = RETRO_DEVICE_JOYPAD;
@@ -343,22 +446,33 @@ bool retro_load_game(const struct retro_game_info *game)
 
    environ_cb(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
 
-   /* Get color mode: 32 first as VGA has 6 bits per pixel */
-#if 0
-   RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_XRGB8888;
-   if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &RDOSGFXcolorMode))
+   /* Get color mode: 32 first as VGA has 6 bits per pixel and true color
+    * engines would otherwise be downconverted */
+   enum retro_pixel_format pixel_format = RETRO_PIXEL_FORMAT_XRGB8888;
+   if (!output_is_32bit || !environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixel_format))
    {
-      RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_RGB565;
-      if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &RDOSGFXcolorMode))
-         RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_0RGB1555;
-   }
-#endif
-
 #ifdef FRONTEND_SUPPORTS_RGB565
-   enum retro_pixel_format rgb565 = RETRO_PIXEL_FORMAT_RGB565;
-   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &rgb565) && log_cb)
-      log_cb(RETRO_LOG_INFO, "Frontend supports RGB565 -will use that instead of XRGB1555.\n");
+      pixel_format = RETRO_PIXEL_FORMAT_RGB565;
+      if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixel_format))
 #endif
+         pixel_format = RETRO_PIXEL_FORMAT_0RGB1555;
+   }
+   retroSetPixelFormat(pixel_format);
+
+   if (log_cb)
+      log_cb(RETRO_LOG_INFO, "Using %s output.\n",
+         pixel_format == RETRO_PIXEL_FORMAT_XRGB8888 ? "XRGB8888" :
+         pixel_format == RETRO_PIXEL_FORMAT_RGB565 ? "RGB565" : "0RGB1555");
+
+   audio_output_rate = audio_sample_rate;
+   retroSetSampleRate(audio_output_rate);
+
+   struct retro_system_av_info av_info;
+   retro_get_system_av_info(&av_info);
+   audio_frame_samples = av_info.timing.sample_rate / av_info.timing.fps;
+   audio_frame_remainder = 0.0;
+   delete[] audio_batch;
+   audio_batch = new int16_t[2 * ((size_t)audio_frame_samples + 1)];
 
    retro_keyboard_callback cb = {retroKeyEvent};
    environ_cb(RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK, &cb);
@@ -395,6 +509,126 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info *i
    return false;
 }
 
+/*
+ * Savestates are the engine's own savegames, taken in memory. Frontends
+ * expect a stable state size, so it only ever grows, and usually ask for it
+ * right before retro_serialize(): the state taken for retro_serialize_size()
+ * is kept until the next frame.
+ */
+
+#define STATE_SIZE_GRANULARITY (64 * 1024)
+
+static size_t state_size = 16 * STATE_SIZE_GRANULARITY;
+static bool state_taken = false;
+
+static const void *state_load_data = NULL;
+static size_t state_load_size = 0;
+
+// Snapshot size and latency, reported for each game on unload
+struct StateStats
+{
+   unsigned count;
+   retro_time_t total_usec;
+   retro_time_t max_usec;
+   size_t max_size;
+};
+
+static Common::String state_stats_target;
+static StateStats state_save_stats;
+static StateStats state_load_stats;
+
+static void report_state_stats(void)
+{
+   const StateStats *stats[] = { &state_save_stats, &state_load_stats };
+   const char *names[] = { "saved", "loaded" };
+
+   for(int i = 0; i < 2; i ++)
+   {
+      if(!stats[i]->count || !log_cb)
+         continue;
+
+      // Without the perf interface, there is no latency to report
+      if(!perf_get_time_usec)
+         log_cb(RETRO_LOG_INFO, "%u states %s for %s: up to %u KB, latency n/a.\n",
+            stats[i]->count, names[i], state_stats_target.c_str(), (unsigned)(stats[i]->max_size / 1024));
+      else
+         log_cb(RETRO_LOG_INFO, "%u states %s for %s: up to %u KB, %.2f ms average, %.2f ms max.\n",
+            stats[i]->count, names[i], state_stats_target.c_str(), (unsigned)(stats[i]->max_size / 1024),
+            stats[i]->total_usec / 1000.0 / stats[i]->count, stats[i]->max_usec / 1000.0);
+   }
+
+   memset(&state_save_stats, 0, sizeof(state_save_stats));
+   memset(&state_load_stats, 0, sizeof(state_load_stats));
+}
+
+static void add_state_stats(StateStats &stats, retro_time_t usec, size_t size)
+{
+   if(state_stats_target != ConfMan.getActiveDomainName())
+   {
+      report_state_stats();
+      state_stats_target = ConfMan.getActiveDomainName();
+   }
+
+   stats.count ++;
+   stats.total_usec += usec;
+   stats.max_usec = MAX(stats.max_usec, usec);
+   stats.max_size = MAX(stats.max_size, size);
+}
+
+static retro_time_t get_time_usec(void)
+{
+   return perf_get_time_usec ? perf_get_time_usec() : 0;
+}
+
+static bool take_state(void)
+{
+   const retro_time_t start = get_time_usec();
+   if(!retro_call_emulator(retroStateSave))
+      return false;
+
+   add_state_stats(state_save_stats, get_time_usec() - start, retroStateSize());
+   state_size = MAX(state_size, (retroStateSize() + STATE_SIZE_GRANULARITY - 1) & ~(size_t)(STATE_SIZE_GRANULARITY - 1));
+   return true;
+}
+
+static bool call_state_load(void)
+{
+   return retroStateLoad(state_load_data, state_load_size);
+}
+
+size_t retro_serialize_size(void)
+{
+   if(!state_taken)
+      state_taken = take_state();
+   return state_size;
+}
+
+bool retro_serialize(void *data, size_t size)
+{
+   if(!state_taken)
+      state_taken = take_state();
+   if(!state_taken || retroStateSize() > size)
+      return false;
+
+   memcpy(data, retroStateData(), retroStateSize());
+   memset((uint8 *)data + retroStateSize(), 0, size - retroStateSize());
+   return true;
+}
+
+bool retro_unserialize(const void *data, size_t size)
+{
+   state_load_data = data;
+   state_load_size = size;
+
+   const retro_time_t start = get_time_usec();
+   const bool loaded = retro_call_emulator(call_state_load);
+   if(loaded)
+      add_state_stats(state_load_stats, get_time_usec() - start, size);
+
+   state_taken = false;
+   return loaded;
+}
+
 void retro_run (void)
 {
    if(!emuThread) {
@@ -414,6 +648,7 @@ void retro_run (void)
    }
 
    /* Run emu */
+   state_taken = false;
    co_switch(emuThread);
 
    if(g_system)
@@ -422,10 +657,20 @@ void retro_run (void)
       const Graphics::Surface& screen = getScreen();
       video_cb(screen.pixels, screen.w, screen.h, screen.pitch);
 
-      // Upload audio
-      static uint32 buf[735];
-      int count = ((Audio::MixerImpl*)g_system->getMixer())->mixCallback((byte*)buf, 735*4);
-      audio_batch_cb((int16_t*)buf, count);
+      // Upload audio, as many samples as the frame lasts. Silence is sent
+      // as well, so that the frontend never runs dry.
+      audio_frame_remainder += audio_frame_samples;
+      const size_t frames = (size_t)audio_frame_remainder;
+      audio_frame_remainder -= frames;
+
+      ((Audio::MixerImpl*)g_system->getMixer())->mixCallback((byte*)audio_batch, frames * 4);
+      for(size_t done = 0; done < frames;)
+      {
+         size_t count = audio_batch_cb(audio_batch + 2 * done, frames - done);
+         if(!count)
+            break;
+         done += count;
+      }
    }
 
    if(EMULATORexited) {
@@ -436,9 +681,14 @@ void retro_run (void)
 
 void retro_unload_game (void)
 {
+   delete[] audio_batch;
+   audio_batch = NULL;
+
    if(!emuThread)
       return;
 
+   report_state_stats();
+
    FRONTENDwantsExit = true;
    while(!EMULATORexited)
    {
@@ -454,9 +704,6 @@ void retro_unload_game (void)
 void *retro_get_memory_data(unsigned type) { return 0; }
 size_t retro_get_memory_size(unsigned type) { return 0; }
 void retro_reset (void) { }
-size_t retro_serialize_size (void) { return 0; }
-bool retro_serialize(void *data, size_t size) { return false; }
-bool retro_unserialize(const void * data, size_t size) { return false; }
 void retro_cheat_reset(void) { }
 void retro_cheat_set(unsigned unused, bool unused1, const char* unused2) { }
 
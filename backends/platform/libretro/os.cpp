@@ -25,6 +25,9 @@
 #include <unistd.h>
 #include <sys/time.h>
 #include <list>
+#ifdef HAVE_THREADS
+#include <pthread.h>
+#endif
 
 #include <retro_miscellaneous.h>
 #include <retro_inline.h>
@@ -32,6 +35,7 @@
 #include "graphics/surface.libretro.h"
 #include "backends/base-backend.h"
 #include "common/events.h"
+#include "common/rect.h"
 #include "audio/mixer_intern.h"
 
 #if defined(_WIN32)
@@ -45,7 +49,7 @@
 #include "backends/timer/default/default-timer.h"
 #include "graphics/colormasks.h"
 #include "graphics/palette.h"
-#include "backends/saves/default/default-saves.h"
+#include "savestate.h"
 #if defined(_WIN32)
 #include <direct.h>
 #ifdef _XBOX
@@ -62,6 +66,7 @@
 #endif
 
 #include "libretro.h"
+#include "blit.h"
 
 extern retro_log_printf_t log_cb;
 
@@ -90,9 +95,21 @@ struct RetroPalette
    }
 };
 
-static INLINE void blit_uint8_uint16_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+static INLINE void blit_uint8_uint16_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const uint16 *aLUT, const Common::Rect& aRect)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   if(aIn.format.bytesPerPixel == 1)
+   {
+      const int w = MIN<int>(aRect.right, aOut.w) - aRect.left;
+      const int h = MIN<int>(aRect.bottom, aOut.h);
+      if(w <= 0)
+         return;
+
+      for(int i = aRect.top; i < h; i ++)
+         retroBlit().clut8((uint16 *)aOut.getBasePtr(aRect.left, i), (const uint8 *)aIn.getBasePtr(aRect.left, i), aLUT, w);
+      return;
+   }
+
+   for(int i = aRect.top; i < aRect.bottom; i ++)
    {
       if(i >= aOut.h)
          continue;
@@ -100,35 +117,34 @@ static INLINE void blit_uint8_uint16_fast(Graphics::Surface& aOut, const Graphic
       uint8_t * const in  = (uint8_t*)aIn.pixels + (i * aIn.w);
       uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
 
-      for(int j = 0; j < aIn.w; j ++)
+      for(int j = aRect.left; j < aRect.right; j ++)
       {
          if (j >= aOut.w)
             continue;
 
          uint8 r, g, b;
 
-         const uint8_t val = in[j];
-         if(val != 0xFFFFFFFF)
-         {
-            if(aIn.format.bytesPerPixel == 1)
-            {
-               unsigned char *col = aColors.getColor(val);
-               r = *col++;
-               g = *col++;
-               b = *col++;
-            }
-            else
-               aIn.format.colorToRGB(in[j], r, g, b);
-
-            out[j] = aOut.format.RGBToColor(r, g, b);
-         }
+         aIn.format.colorToRGB(in[j], r, g, b);
+         out[j] = aOut.format.RGBToColor(r, g, b);
       }
    }
 }
 
-static INLINE void blit_uint32_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+static INLINE void blit_uint32_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors, const Common::Rect& aRect)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   if(aIn.format == Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0) && aOut.format == Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0))
+   {
+      const int w = MIN<int>(aRect.right, aOut.w) - aRect.left;
+      const int h = MIN<int>(aRect.bottom, aOut.h);
+      if(w <= 0)
+         return;
+
+      for(int i = aRect.top; i < h; i ++)
+         retroBlit().rgba8888((uint16 *)aOut.getBasePtr(aRect.left, i), (const uint32 *)aIn.getBasePtr(aRect.left, i), w);
+      return;
+   }
+
+   for(int i = aRect.top; i < aRect.bottom; i ++)
    {
       if(i >= aOut.h)
          continue;
@@ -136,7 +152,7 @@ static INLINE void blit_uint32_uint16(Graphics::Surface& aOut, const Graphics::S
       uint32_t* const in = (uint32_t*)aIn.pixels + (i * aIn.w);
       uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
 
-      for(int j = 0; j < aIn.w; j ++)
+      for(int j = aRect.left; j < aRect.right; j ++)
       {
          if(j >= aOut.w)
             continue;
@@ -153,9 +169,29 @@ static INLINE void blit_uint32_uint16(Graphics::Surface& aOut, const Graphics::S
    }
 }
 
-static INLINE void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+static INLINE void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors, const Common::Rect& aRect)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   const int w = MIN<int>(aRect.right, aOut.w) - aRect.left;
+   const int h = MIN<int>(aRect.bottom, aOut.h);
+   if(w <= 0)
+      return;
+
+   // The overlay already is in the output format
+   if(aIn.format == aOut.format)
+   {
+      for(int i = aRect.top; i < h; i ++)
+         memcpy(aOut.getBasePtr(aRect.left, i), aIn.getBasePtr(aRect.left, i), w * 2);
+      return;
+   }
+
+   if(aIn.format == Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15) && aOut.format == Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0))
+   {
+      for(int i = aRect.top; i < h; i ++)
+         retroBlit().rgb555((uint16 *)aOut.getBasePtr(aRect.left, i), (const uint16 *)aIn.getBasePtr(aRect.left, i), w);
+      return;
+   }
+
+   for(int i = aRect.top; i < aRect.bottom; i ++)
    {
       if(i >= aOut.h)
          continue;
@@ -163,7 +199,7 @@ static INLINE void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::S
       uint16_t* const in = (uint16_t*)aIn.pixels + (i * aIn.w);
       uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
 
-      for(int j = 0; j < aIn.w; j ++)
+      for(int j = aRect.left; j < aRect.right; j ++)
       {
          if(j >= aOut.w)
             continue;
@@ -180,7 +216,55 @@ static INLINE void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::S
    }
 }
 
-static void blit_uint8_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+static INLINE void blit_to_uint32(Graphics::Surface& aOut, const Graphics::Surface& aIn, const uint32 *aLUT, const Common::Rect& aRect)
+{
+   const int w = MIN<int>(aRect.right, aOut.w) - aRect.left;
+   const int h = MIN<int>(aRect.bottom, aOut.h);
+   if(w <= 0)
+      return;
+
+   const RetroBlitFuncs &funcs = retroBlit();
+
+   if(aIn.format == aOut.format)
+   {
+      for(int i = aRect.top; i < h; i ++)
+         memcpy(aOut.getBasePtr(aRect.left, i), aIn.getBasePtr(aRect.left, i), w * 4);
+   }
+   else if(aIn.format.bytesPerPixel == 1)
+   {
+      for(int i = aRect.top; i < h; i ++)
+         funcs.clut8To32((uint32 *)aOut.getBasePtr(aRect.left, i), (const uint8 *)aIn.getBasePtr(aRect.left, i), aLUT, w);
+   }
+   else if(aIn.format == Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0))
+   {
+      for(int i = aRect.top; i < h; i ++)
+         funcs.rgba8888To32((uint32 *)aOut.getBasePtr(aRect.left, i), (const uint32 *)aIn.getBasePtr(aRect.left, i), w);
+   }
+   else if(aIn.format == Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0))
+   {
+      for(int i = aRect.top; i < h; i ++)
+         funcs.rgb565To32((uint32 *)aOut.getBasePtr(aRect.left, i), (const uint16 *)aIn.getBasePtr(aRect.left, i), w);
+   }
+   else
+   {
+      for(int i = aRect.top; i < h; i ++)
+      {
+         uint32 *out = (uint32 *)aOut.getBasePtr(aRect.left, i);
+         const byte *in = (const byte *)aIn.getBasePtr(aRect.left, i);
+
+         for(int j = 0; j < w; j ++, in += aIn.format.bytesPerPixel)
+         {
+            uint8 r, g, b;
+
+            aIn.format.colorToRGB(aIn.format.bytesPerPixel == 2 ? *(const uint16 *)in : *(const uint32 *)in, r, g, b);
+            out[j] = aOut.format.RGBToColor(r, g, b);
+         }
+      }
+   }
+}
+
+template<typename TOut>
+static void blit_uint8_uintN(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
 {
    for(int i = 0; i < aIn.h; i ++)
    {
@@ -188,7 +272,7 @@ static void blit_uint8_uint16(Graphics::Surface& aOut, const Graphics::Surface&
          continue;
 
       uint8_t* const in = (uint8_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + ((i + aY) * aOut.w);
+      TOut* const out = (TOut*)aOut.pixels + ((i + aY) * aOut.w);
 
       for(int j = 0; j < aIn.w; j ++)
       {
@@ -210,15 +294,16 @@ static void blit_uint8_uint16(Graphics::Surface& aOut, const Graphics::Surface&
    }
 }
 
-static void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+template<typename TIn, typename TOut>
+static void blit_uintN_uintN(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
 {
    for(int i = 0; i < aIn.h; i ++)
    {
       if((i + aY) < 0 || (i + aY) >= aOut.h)
          continue;
 
-      uint16_t* const in = (uint16_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + ((i + aY) * aOut.w);
+      TIn* const in = (TIn*)aIn.pixels + (i * aIn.w);
+      TOut* const out = (TOut*)aOut.pixels + ((i + aY) * aOut.w);
 
       for(int j = 0; j < aIn.w; j ++)
       {
@@ -227,7 +312,7 @@ static void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface&
 
          uint8 r, g, b;
 
-         const uint16_t val = in[j];
+         const TIn val = in[j];
          if(val != aKeyColor)
          {
             aIn.format.colorToRGB(in[j], r, g, b);
@@ -237,6 +322,23 @@ static void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface&
    }
 }
 
+template<typename TOut>
+static void blit_cursor(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+{
+   switch(aIn.format.bytesPerPixel)
+   {
+      case 1:
+         blit_uint8_uintN<TOut>(aOut, aIn, aX, aY, aColors, aKeyColor);
+         break;
+      case 2:
+         blit_uintN_uintN<uint16, TOut>(aOut, aIn, aX, aY, aColors, aKeyColor);
+         break;
+      case 4:
+         blit_uintN_uintN<uint32, TOut>(aOut, aIn, aX, aY, aColors, aKeyColor);
+         break;
+   }
+}
+
 static INLINE void copyRectToSurface(uint8_t *pixels, int out_pitch, const uint8_t *src, int pitch, int x, int y, int w, int h, int out_bpp)
 {
    uint8_t *dst = pixels + y * out_pitch + x * out_bpp;
@@ -251,6 +353,29 @@ static INLINE void copyRectToSurface(uint8_t *pixels, int out_pitch, const uint8
 
 static Common::String s_systemDir;
 static Common::String s_saveDir;
+static uint s_sampleRate = 44100;
+
+#ifdef FRONTEND_SUPPORTS_RGB565
+static retro_pixel_format s_pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
+#else
+static retro_pixel_format s_pixelFormat = RETRO_PIXEL_FORMAT_0RGB1555;
+#endif
+
+// Format of the surface handed to the frontend. The top byte of XRGB8888 is
+// ignored by the frontend, describing it as alpha lets ARGB8888 games skip
+// the conversion.
+static Graphics::PixelFormat getOutputPixelFormat()
+{
+   switch(s_pixelFormat)
+   {
+      case RETRO_PIXEL_FORMAT_XRGB8888:
+         return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
+      case RETRO_PIXEL_FORMAT_RGB565:
+         return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+      default:
+         return Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15);
+   }
+}
 
 #ifdef FRONTEND_SUPPORTS_RGB565
 #define SURF_BPP 2
@@ -290,10 +415,28 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       Graphics::Surface _gameScreen;
       RetroPalette _gamePalette;
+      uint16 _gamePaletteLUT[RETRO_BLIT_LUT_SIZE];
+      uint32 _gamePaletteLUT32[256];
+      bool _gamePaletteLUTDirty;
+
+      // Set while the frontend is shown _gameScreen itself instead of _screen
+      bool _passThrough;
 
       Graphics::Surface _overlay;
       bool _overlayVisible;
 
+      // Regions of _screen that must be reconverted on the next updateScreen()
+      enum {
+         NUM_DIRTY_RECT = 100
+      };
+      Common::Rect _dirtyRectList[NUM_DIRTY_RECT];
+      int _numDirtyRects;
+      bool _forceRedraw;
+
+      // Area of _screen covered by the cursor at the last updateScreen()
+      Common::Rect _cursorRect;
+      bool _cursorNeedsRedraw;
+
       Graphics::Surface _mouseImage;
       RetroPalette _mousePalette;
       bool _mousePaletteEnabled;
@@ -318,17 +461,28 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       
       bool _speed_hack_enabled;
 
+      // Frame paced timing: getMillis() follows a virtual clock advancing by
+      // exactly one frame each time the frontend runs the core. Time the
+      // engine waits while the frame cannot be left is added on top.
+      enum { MAX_FRAME_POLLS = 1000 };
+      bool _frame_pacing_enabled;
+      uint32 _frameCount;
+      uint32 _framePolls;
+      uint32 _skippedMillis;
+
 
       Audio::MixerImpl* _mixer;
 
 
-      OSystem_RETRO(bool aEnableSpeedHack) :
+      OSystem_RETRO(bool aEnableSpeedHack, bool aEnableFramePacing) :
+         _gamePaletteLUTDirty(true), _passThrough(false), _overlayVisible(false), _numDirtyRects(0), _forceRedraw(true), _cursorNeedsRedraw(false),
          _mousePaletteEnabled(false), _mouseVisible(false),
          _mouseX(0), _mouseY(0), _mouseXAcc(0.0), _mouseYAcc(0.0), _mouseHotspotX(0), _mouseHotspotY(0),
          _mouseKeyColor(0), _mouseDontScale(false),
          _joypadnumpadLast(8), _joypadnumpadActive(false),
          _mixer(0), _startTime(0), _threadExitTime(10),
-         _speed_hack_enabled(aEnableSpeedHack)
+         _speed_hack_enabled(aEnableSpeedHack),
+         _frame_pacing_enabled(aEnableFramePacing), _frameCount(0), _framePolls(0), _skippedMillis(0)
    {
       _fsFactory = new FS_SYSTEM_FACTORY();
       memset(_mouseButtons, 0, sizeof(_mouseButtons));
@@ -356,13 +510,13 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual void initBackend()
       {
-         _savefileManager = new DefaultSaveFileManager(s_saveDir);
+         _savefileManager = new RetroSaveFileManager(s_saveDir);
 #ifdef FRONTEND_SUPPORTS_RGB565
          _overlay.create(RES_W, RES_H, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
 #else
          _overlay.create(RES_W, RES_H, Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
 #endif
-         _mixer = new Audio::MixerImpl(this, 44100);
+         _mixer = new Audio::MixerImpl(this, s_sampleRate);
          _timerManager = new DefaultTimerManager();
 
          _mixer->setReady(true);
@@ -378,7 +532,10 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void setFeatureState(Feature f, bool enable)
       {
          if (f == kFeatureCursorPalette)
+         {
             _mousePaletteEnabled = enable;
+            _cursorNeedsRedraw = true;
+         }
       }
 
       virtual bool getFeatureState(Feature f)
@@ -410,6 +567,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format)
       {
          _gameScreen.create(width, height, format ? *format : Graphics::PixelFormat::createFormatCLUT8());
+         _forceRedraw = true;
       }
 
       virtual int16 getHeight()
@@ -431,6 +589,10 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       {
          Common::List<Graphics::PixelFormat> result;
 
+         /* ARGB8888 - same as the output, shown without conversion */
+         if(s_pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888)
+            result.push_back(getOutputPixelFormat());
+
          /* RGBA8888 */
          result.push_back(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
 
@@ -454,6 +616,10 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void setPalette(const byte *colors, uint start, uint num)
       {
          _gamePalette.set(colors, start, num);
+         _gamePaletteLUTDirty = true;
+
+         // Every pixel of a CLUT8 screen and the cursor may depend on the changed entries
+         _forceRedraw = true;
       }
 
       virtual void grabPalette(byte *colors, uint start, uint num) const
@@ -463,43 +629,151 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
 
    public:
+      void addDirtyRect(const Common::Rect &rect)
+      {
+         if(_forceRedraw || rect.isEmpty())
+            return;
+
+         if(_numDirtyRects == NUM_DIRTY_RECT)
+         {
+            _forceRedraw = true;
+            return;
+         }
+
+         // Merge into an existing rect when one contains the other
+         for(int i = 0; i < _numDirtyRects; i ++)
+         {
+            if(_dirtyRectList[i].contains(rect))
+               return;
+
+            if(rect.contains(_dirtyRectList[i]))
+            {
+               _dirtyRectList[i] = rect;
+               return;
+            }
+         }
+
+         _dirtyRectList[_numDirtyRects++] = rect;
+      }
+
       virtual void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h)
       {
          const uint8_t *src = (const uint8_t*)buf;
          uint8_t *pix = (uint8_t*)_gameScreen.pixels;
          copyRectToSurface(pix, _gameScreen.pitch, src, pitch, x, y, w, h, _gameScreen.format.bytesPerPixel);
+
+         if(!_overlayVisible)
+            addDirtyRect(Common::Rect(x, y, x + w, y + h));
+      }
+
+      Common::Rect getCursorRect() const
+      {
+         if(!_mouseVisible || !_mouseImage.w || !_mouseImage.h)
+            return Common::Rect();
+
+         const int x = _mouseX - _mouseHotspotX;
+         const int y = _mouseY - _mouseHotspotY;
+
+         Common::Rect rect(x, y, x + _mouseImage.w, y + _mouseImage.h);
+         rect.clip(Common::Rect(_screen.w, _screen.h));
+         return rect;
       }
 
       virtual void updateScreen()
       {
          const Graphics::Surface& srcSurface = (_overlayVisible) ? _overlay : _gameScreen;
-         if(srcSurface.w && srcSurface.h)
+
+         // Nothing to compose on top of a game screen in the output format,
+         // the frontend gets its pixels as they are
+         if(!_overlayVisible && _gameScreen.format == _screen.format &&
+            _gameScreen.w == _screen.w && _gameScreen.h == _screen.h && getCursorRect().isEmpty())
+         {
+            _passThrough = true;
+            _cursorRect = Common::Rect();
+            _numDirtyRects = 0;
+            return;
+         }
+
+         if(_passThrough)
+         {
+            _passThrough = false;
+            _forceRedraw = true;
+         }
+
+         // Restore the area under the old cursor and the new one when it moved or changed
+         const Common::Rect cursorRect = getCursorRect();
+         if(_cursorNeedsRedraw || cursorRect != _cursorRect)
+         {
+            addDirtyRect(_cursorRect);
+            addDirtyRect(cursorRect);
+            _cursorNeedsRedraw = false;
+         }
+         _cursorRect = cursorRect;
+
+         if(!_forceRedraw && !_numDirtyRects)
+            return;
+
+         if(_forceRedraw)
          {
+            _dirtyRectList[0] = Common::Rect(srcSurface.w, srcSurface.h);
+            _numDirtyRects = 1;
+         }
+
+         if(_gamePaletteLUTDirty && srcSurface.format.bytesPerPixel == 1)
+         {
+            for(int i = 0; i < 256; i ++)
+            {
+               const unsigned char *col = _gamePalette.getColor(i);
+               if(_screen.format.bytesPerPixel == 4)
+                  _gamePaletteLUT32[i] = _screen.format.RGBToColor(col[0], col[1], col[2]);
+               else
+                  _gamePaletteLUT[i] = _screen.format.RGBToColor(col[0], col[1], col[2]);
+            }
+            _gamePaletteLUT[256] = 0;
+            _gamePaletteLUTDirty = false;
+         }
+
+         for(int i = 0; i < _numDirtyRects; i ++)
+         {
+            Common::Rect rect = _dirtyRectList[i];
+            rect.clip(Common::Rect(srcSurface.w, srcSurface.h));
+            if(rect.isEmpty())
+               continue;
+
+            if(_screen.format.bytesPerPixel == 4)
+            {
+               blit_to_uint32(_screen, srcSurface, _gamePaletteLUT32, rect);
+               continue;
+            }
+
             switch(srcSurface.format.bytesPerPixel)
             {
                case 1:
                case 3:
-                  blit_uint8_uint16_fast(_screen, srcSurface, _gamePalette);
+                  blit_uint8_uint16_fast(_screen, srcSurface, _gamePaletteLUT, rect);
                   break;
                case 2:
-                  blit_uint16_uint16(_screen, srcSurface, _gamePalette);
+                  blit_uint16_uint16(_screen, srcSurface, _gamePalette, rect);
                   break;
                case 4:
-                  blit_uint32_uint16(_screen, srcSurface, _gamePalette);
+                  blit_uint32_uint16(_screen, srcSurface, _gamePalette, rect);
                   break;
             }
          }
 
+         _numDirtyRects = 0;
+         _forceRedraw = false;
+
          // Draw Mouse
-         if(_mouseVisible && _mouseImage.w && _mouseImage.h)
+         if(!_cursorRect.isEmpty())
          {
             const int x = _mouseX - _mouseHotspotX;
             const int y = _mouseY - _mouseHotspotY;
 
-            if(_mouseImage.format.bytesPerPixel == 1)
-               blit_uint8_uint16(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
+            if(_screen.format.bytesPerPixel == 4)
+               blit_cursor<uint32>(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
             else
-               blit_uint16_uint16(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
+               blit_cursor<uint16>(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
          }
       }
 
@@ -510,7 +784,8 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual void unlockScreen()
       {
-         /* EMPTY */
+         // The engine may have drawn anywhere on the locked surface
+         _forceRedraw = true;
       }
 
       virtual void setShakePos(int shakeOffset)
@@ -521,16 +796,21 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void showOverlay()
       {
          _overlayVisible = true;
+         _forceRedraw = true;
       }
 
       virtual void hideOverlay()
       {
          _overlayVisible = false;
+         _forceRedraw = true;
       }
 
       virtual void clearOverlay()
       {
          _overlay.fillRect(Common::Rect(_overlay.w, _overlay.h), 0);
+
+         if(_overlayVisible)
+            _forceRedraw = true;
       }
 
       virtual void grabOverlay(void *buf, int pitch)
@@ -551,6 +831,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          const uint8_t *src = (const uint8_t*)buf;
          uint8_t *pix = (uint8_t*)_overlay.pixels;
          copyRectToSurface(pix, _overlay.pitch, src, pitch, x, y, w, h, _overlay.format.bytesPerPixel);
+
+         if(_overlayVisible)
+            addDirtyRect(Common::Rect(x, y, x + w, y + h));
       }
 
       virtual int16 getOverlayHeight()
@@ -598,19 +881,46 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          _mouseHotspotY = hotspotY;
          _mouseKeyColor = keycolor;
          _mouseDontScale = dontScale;
+         _cursorNeedsRedraw = true;
       }
 
       virtual void setCursorPalette(const byte *colors, uint start, uint num)
       {
          _mousePalette.set(colors, start, num);
          _mousePaletteEnabled = true;
+         _cursorNeedsRedraw = true;
       }
       
+      bool retroLeaveFrame()
+      {
+         extern bool retro_leave_thread();
+         if(!retro_leave_thread())
+            return false;
+
+         _frameCount ++;
+         _framePolls = 0;
+         return true;
+      }
+
 		void retroCheckThread(uint32 offset = 0)
       {
+         // With frame pacing, time only moves between frames, so the frame
+         // ends once the engine sleeps. Engines waiting on getMillis()
+         // without sleeping get a fixed number of polls per frame instead.
+         if(_frame_pacing_enabled)
+         {
+            if(++_framePolls >= MAX_FRAME_POLLS && !retroLeaveFrame())
+            {
+               // Called from the frontend, let the time of a frame pass
+               _skippedMillis += 1000 / FRAME_RATE;
+               _framePolls = 0;
+            }
+            return;
+         }
+
          if(_threadExitTime <= (getMillis() + offset))
          {
-            extern void retro_leave_thread();
+            extern bool retro_leave_thread();
             retro_leave_thread();
 
             _threadExitTime = getMillis() + 10;
@@ -636,6 +946,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual uint32 getMillis(bool skipRecord = false)
       {
+         if(_frame_pacing_enabled)
+            return (uint32)((uint64)_frameCount * 1000 / FRAME_RATE) + _skippedMillis;
+
 #if (defined(GEKKO) && !defined(WIIU))
          return (ticks_to_microsecs(gettime()) / 1000.0) - _startTime;
 #elif defined(WIIU)
@@ -654,7 +967,22 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       {
 			// Implement 'non-blocking' sleep...
 			uint32 start_time = getMillis();
-			if (_speed_hack_enabled)
+			if (_frame_pacing_enabled)
+			{
+				// Sleep a whole number of frames, without spinning
+				while(getMillis() < start_time + msecs)
+				{
+					if(!retroLeaveFrame())
+					{
+						// Called from the frontend, the frame cannot be
+						// left: let the delay pass at once instead
+						_skippedMillis += start_time + msecs - getMillis();
+						break;
+					}
+					((DefaultTimerManager*)_timerManager)->handler();
+				}
+			}
+			else if (_speed_hack_enabled)
 			{
 				// Use janky inaccurate method...
 				uint32 elapsed_time = 0;
@@ -698,6 +1026,131 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 			}
       }
 
+#ifdef HAVE_THREADS
+      // The emulator coroutine runs on the frontend thread, so mutexes are
+      // only needed against the worker threads started by createThread().
+      virtual MutexRef createMutex(void)
+      {
+         pthread_mutexattr_t attr;
+         pthread_mutex_t *mutex = new pthread_mutex_t;
+
+         pthread_mutexattr_init(&attr);
+         pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+         if(pthread_mutex_init(mutex, &attr) != 0)
+         {
+            delete mutex;
+            mutex = 0;
+         }
+         pthread_mutexattr_destroy(&attr);
+
+         return (MutexRef)mutex;
+      }
+
+      virtual void lockMutex(MutexRef mutex)
+      {
+         pthread_mutex_lock((pthread_mutex_t *)mutex);
+      }
+
+      virtual void unlockMutex(MutexRef mutex)
+      {
+         pthread_mutex_unlock((pthread_mutex_t *)mutex);
+      }
+
+      virtual void deleteMutex(MutexRef mutex)
+      {
+         pthread_mutex_destroy((pthread_mutex_t *)mutex);
+         delete (pthread_mutex_t *)mutex;
+      }
+
+      struct RetroThread
+      {
+         ThreadProc proc;
+         void *data;
+         pthread_t thread;
+      };
+
+      static void *retroThreadEntry(void *data)
+      {
+         RetroThread *thread = (RetroThread *)data;
+         thread->proc(thread->data);
+         return 0;
+      }
+
+      virtual ThreadRef createThread(ThreadProc proc, void *data)
+      {
+         RetroThread *thread = new RetroThread;
+         thread->proc = proc;
+         thread->data = data;
+
+         if(pthread_create(&thread->thread, 0, retroThreadEntry, thread) != 0)
+         {
+            delete thread;
+            return 0;
+         }
+         return (ThreadRef)thread;
+      }
+
+      virtual void joinThread(ThreadRef thread)
+      {
+         RetroThread *retroThread = (RetroThread *)thread;
+         pthread_join(retroThread->thread, 0);
+         delete retroThread;
+      }
+
+      // Unnamed POSIX semaphores are missing on some platforms
+      struct RetroSemaphore
+      {
+         pthread_mutex_t mutex;
+         pthread_cond_t cond;
+         uint value;
+      };
+
+      virtual SemaphoreRef createSemaphore(uint value)
+      {
+         RetroSemaphore *semaphore = new RetroSemaphore;
+         semaphore->value = value;
+
+         if(pthread_mutex_init(&semaphore->mutex, 0) != 0)
+         {
+            delete semaphore;
+            return 0;
+         }
+         if(pthread_cond_init(&semaphore->cond, 0) != 0)
+         {
+            pthread_mutex_destroy(&semaphore->mutex);
+            delete semaphore;
+            return 0;
+         }
+         return (SemaphoreRef)semaphore;
+      }
+
+      virtual void waitSemaphore(SemaphoreRef semaphore)
+      {
+         RetroSemaphore *retroSemaphore = (RetroSemaphore *)semaphore;
+         pthread_mutex_lock(&retroSemaphore->mutex);
+         while(!retroSemaphore->value)
+            pthread_cond_wait(&retroSemaphore->cond, &retroSemaphore->mutex);
+         retroSemaphore->value --;
+         pthread_mutex_unlock(&retroSemaphore->mutex);
+      }
+
+      virtual void postSemaphore(SemaphoreRef semaphore)
+      {
+         RetroSemaphore *retroSemaphore = (RetroSemaphore *)semaphore;
+         pthread_mutex_lock(&retroSemaphore->mutex);
+         retroSemaphore->value ++;
+         pthread_cond_signal(&retroSemaphore->cond);
+         pthread_mutex_unlock(&retroSemaphore->mutex);
+      }
+
+      virtual void deleteSemaphore(SemaphoreRef semaphore)
+      {
+         RetroSemaphore *retroSemaphore = (RetroSemaphore *)semaphore;
+         pthread_cond_destroy(&retroSemaphore->cond);
+         pthread_mutex_destroy(&retroSemaphore->mutex);
+         delete retroSemaphore;
+      }
+#else
       virtual MutexRef createMutex(void)
       {
          return MutexRef();
@@ -717,6 +1170,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       {
          /* EMPTY */
       }
+#endif
 
       virtual void quit()
       {
@@ -773,8 +1227,16 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual void logMessage(LogMessageType::Type type, const char *message)
       {
+#ifdef HAVE_THREADS
+         // Worker threads may log as well
+         static pthread_mutex_t logMutex = PTHREAD_MUTEX_INITIALIZER;
+         pthread_mutex_lock(&logMutex);
+#endif
          if (log_cb)
             log_cb(RETRO_LOG_INFO, "%s\n", message);
+#ifdef HAVE_THREADS
+         pthread_mutex_unlock(&logMutex);
+#endif
       }
 
 
@@ -783,18 +1245,17 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       const Graphics::Surface& getScreen()
       {
          const Graphics::Surface& srcSurface = (_overlayVisible) ? _overlay : _gameScreen;
+         const Graphics::PixelFormat format = getOutputPixelFormat();
 
-         if(srcSurface.w != _screen.w || srcSurface.h != _screen.h)
+         if(srcSurface.w != _screen.w || srcSurface.h != _screen.h || format != _screen.format)
          {
-#ifdef FRONTEND_SUPPORTS_RGB565
-            _screen.create(srcSurface.w, srcSurface.h, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
-#else
-            _screen.create(srcSurface.w, srcSurface.h, Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
-#endif
+            _screen.create(srcSurface.w, srcSurface.h, format);
+            _forceRedraw = true;
+            _gamePaletteLUTDirty = true;
          }
 
 
-         return _screen;
+         return _passThrough ? _gameScreen : _screen;
       }
 
 #define ANALOG_RANGE 0x8000
@@ -1216,9 +1677,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       }
 };
 
-OSystem* retroBuildOS(bool aEnableSpeedHack)
+OSystem* retroBuildOS(bool aEnableSpeedHack, bool aEnableFramePacing)
 {
-   return new OSystem_RETRO(aEnableSpeedHack);
+   return new OSystem_RETRO(aEnableSpeedHack, aEnableFramePacing);
 }
 
 const Graphics::Surface& getScreen()
@@ -1241,6 +1702,16 @@ void retroSetSystemDir(const char* aPath)
    s_systemDir = Common::String(aPath ? aPath : ".");
 }
 
+void retroSetPixelFormat(retro_pixel_format aFormat)
+{
+   s_pixelFormat = aFormat;
+}
+
+void retroSetSampleRate(uint aRate)
+{
+   s_sampleRate = aRate;
+}
+
 void retroSetSaveDir(const char* aPath)
 {
    s_saveDir = Common::String(aPath ? aPath : ".");
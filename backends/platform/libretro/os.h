@@ -42,7 +42,7 @@
 extern int access(const char *path, int amode);
 #endif
 
-OSystem* retroBuildOS(bool aEnableSpeedHack);
+OSystem* retroBuildOS(bool aEnableSpeedHack, bool aEnableFramePacing);
 const Graphics::Surface& getScreen();
 
 void retroProcessMouse(retro_input_state_t aCallback, int device, float gampad_cursor_speed, bool analog_response_is_cubic, int analog_deadzone);
@@ -50,6 +50,8 @@ void retroPostQuit();
 
 void retroSetSystemDir(const char* aPath);
 void retroSetSaveDir(const char* aPath);
+void retroSetPixelFormat(retro_pixel_format aFormat);
+void retroSetSampleRate(uint aRate);
 
 void retroKeyEvent(bool down, unsigned keycode, uint32_t character, uint16_t key_modifiers);
 
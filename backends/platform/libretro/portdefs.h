@@ -36,3 +36,4 @@
 
 #define RES_W 640
 #define RES_H 480
+#define FRAME_RATE 60
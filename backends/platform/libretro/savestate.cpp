@@ -0,0 +1,290 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "savestate.h"
+#include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "engines/engine.h"
+
+/**
+ * Stream handed to the engine in place of the savegame file, appending to
+ * the capture buffer of the save file manager.
+ */
+class RetroCaptureStream : public Common::WriteStream
+{
+   public:
+      RetroCaptureStream(RetroSaveFileManager *manager) : _manager(manager), _err(false) {}
+
+      virtual uint32 write(const void *dataPtr, uint32 dataSize)
+      {
+         if(_err || !_manager->_capture)
+            return 0;
+
+         if(_manager->_captureSize + dataSize > _manager->_captureMax)
+         {
+            _manager->_captureOverflow = true;
+            _err = true;
+            return 0;
+         }
+
+         _manager->_capture->write(dataPtr, dataSize);
+         _manager->_captureSize += dataSize;
+         return dataSize;
+      }
+
+      virtual int32 pos() const { return _manager->_captureSize; }
+      virtual bool err() const { return _err; }
+      virtual void clearErr() { _err = false; }
+
+   private:
+      RetroSaveFileManager *_manager;
+      bool _err;
+};
+
+RetroSaveFileManager::RetroSaveFileManager(const Common::String &defaultSavepath) :
+   DefaultSaveFileManager(defaultSavepath),
+   _capture(0), _captureMax(0), _captureSize(0), _captureOpened(false), _captureOverflow(false),
+   _injectData(0), _injectSize(0)
+{
+}
+
+void RetroSaveFileManager::captureSave(Common::MemoryWriteStreamDynamic *out, uint32 maxSize)
+{
+   _capture = out;
+   _captureMax = maxSize;
+   _captureSize = 0;
+   _captureOpened = false;
+   _captureOverflow = false;
+   _captureName.clear();
+}
+
+void RetroSaveFileManager::injectLoad(const Common::String &filename, const byte *data, uint32 size)
+{
+   _injectName = filename;
+   _injectData = data;
+   _injectSize = size;
+}
+
+bool RetroSaveFileManager::endRedirect()
+{
+   const bool captured = !_capture || (_captureOpened && !_captureOverflow);
+
+   _capture = 0;
+   _injectName.clear();
+   _injectData = 0;
+   _injectSize = 0;
+
+   return captured;
+}
+
+Common::StringArray RetroSaveFileManager::listSavefiles(const Common::String &pattern)
+{
+   Common::StringArray list = DefaultSaveFileManager::listSavefiles(pattern);
+
+   // Engines may look the savegame up before loading it
+   if(_injectData && _injectName.matchString(pattern, true))
+   {
+      bool found = false;
+      for(uint i = 0; i < list.size() && !found; i ++)
+         found = list[i].equalsIgnoreCase(_injectName);
+      if(!found)
+         list.push_back(_injectName);
+   }
+
+   return list;
+}
+
+Common::InSaveFile *RetroSaveFileManager::openForLoading(const Common::String &filename)
+{
+   if(_injectData && filename.equalsIgnoreCase(_injectName))
+      return new Common::MemoryReadStream(_injectData, _injectSize, DisposeAfterUse::NO);
+
+   return DefaultSaveFileManager::openForLoading(filename);
+}
+
+Common::OutSaveFile *RetroSaveFileManager::openCapture(const Common::String &filename)
+{
+   // Only the savegame itself is captured, anything the engine saves
+   // alongside it still goes to the save directory
+   if(!_capture || _captureOpened)
+      return 0;
+
+   _captureOpened = true;
+   _captureName = filename;
+   // Grabbing the screen would cost more than the rest of the state
+   return new Common::OutSaveFile(new RetroCaptureStream(this), false);
+}
+
+Common::OutSaveFile *RetroSaveFileManager::openForSaving(const Common::String &filename, bool compress)
+{
+   Common::OutSaveFile *capture = openCapture(filename);
+   if(capture)
+      return capture;
+
+   return DefaultSaveFileManager::openForSaving(filename, compress);
+}
+
+// Engines treating the state slot as their autosave slot come here
+Common::OutSaveFile *RetroSaveFileManager::openForAutosaving(const Common::String &filename, bool compress)
+{
+   Common::OutSaveFile *capture = openCapture(filename);
+   if(capture)
+      return capture;
+
+   return DefaultSaveFileManager::openForAutosaving(filename, compress);
+}
+
+/*
+ * A state is laid out as:
+ *
+ *    uint32BE   RETRO_STATE_MAGIC
+ *    byte       RETRO_STATE_VERSION
+ *    string     target the state was taken from
+ *    uint32LE   savegame size
+ *    ...        savegame, as written by the engine
+ *    string     savegame file name
+ *
+ * where strings are a uint16LE length followed by the characters. The
+ * frontend may pad the state past its end.
+ */
+
+#define RETRO_STATE_MAGIC MKTAG('S','V','M','S')
+#define RETRO_STATE_VERSION 1
+
+// Savestates do not show up among the regular savegames, so the slot only
+// matters to engines deriving the file name from it
+#define RETRO_STATE_SLOT 0
+
+static Common::MemoryWriteStreamDynamic *s_state = 0;
+static uint32 s_stateSize = 0;
+
+static RetroSaveFileManager *getSaveFileManager()
+{
+   return (RetroSaveFileManager *)g_system->getSavefileManager();
+}
+
+static void writeString(Common::WriteStream &out, const Common::String &str)
+{
+   out.writeUint16LE(str.size());
+   out.write(str.c_str(), str.size());
+}
+
+static bool readString(Common::SeekableReadStream &in, Common::String &str)
+{
+   const uint16 size = in.readUint16LE();
+   if(in.eos() || in.size() - in.pos() < size)
+      return false;
+
+   str.clear();
+   for(uint16 i = 0; i < size; i ++)
+      str += (char)in.readByte();
+   return true;
+}
+
+bool retroStateSave()
+{
+   if(!g_engine || !g_engine->canSaveGameStateCurrently())
+      return false;
+
+   // The buffer is kept from one state to the next, so that taking one
+   // every frame does not reallocate it
+   if(!s_state)
+      s_state = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+   s_state->seek(0);
+   s_stateSize = 0;
+
+   s_state->writeUint32BE(RETRO_STATE_MAGIC);
+   s_state->writeByte(RETRO_STATE_VERSION);
+   writeString(*s_state, ConfMan.getActiveDomainName());
+
+   // The size is filled in once saved
+   const uint32 sizePos = s_state->pos();
+   s_state->writeUint32LE(0);
+
+   RetroSaveFileManager *saveFileMan = getSaveFileManager();
+   saveFileMan->captureSave(s_state, RETRO_STATE_MAX_SIZE - 1024);
+   const Common::Error error = g_engine->saveGameState(RETRO_STATE_SLOT, "libretro");
+   const bool captured = saveFileMan->endRedirect();
+
+   if(error.getCode() != Common::kNoError || !captured)
+      return false;
+
+   // The file name is only known once saved as well
+   const uint32 size = saveFileMan->getCapturedSize();
+   writeString(*s_state, saveFileMan->getCapturedName());
+   s_stateSize = s_state->pos();
+
+   s_state->seek(sizePos);
+   s_state->writeUint32LE(size);
+
+   if(s_stateSize > RETRO_STATE_MAX_SIZE)
+   {
+      s_stateSize = 0;
+      return false;
+   }
+   return true;
+}
+
+bool retroStateLoad(const void *data, size_t size)
+{
+   if(!g_engine || !g_engine->canLoadGameStateCurrently())
+      return false;
+
+   Common::MemoryReadStream in((const byte *)data, size);
+   if(in.readUint32BE() != RETRO_STATE_MAGIC || in.readByte() != RETRO_STATE_VERSION)
+      return false;
+
+   // States only apply to the game they were taken from
+   Common::String target;
+   if(!readString(in, target) || !target.equals(ConfMan.getActiveDomainName()))
+      return false;
+
+   const uint32 saveSize = in.readUint32LE();
+   const uint32 savePos = in.pos();
+   if(in.eos() || in.size() - savePos < saveSize)
+      return false;
+
+   Common::String name;
+   in.seek(saveSize, SEEK_CUR);
+   if(!readString(in, name))
+      return false;
+
+   RetroSaveFileManager *saveFileMan = getSaveFileManager();
+   saveFileMan->injectLoad(name, (const byte *)data + savePos, saveSize);
+   const Common::Error error = g_engine->loadGameState(RETRO_STATE_SLOT);
+   saveFileMan->endRedirect();
+
+   return error.getCode() == Common::kNoError;
+}
+
+const void *retroStateData()
+{
+   return s_state ? s_state->getData() : 0;
+}
+
+size_t retroStateSize()
+{
+   return s_stateSize;
+}
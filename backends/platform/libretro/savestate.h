@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_LIBRETRO_SAVESTATE_H
+#define BACKENDS_LIBRETRO_SAVESTATE_H
+
+#include "backends/saves/default/default-saves.h"
+
+namespace Common {
+class MemoryWriteStreamDynamic;
+}
+
+/**
+ * Save file manager of the core. On top of the save directory, it can
+ * redirect a single savegame to memory, which is how the frontend
+ * savestates are taken without touching the disk.
+ */
+class RetroSaveFileManager : public DefaultSaveFileManager {
+public:
+   RetroSaveFileManager(const Common::String &defaultSavepath);
+
+   /**
+    * Capture the first file opened for saving from now on into @p out,
+    * starting at its current position. No compression is applied and the
+    * file fails with an error once it grows past @p maxSize bytes.
+    */
+   void captureSave(Common::MemoryWriteStreamDynamic *out, uint32 maxSize);
+
+   /** Serve any load of @p filename from the given buffer from now on. */
+   void injectLoad(const Common::String &filename, const byte *data, uint32 size);
+
+   /**
+    * Go back to the save directory.
+    *
+    * @return false if a capture was requested but nothing, or more than
+    *         @p maxSize bytes, was saved.
+    */
+   bool endRedirect();
+
+   /** Name of the file captured by the last captureSave(), and its size. */
+   const Common::String &getCapturedName() const { return _captureName; }
+   uint32 getCapturedSize() const { return _captureSize; }
+
+   virtual Common::StringArray listSavefiles(const Common::String &pattern);
+   virtual Common::InSaveFile *openForLoading(const Common::String &filename);
+   virtual Common::OutSaveFile *openForSaving(const Common::String &filename, bool compress = true);
+   virtual Common::OutSaveFile *openForAutosaving(const Common::String &filename, bool compress = true);
+
+private:
+   friend class RetroCaptureStream;
+
+   Common::OutSaveFile *openCapture(const Common::String &filename);
+
+   Common::MemoryWriteStreamDynamic *_capture;
+   uint32 _captureMax;
+   uint32 _captureSize;
+   bool _captureOpened;
+   bool _captureOverflow;
+   Common::String _captureName;
+
+   Common::String _injectName;
+   const byte *_injectData;
+   uint32 _injectSize;
+};
+
+/**
+ * Frontend savestates, backing retro_serialize() and retro_unserialize().
+ * Both have to run on the emulator thread, while the engine is waiting for
+ * the next frame.
+ */
+bool retroStateSave();
+bool retroStateLoad(const void *data, size_t size);
+
+/** The state taken by the last successful retroStateSave(). */
+const void *retroStateData();
+size_t retroStateSize();
+
+/** Upper bound of a state, engines saving more do not support savestates. */
+#define RETRO_STATE_MAX_SIZE (16 * 1024 * 1024)
+
+#endif
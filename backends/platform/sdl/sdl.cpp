@@ -550,6 +550,59 @@ void OSystem_SDL::getTimeAndDate(TimeDate &td) const {
 	td.tm_wday = t.tm_wday;
 }
 
+namespace {
+struct SdlThread {
+	OSystem::ThreadProc proc;
+	void *data;
+	SDL_Thread *thread;
+};
+
+int SDLCALL sdlThreadEntry(void *data) {
+	SdlThread *thread = (SdlThread *)data;
+	thread->proc(thread->data);
+	return 0;
+}
+} // End of anonymous namespace
+
+OSystem::ThreadRef OSystem_SDL::createThread(ThreadProc proc, void *data) {
+	SdlThread *thread = new SdlThread;
+	thread->proc = proc;
+	thread->data = data;
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	thread->thread = SDL_CreateThread(sdlThreadEntry, "ScummVM worker", thread);
+#else
+	thread->thread = SDL_CreateThread(sdlThreadEntry, thread);
+#endif
+
+	if (!thread->thread) {
+		delete thread;
+		return 0;
+	}
+	return (ThreadRef)thread;
+}
+
+void OSystem_SDL::joinThread(ThreadRef thread) {
+	SdlThread *sdlThread = (SdlThread *)thread;
+	SDL_WaitThread(sdlThread->thread, 0);
+	delete sdlThread;
+}
+
+OSystem::SemaphoreRef OSystem_SDL::createSemaphore(uint value) {
+	return (SemaphoreRef)SDL_CreateSemaphore(value);
+}
+
+void OSystem_SDL::waitSemaphore(SemaphoreRef semaphore) {
+	SDL_SemWait((SDL_sem *)semaphore);
+}
+
+void OSystem_SDL::postSemaphore(SemaphoreRef semaphore) {
+	SDL_SemPost((SDL_sem *)semaphore);
+}
+
+void OSystem_SDL::deleteSemaphore(SemaphoreRef semaphore) {
+	SDL_DestroySemaphore((SDL_sem *)semaphore);
+}
+
 Audio::Mixer *OSystem_SDL::getMixer() {
 	assert(_mixerManager);
 	return getMixerManager()->getMixer();
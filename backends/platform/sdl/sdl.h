@@ -78,6 +78,12 @@ public:
 	virtual uint32 getMillis(bool skipRecord = false);
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td) const;
+	virtual ThreadRef createThread(ThreadProc proc, void *data);
+	virtual void joinThread(ThreadRef thread);
+	virtual SemaphoreRef createSemaphore(uint value);
+	virtual void waitSemaphore(SemaphoreRef semaphore);
+	virtual void postSemaphore(SemaphoreRef semaphore);
+	virtual void deleteSemaphore(SemaphoreRef semaphore);
 	virtual Audio::Mixer *getMixer();
 	virtual Common::TimerManager *getTimerManager();
 	virtual Common::SaveFileManager *getSavefileManager();
@@ -41,6 +41,7 @@
 #include "common/fs.h"
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/memstream.h"
 #include "common/zlib.h"
 
 #ifndef _WIN32_WCE
@@ -51,6 +52,66 @@
 const char *DefaultSaveFileManager::TIMESTAMPS_FILENAME = "timestamps";
 #endif
 
+/**
+ * Stream handed to the engine in place of the savefile. The data is kept
+ * in memory, and written once the savefile is finalized. Background
+ * writes are only queued, their errors never reach err().
+ */
+class SaveFileBuffer : public Common::WriteStream {
+public:
+	SaveFileBuffer(SaveFileWriter &writer, const Common::String &path, bool compress, int level, bool background)
+		: _writer(writer), _path(path), _compress(compress), _level(level), _background(background),
+		  _buffer(DisposeAfterUse::NO), _finalized(false), _err(false) {
+	}
+
+	~SaveFileBuffer() {
+		finalize();
+	}
+
+	virtual uint32 write(const void *dataPtr, uint32 dataSize) {
+		if (_finalized) {
+			_err = true;
+			return 0;
+		}
+
+		return _buffer.write(dataPtr, dataSize);
+	}
+
+	virtual void finalize() {
+		if (_finalized)
+			return;
+
+		// The writer takes ownership of the buffer
+		_finalized = true;
+		if (!_background) {
+			if (!_writer.writeNow(_path, _buffer.getData(), _buffer.size(), _compress, _level))
+				_err = true;
+			return;
+		}
+
+		_writer.write(_path, _buffer.getData(), _buffer.size(), _compress, _level);
+
+#if defined(USE_CLOUD) && defined(USE_LIBCURL)
+		// The savefile is synced right away
+		_writer.flush();
+#endif
+	}
+
+	virtual int32 pos() const { return _buffer.pos(); }
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _err = false; }
+
+private:
+	SaveFileWriter &_writer;
+	Common::String _path;
+	bool _compress;
+	int _level;
+	bool _background;
+	Common::MemoryWriteStreamDynamic _buffer;
+	bool _finalized;
+	bool _err;
+};
+
 DefaultSaveFileManager::DefaultSaveFileManager() {
 }
 
@@ -107,6 +168,7 @@ Common::InSaveFile *DefaultSaveFileManager::openRawFile(const Common::String &fi
 		return nullptr;
 	} else {
 		// Open the file for loading.
+		waitForSavefile(file->_value);
 		Common::SeekableReadStream *sf = file->_value.createReadStream();
 		return sf;
 	}
@@ -129,12 +191,21 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 		return nullptr;
 	} else {
 		// Open the file for loading.
+		waitForSavefile(file->_value);
 		Common::SeekableReadStream *sf = file->_value.createReadStream();
 		return Common::wrapCompressedReadStream(sf);
 	}
 }
 
 Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String &filename, bool compress) {
+	return openSavefile(filename, compress, false);
+}
+
+Common::OutSaveFile *DefaultSaveFileManager::openForAutosaving(const Common::String &filename, bool compress) {
+	return openSavefile(filename, compress, true);
+}
+
+Common::OutSaveFile *DefaultSaveFileManager::openSavefile(const Common::String &filename, bool compress, bool background) {
 	// Assure the savefile name cache is up-to-date.
 	const Common::String savePathName = getSavePath();
 	assureCached(savePathName);
@@ -166,11 +237,13 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 		fileNode = file->_value;
 	}
 
-	// Open the file for saving.
-	Common::WriteStream *const sf = fileNode.createWriteStream();
-	Common::OutSaveFile *const result = new Common::OutSaveFile(compress ? Common::wrapCompressedWriteStream(sf) : sf);
+	// The file is written once the engine is done with it
+	int level = -1;
+	if (ConfMan.hasKey("save_compression_level"))
+		level = ConfMan.getInt("save_compression_level");
+	Common::OutSaveFile *const result = new Common::OutSaveFile(new SaveFileBuffer(_writer, fileNode.getPath(), compress, level, background));
 
-	// Add file to cache now that it exists.
+	// Add file to cache, as if it already existed.
 	_saveFileCache[filename] = Common::FSNode(fileNode.getPath());
 
 	return result;
@@ -198,6 +271,8 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 		return false;
 	} else {
 		const Common::FSNode fileNode = file->_value;
+		waitForSavefile(fileNode);
+
 		// Remove from cache, this invalidates the 'file' iterator.
 		_saveFileCache.erase(file);
 		file = _saveFileCache.end();
@@ -220,6 +295,15 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 	}
 }
 
+void DefaultSaveFileManager::flushSavefiles() {
+	_writer.flush();
+}
+
+void DefaultSaveFileManager::waitForSavefile(const Common::FSNode &file) {
+	if (_writer.isPending(file.getPath()))
+		_writer.flush();
+}
+
 Common::String DefaultSaveFileManager::getSavePath() const {
 
 	Common::String dir;
@@ -265,6 +349,9 @@ void DefaultSaveFileManager::assureCached(const Common::String &savePathName) {
 		return;
 	}
 
+	// Files being written would show up under a temporary name
+	_writer.flush();
+
 	// FSNode can cache its members, thus create it after checkPath to reflect
 	// actual file system state.
 	const Common::FSNode savePath(savePathName);
@@ -276,6 +363,10 @@ void DefaultSaveFileManager::assureCached(const Common::String &savePathName) {
 
 	// Build the savefile name cache.
 	for (Common::FSList::const_iterator file = children.begin(), end = children.end(); file != end; ++file) {
+		// Leftovers of savefiles which failed to be written
+		if (file->getName().hasSuffix(SAVEFILE_WRITER_TEMP_SUFFIX))
+			continue;
+
 		if (_saveFileCache.contains(file->getName())) {
 			warning("DefaultSaveFileManager::assureCached: Name clash when building cache, ignoring file '%s'", file->getName().c_str());
 		} else {
@@ -28,10 +28,18 @@
 #include "common/str.h"
 #include "common/fs.h"
 #include "common/hash-str.h"
+#include "backends/saves/default/savefile-writer.h"
 #include <limits.h>
 
 /**
  * Provides a default savefile manager implementation for common platforms.
+ *
+ * Savefiles are kept in memory while the engine writes them, and written
+ * to disk once they are finalized, see SaveFileWriter. Finalizing a savefile
+ * waits for it to be written, so that err() reports any failure, except
+ * for autosaves, which are written in the background.
+ * The compression level can be set with the "save_compression_level"
+ * configuration key, from 0 (none) and 1 (fastest) to 9 (best).
  */
 class DefaultSaveFileManager : public Common::SaveFileManager {
 public:
@@ -43,8 +51,12 @@ public:
 	virtual Common::InSaveFile *openRawFile(const Common::String &filename);
 	virtual Common::InSaveFile *openForLoading(const Common::String &filename);
 	virtual Common::OutSaveFile *openForSaving(const Common::String &filename, bool compress = true);
+	virtual Common::OutSaveFile *openForAutosaving(const Common::String &filename, bool compress = true);
 	virtual bool removeSavefile(const Common::String &filename);
 
+	/** Wait until all the savefiles are written to disk. */
+	void flushSavefiles();
+
 #ifdef USE_LIBCURL
 
 	static const uint32 INVALID_TIMESTAMP = UINT_MAX;
@@ -94,6 +106,20 @@ protected:
 	 */
 	Common::StringArray _lockedFiles;
 
+	/**
+	 * Wait until the given savefile is written to disk, in case it was
+	 * just saved.
+	 */
+	void waitForSavefile(const Common::FSNode &file);
+
+	/**
+	 * Open a savefile for saving, written in the background if
+	 * @p background is set.
+	 */
+	Common::OutSaveFile *openSavefile(const Common::String &filename, bool compress, bool background);
+
+	SaveFileWriter _writer;
+
 private:
 	/**
 	 * The currently cached directory.
@@ -0,0 +1,218 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This define lets us use the system function remove() on Symbian, which
+// is disabled by default due to a macro conflict.
+// See backends/platform/symbian/src/portdefs.h .
+#define SYMBIAN_USE_SYSTEM_REMOVE
+
+#include "common/scummsys.h"
+
+#if !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+
+#include "backends/saves/default/savefile-writer.h"
+
+#include "common/fs.h"
+#include "common/stream.h"
+#include "common/textconsole.h"
+#include "common/zlib.h"
+
+#if defined(WIN32) && !defined(_WIN32_WCE)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef ARRAYSIZE // winnt.h defines ARRAYSIZE, but we want our own one...
+#endif
+
+SaveFileWriter::SaveFileWriter() : _threadDone(false), _thread(0) {
+}
+
+SaveFileWriter::~SaveFileWriter() {
+	flush();
+}
+
+void SaveFileWriter::write(const Common::String &path, byte *data, uint32 size, bool compress, int level) {
+	reportFailures();
+
+	Job *job = new Job;
+	job->path = Common::String(path.c_str());
+	job->data = data;
+	job->size = size;
+	job->compress = compress;
+	job->level = level;
+
+	{
+		Common::StackLock lock(_mutex);
+		_jobs.push_back(job);
+
+		if (_thread && !_threadDone)
+			return;
+	}
+
+	// The thread quits once it runs out of files to write
+	if (_thread)
+		g_system->joinThread(_thread);
+
+	_threadDone = false;
+	_thread = g_system->createThread(threadProc, this);
+	if (!_thread) {
+		runJobs();
+		reportFailures();
+	}
+}
+
+bool SaveFileWriter::writeNow(const Common::String &path, byte *data, uint32 size, bool compress, int level) {
+	// An autosave still on its way must not land over this file afterwards
+	if (isPending(path))
+		flush();
+
+	Job job;
+	job.path = path;
+	job.data = data;
+	job.size = size;
+	job.compress = compress;
+	job.level = level;
+
+	const bool success = writeFile(job);
+	free(data);
+	return success;
+}
+
+bool SaveFileWriter::isPending(const Common::String &path) {
+	Common::StackLock lock(_mutex);
+
+	if (_currentPath == path)
+		return true;
+
+	for (Common::List<Job *>::const_iterator i = _jobs.begin(); i != _jobs.end(); ++i) {
+		if ((*i)->path == path)
+			return true;
+	}
+
+	return false;
+}
+
+void SaveFileWriter::flush() {
+	if (_thread) {
+		g_system->joinThread(_thread);
+		_thread = 0;
+	}
+
+	reportFailures();
+}
+
+void SaveFileWriter::threadProc(void *data) {
+	SaveFileWriter *writer = (SaveFileWriter *)data;
+	writer->runJobs();
+}
+
+void SaveFileWriter::runJobs() {
+	while (true) {
+		Job *job;
+		{
+			Common::StackLock lock(_mutex);
+			if (_jobs.empty()) {
+				_threadDone = true;
+				return;
+			}
+
+			job = _jobs.front();
+			_jobs.pop_front();
+			_currentPath = job->path.c_str();
+		}
+
+		const bool success = writeFile(*job);
+		free(job->data);
+
+		Common::StackLock lock(_mutex);
+
+		// Hand the path over while holding the lock, so that no reference
+		// counted data is left behind on this thread
+		if (!success)
+			_failures.push_back(job->path);
+		_currentPath.clear();
+		delete job;
+	}
+}
+
+bool SaveFileWriter::writeFile(const Job &job) {
+	const Common::String tempPath = job.path + SAVEFILE_WRITER_TEMP_SUFFIX;
+
+	Common::WriteStream *file = Common::FSNode(tempPath).createWriteStream();
+	if (!file)
+		return false;
+
+	if (job.compress)
+		file = Common::wrapCompressedWriteStream(file, job.level);
+
+	file->write(job.data, job.size);
+	file->finalize();
+	const bool success = !file->err();
+	delete file;
+
+	if (!success) {
+		remove(tempPath.c_str());
+		return false;
+	}
+
+	if (!replaceFile(tempPath, job.path)) {
+		remove(tempPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool SaveFileWriter::replaceFile(const Common::String &from, const Common::String &to) {
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	// rename() does not overwrite existing files on Windows
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	if (rename(from.c_str(), to.c_str()) == 0)
+		return true;
+
+	// Not all systems can rename over an existing file. The previous
+	// version is moved aside rather than removed, so that it can be put
+	// back if the second rename fails as well.
+	const Common::String backupPath = to + SAVEFILE_WRITER_BACKUP_SUFFIX;
+	remove(backupPath.c_str());
+	if (rename(to.c_str(), backupPath.c_str()) != 0)
+		return false;
+
+	if (rename(from.c_str(), to.c_str()) != 0) {
+		rename(backupPath.c_str(), to.c_str());
+		return false;
+	}
+
+	remove(backupPath.c_str());
+	return true;
+#endif
+}
+
+void SaveFileWriter::reportFailures() {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _failures.size(); i++)
+		warning("SaveFileWriter: Failed to write '%s'", _failures[i].c_str());
+	_failures.clear();
+}
+
+#endif // !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
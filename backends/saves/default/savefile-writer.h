@@ -0,0 +1,112 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if !defined(BACKEND_SAVES_SAVEFILE_WRITER_H) && !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+#define BACKEND_SAVES_SAVEFILE_WRITER_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/str.h"
+#include "common/system.h"
+
+/**
+ * Writes savefiles to disk, either right away or on a background thread, so
+ * that autosaves do not stall the engine for the time it takes to compress
+ * and write the data.
+ *
+ * Each file is written next to its final location first, with the
+ * SAVEFILE_WRITER_TEMP_SUFFIX suffix, and then renamed over the previous
+ * version of the file. A savefile which fails to be written hence leaves the
+ * previous one untouched. Failures of background writes are reported as
+ * warnings.
+ *
+ * If the backend does not support threads, the files are written right
+ * away on the calling thread instead.
+ */
+class SaveFileWriter {
+public:
+	SaveFileWriter();
+
+	/** Waits for all the files to be written. */
+	~SaveFileWriter();
+
+	/**
+	 * Queue the data of a savefile for writing.
+	 *
+	 * @param path		native path of the savefile
+	 * @param data		the data, allocated with malloc(); the writer takes
+	 *					ownership of it
+	 * @param size		size of the data
+	 * @param compress	whether to compress the data with gzip
+	 * @param level		zlib compression level, -1 for zlib's default
+	 */
+	void write(const Common::String &path, byte *data, uint32 size, bool compress, int level);
+
+	/**
+	 * Write a savefile on the calling thread, once any pending write of the
+	 * same file is done. Takes the same parameters as write().
+	 *
+	 * @return whether the file was written
+	 */
+	bool writeNow(const Common::String &path, byte *data, uint32 size, bool compress, int level);
+
+	/** Whether a file is waiting to be written. */
+	bool isPending(const Common::String &path);
+
+	/** Wait until all the files queued so far are written. */
+	void flush();
+
+private:
+	struct Job {
+		Common::String path;
+		byte *data;
+		uint32 size;
+		bool compress;
+		int level;
+	};
+
+	Common::Mutex _mutex;
+
+	// Protected by _mutex
+	Common::List<Job *> _jobs;
+	Common::String _currentPath;
+	Common::Array<Common::String> _failures;
+	bool _threadDone;
+
+	OSystem::ThreadRef _thread;
+
+	void runJobs();
+	void reportFailures();
+
+	static bool writeFile(const Job &job);
+	static bool replaceFile(const Common::String &from, const Common::String &to);
+	static void threadProc(void *data);
+};
+
+/** Suffix of the files being written by a SaveFileWriter. */
+#define SAVEFILE_WRITER_TEMP_SUFFIX ".part"
+
+/** Suffix of the previous version of a file while it is being replaced. */
+#define SAVEFILE_WRITER_BACKUP_SUFFIX ".bak"
+
+#endif
@@ -29,7 +29,7 @@
 
 namespace Common {
 
-OutSaveFile::OutSaveFile(WriteStream *w): _wrapped(w) {}
+OutSaveFile::OutSaveFile(WriteStream *w, bool screenThumbnail): _wrapped(w), _screenThumbnail(screenThumbnail) {}
 
 OutSaveFile::~OutSaveFile() {}
 
@@ -25,57 +25,61 @@
 #include "common/util.h"
 #include "common/system.h"
 
-struct TimerSlot {
-	Common::TimerManager::TimerProc callback;
-	void *refCon;
-	Common::String id;
-	uint32 interval;	// in microseconds
-
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// microseconds part of nextFire
-
-	TimerSlot *next;
-};
+bool DefaultTimerManager::firesBefore(uint a, uint b) const {
+	const TimerSlot &slotA = _slots[a];
+	const TimerSlot &slotB = _slots[b];
+	if (slotA.nextFireTime != slotB.nextFireTime)
+		return slotA.nextFireTime < slotB.nextFireTime;
+
+	// Timers due at the same time fire in the order they were scheduled
+	return (int32)(slotA.sequence - slotB.sequence) < 0;
+}
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
+void DefaultTimerManager::queueSwap(uint posA, uint posB) {
+	SWAP(_queue[posA], _queue[posB]);
+	_slots[_queue[posA]].heapPos = posA;
+	_slots[_queue[posB]].heapPos = posB;
+}
 
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = 0;
+void DefaultTimerManager::siftUp(uint pos) {
+	while (pos > 0) {
+		const uint parent = (pos - 1) / 2;
+		if (!firesBefore(_queue[pos], _queue[parent]))
+			break;
+		queueSwap(pos, parent);
+		pos = parent;
+	}
+}
 
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
+void DefaultTimerManager::siftDown(uint pos) {
 	while (true) {
-		assert(slot);
-		if (slot->next == 0 || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
+		const uint left = pos * 2 + 1;
+		const uint right = left + 1;
+		uint first = pos;
+
+		if (left < _queue.size() && firesBefore(_queue[left], _queue[first]))
+			first = left;
+		if (right < _queue.size() && firesBefore(_queue[right], _queue[first]))
+			first = right;
+		if (first == pos)
+			break;
+
+		queueSwap(pos, first);
+		pos = first;
 	}
 }
 
 
-DefaultTimerManager::DefaultTimerManager() :
-	_head(0) {
-
-	_head = new TimerSlot();
-	memset(_head, 0, sizeof(TimerSlot));
+DefaultTimerManager::DefaultTimerManager() : _nextSequence(0) {
 }
 
 DefaultTimerManager::~DefaultTimerManager() {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
-	}
-	_head = 0;
+	_slots.clear();
+	_freeSlots.clear();
+	_queue.clear();
+	_slotIndex.clear();
 }
 
 void DefaultTimerManager::handler() {
@@ -84,28 +88,36 @@ void DefaultTimerManager::handler() {
 	uint32 curTime = g_system->getMillis(true);
 
 	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
-
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
-		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
+	while (!_queue.empty() && _slots[_queue[0]].nextFireTime < curTime) {
+		TimerSlot &slot = _slots[_queue[0]];
+
+		// Keep track of how late the timer is. If it is late by a whole
+		// interval, it is going to fire again right away.
+		const uint32 lateness = curTime - slot.nextFireTime;
+		if (lateness > slot.maxLateness)
+			slot.maxLateness = lateness;
+		if (lateness * 1000 - slot.nextFireTimeMicro >= slot.interval)
+			slot.overrunCount++;
+		slot.fireCount++;
+
+		// Update the fire time and move the TimerSlot to its new place in
+		// the priority queue.
+		assert(slot.interval > 0);
+		slot.nextFireTime += (slot.interval / 1000);
+		slot.nextFireTimeMicro += (slot.interval % 1000);
+		if (slot.nextFireTimeMicro > 1000) {
+			slot.nextFireTime += slot.nextFireTimeMicro / 1000;
+			slot.nextFireTimeMicro %= 1000;
 		}
-		insertPrioQueue(_head, slot);
-
-		// Invoke the timer callback
-		assert(slot->callback);
-		slot->callback(slot->refCon);
-
-		// Look at the next scheduled timer
-		slot = _head->next;
+		slot.sequence = _nextSequence++;
+		siftDown(0);
+
+		// Invoke the timer callback. It may install or remove timers, which
+		// invalidates slot.
+		assert(slot.callback);
+		TimerProc callback = slot.callback;
+		void *refCon = slot.refCon;
+		callback(refCon);
 	}
 }
 
@@ -127,16 +139,32 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	}
 	_callbacks[id] = callback;
 
-	TimerSlot *slot = new TimerSlot;
-	slot->callback = callback;
-	slot->refCon = refCon;
-	slot->id = id;
-	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = 0;
+	uint index;
+	if (_freeSlots.empty()) {
+		index = _slots.size();
+		_slots.push_back(TimerSlot());
+	} else {
+		index = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+
+	TimerSlot &slot = _slots[index];
+	slot.callback = callback;
+	slot.refCon = refCon;
+	slot.id = id;
+	slot.interval = interval;
+	slot.nextFireTime = g_system->getMillis() + interval / 1000;
+	slot.nextFireTimeMicro = interval % 1000;
+	slot.fireCount = 0;
+	slot.overrunCount = 0;
+	slot.maxLateness = 0;
+	slot.sequence = _nextSequence++;
+
+	slot.heapPos = _queue.size();
+	_queue.push_back(index);
+	siftUp(slot.heapPos);
 
-	insertPrioQueue(_head, slot);
+	_slotIndex[callback] = index;
 
 	return true;
 }
@@ -144,16 +172,26 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
+	TimerIndexMap::iterator entry = _slotIndex.find(callback);
+	if (entry != _slotIndex.end()) {
+		const uint index = entry->_value;
+		const uint pos = _slots[index].heapPos;
+		_slotIndex.erase(entry);
+
+		// Fill the hole with the last timer of the queue
+		const uint last = _queue.size() - 1;
+		if (pos != last) {
+			queueSwap(pos, last);
+			_queue.pop_back();
+			siftDown(pos);
+			siftUp(pos);
 		} else {
-			slot = slot->next;
+			_queue.pop_back();
 		}
+
+		_slots[index].callback = 0;
+		_slots[index].id.clear();
+		_freeSlots.push_back(index);
 	}
 
 	// We need to remove all names referencing the timer proc here.
@@ -173,3 +211,21 @@ void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 			_callbacks.erase(i);
 	}
 }
+
+Common::TimerManager::TimerInfoList DefaultTimerManager::listTimers() {
+	Common::StackLock lock(_mutex);
+
+	TimerInfoList list;
+	for (uint i = 0; i < _queue.size(); ++i) {
+		const TimerSlot &slot = _slots[_queue[i]];
+
+		TimerInfo info;
+		info.id = slot.id;
+		info.interval = slot.interval;
+		info.fireCount = slot.fireCount;
+		info.overrunCount = slot.overrunCount;
+		info.maxLateness = slot.maxLateness;
+		list.push_back(info);
+	}
+	return list;
+}
@@ -24,25 +24,68 @@
 #define BACKENDS_TIMER_DEFAULT_H
 
 #include "common/str.h"
+#include "common/array.h"
 #include "common/hash-str.h"
 #include "common/timer.h"
 #include "common/mutex.h"
 
-struct TimerSlot;
+struct TimerSlot {
+	Common::TimerManager::TimerProc callback;
+	void *refCon;
+	Common::String id;
+	uint32 interval;	// in microseconds
+
+	uint32 nextFireTime;	// in milliseconds
+	uint32 nextFireTimeMicro;	// microseconds part of nextFire
+
+	uint32 sequence;	// order of scheduling, among timers due at the same time
+	uint heapPos;	// position in the priority queue
+
+	uint32 fireCount;
+	uint32 overrunCount;
+	uint32 maxLateness;	// in milliseconds
+};
 
 class DefaultTimerManager : public Common::TimerManager {
 private:
 	typedef Common::HashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
 
+	struct TimerProc_Hash {
+		uint operator()(TimerProc proc) const { return (uint)(size_t)proc; }
+	};
+	typedef Common::HashMap<TimerProc, uint, TimerProc_Hash> TimerIndexMap;
+
 	Common::Mutex _mutex;
-	TimerSlot *_head;
 	TimerSlotMap _callbacks;
 
+	/**
+	 * The timers. Their index never changes once installed, and acts as a
+	 * handle, but installing a timer may move all of them. Unused entries
+	 * are listed in _freeSlots for reuse.
+	 */
+	Common::Array<TimerSlot> _slots;
+	Common::Array<uint> _freeSlots;
+
+	/** Indices in _slots, as a binary min-heap on the next fire time. */
+	Common::Array<uint> _queue;
+
+	/** Indices in _slots by callback. */
+	TimerIndexMap _slotIndex;
+
+	/** Sequence number of the next timer scheduled. */
+	uint32 _nextSequence;
+
+	bool firesBefore(uint a, uint b) const;
+	void queueSwap(uint posA, uint posB);
+	void siftUp(uint pos);
+	void siftDown(uint pos);
+
 public:
 	DefaultTimerManager();
 	virtual ~DefaultTimerManager();
 	virtual bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id);
 	virtual void removeTimerProc(TimerProc proc);
+	virtual TimerInfoList listTimers();
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
@@ -27,6 +27,7 @@
 
 #include <limits.h>
 
+#include "engines/gameScanner.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
 #include "base/plugins.h"
@@ -36,6 +37,7 @@
 #include "common/fs.h"
 #include "common/rendermode.h"
 #include "common/stack.h"
+#include "common/stream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
@@ -131,6 +133,8 @@ static const char HELP_STRING[] =
 	"  --native-mt32            True Roland MT-32 (disable GM emulation)\n"
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
+	"  --resampler=MODE         Select the sample rate converter (default, linear,\n"
+	"                           sinc)\n"
 	"  --opl-driver=DRIVER      Select AdLib (OPL) emulator (db, mame)\n"
 	"  --aspect-ratio           Enable aspect ratio correction\n"
 	"  --render-mode=MODE       Enable additional render modes (hercGreen, hercAmber,\n"
@@ -218,6 +222,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("midi_gain", 100);
 
 	ConfMan.registerDefault("music_driver", "auto");
+	ConfMan.registerDefault("resampler", "default");
 	ConfMan.registerDefault("mt32_device", "null");
 	ConfMan.registerDefault("gm_device", "null");
 
@@ -265,6 +270,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("record_mode", "none");
 	ConfMan.registerDefault("record_file_name", "record.bin");
 
+	ConfMan.registerDefault("memstats_file", "");
+	ConfMan.registerDefault("memstats_interval", 10);	// In seconds
+
 	ConfMan.registerDefault("gui_saveload_chooser", "grid");
 	ConfMan.registerDefault("gui_saveload_last_pos", "0");
 
@@ -435,6 +443,10 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			// HACK FIXME TODO: This command is intentionally *not* documented!
 			DO_LONG_COMMAND("test-detector")
 			END_COMMAND
+
+			// HACK FIXME TODO: This command is intentionally *not* documented!
+			DO_LONG_COMMAND("scan-benchmark")
+			END_COMMAND
 #endif
 
 #ifdef UPGRADE_ALL_TARGETS_HACK
@@ -474,6 +486,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_INT("output-rate")
 			END_OPTION
 
+			DO_LONG_OPTION("resampler")
+			END_OPTION
+
 			DO_OPTION_BOOL('f', "fullscreen")
 			END_OPTION
 
@@ -1004,6 +1019,89 @@ static void runDetectorTest() {
 	printf("Detector test run: %d fail, %d success, %d skipped, out of %d\n",
 			failure, success, total - failure - success, total);
 }
+
+enum {
+	kScanBenchmarkDepth = 4,
+	kScanBenchmarkFanOut = 6,
+	kScanBenchmarkFiles = 8,
+	kScanBenchmarkRuns = 3
+};
+
+static bool createScanBenchmarkTree(const Common::FSNode &dir, int depth, const DetectionFileMap &detectionFiles) {
+	// Name half of the files like files game detectors look at, so that
+	// they are checksummed as well
+	DetectionFileMap::const_iterator detectionFile = detectionFiles.begin();
+	for (int i = 0; i < kScanBenchmarkFiles; i++) {
+		Common::String name = Common::String::format("file%d.dat", i);
+		if ((i & 1) && detectionFile != detectionFiles.end()) {
+			name = detectionFile->_key;
+			++detectionFile;
+		}
+
+		Common::WriteStream *file = dir.getChild(name).createWriteStream();
+		if (!file)
+			return false;
+		for (uint32 j = 0; j < 4096; j++)
+			file->writeUint32LE(j * (depth + 1) + i);
+		delete file;
+	}
+
+	if (depth == 0)
+		return true;
+
+	for (int i = 0; i < kScanBenchmarkFanOut; i++) {
+		Common::FSNode subdir = dir.getChild(Common::String::format("dir%d", i));
+		if (!subdir.createDirectory() || !createScanBenchmarkTree(subdir, depth - 1, detectionFiles))
+			return false;
+	}
+	return true;
+}
+
+static void runScanBenchmark(const Common::String &path) {
+	// HACK: The following code measures how fast the mass add scanner walks
+	// a directory tree, with and without worker threads. A synthetic tree is
+	// created below the given path on the first run, and reused afterwards.
+	// The detection checksums are only computed on the first pass, so that
+	// pass is not timed.
+
+	Common::FSNode root = Common::FSNode(path.empty() ? "." : path).getChild("scan-benchmark");
+
+	if (!root.exists()) {
+		DetectionFileMap detectionFiles;
+		EngineMan.getDetectionFiles(detectionFiles);
+
+		printf("Creating the benchmark tree in '%s' ...\n", root.getPath().c_str());
+		if (!root.createDirectory() || !createScanBenchmarkTree(root, kScanBenchmarkDepth, detectionFiles)) {
+			printf(" ... failed\n");
+			return;
+		}
+	}
+
+	const uint threadCounts[] = { 0, GameScanner::kDefaultThreadCount };
+	for (int run = -1; run < kScanBenchmarkRuns; run++) {
+		for (uint i = 0; i < ARRAYSIZE(threadCounts); i++) {
+			const uint32 start = g_system->getMillis();
+			uint dirs = 0;
+
+			GameScanner scanner(root, threadCounts[i]);
+			while (!scanner.isDone()) {
+				Common::FSNode dir;
+				Common::FSList files;
+				if (scanner.nextDirectory(dir, files))
+					dirs++;
+				else
+					g_system->delayMillis(1);
+			}
+
+			if (run < 0)
+				break;
+
+			const uint32 elapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+			printf("%u threads: %u directories in %u ms, %u directories per second\n",
+					threadCounts[i], dirs, elapsed, dirs * 1000 / elapsed);
+		}
+	}
+}
 #endif
 
 #ifdef UPGRADE_ALL_TARGETS_HACK
@@ -1191,6 +1289,9 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 	else if (command == "test-detector") {
 		runDetectorTest();
 		return true;
+	} else if (command == "scan-benchmark") {
+		runScanBenchmark(settings["path"]);
+		return true;
 	}
 #endif
 #ifdef UPGRADE_ALL_TARGETS_HACK
@@ -444,6 +444,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 
 // Engine plugins
 
+#include "engines/detectionCache.h"
 #include "engines/metaengine.h"
 
 namespace Common {
@@ -527,9 +528,19 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 			candidates.push_back((**iter)->detectGames(fslist));
 		}
 	} while (PluginManager::instance().loadNextPlugin());
+
+	// Save the checksums computed for this directory, for the next scans
+	DetectionCache::instance().flush();
+
 	return candidates;
 }
 
+void EngineManager::getDetectionFiles(DetectionFileMap &files) const {
+	const EnginePlugin::List &plugins = getPlugins();
+	for (EnginePlugin::List::const_iterator iter = plugins.begin(); iter != plugins.end(); ++iter)
+		(**iter)->getDetectionFiles(files);
+}
+
 const EnginePlugin::List &EngineManager::getPlugins() const {
 	return (const EnginePlugin::List &)PluginManager::instance().getPlugins(PLUGIN_TYPE_ENGINE);
 }
@@ -62,6 +62,14 @@ int Archive::listMatchingMembers(ArchiveMemberList &list, const String &pattern)
 
 
 
+uint32 SearchSet::_generation = 0;
+
+// Upper bound on the number of names indexed, so that lookups of many
+// different missing files do not grow the index forever
+enum {
+	kMaxIndexSize = 16384
+};
+
 SearchSet::ArchiveNodeList::iterator SearchSet::find(const String &name) {
 	ArchiveNodeList::iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
@@ -92,6 +100,7 @@ void SearchSet::insert(const Node &node) {
 			break;
 	}
 	_list.insert(it, node);
+	invalidateIndex();
 }
 
 void SearchSet::add(const String &name, Archive *archive, int priority, bool autoFree) {
@@ -173,6 +182,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		invalidateIndex();
 	}
 }
 
@@ -187,6 +197,7 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	invalidateIndex();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -205,17 +216,36 @@ void SearchSet::setPriority(const String &name, int priority) {
 	insert(node);
 }
 
-bool SearchSet::hasFile(const String &name) const {
-	if (name.empty())
-		return false;
+SearchSet::IndexEntry &SearchSet::lookup(const String &name) const {
+	if (_indexGeneration != _generation) {
+		_index.clear();
+		_indexGeneration = _generation;
+	}
 
+	NameIndex::iterator i = _index.find(name);
+	if (i != _index.end())
+		return i->_value;
+
+	if (_index.size() >= kMaxIndexSize)
+		_index.clear();
+
+	IndexEntry &entry = _index[name];
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return true;
+		if (it->_arc->hasFile(name)) {
+			entry._arc = it->_arc;
+			break;
+		}
 	}
 
-	return false;
+	return entry;
+}
+
+bool SearchSet::hasFile(const String &name) const {
+	if (name.empty())
+		return false;
+
+	return lookup(name)._arc != 0;
 }
 
 int SearchSet::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
@@ -242,22 +272,31 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return it->_arc->getMember(name);
-	}
+	IndexEntry &entry = lookup(name);
+	if (entry._arc && !entry._member)
+		entry._member = entry._arc->getMember(name);
 
-	return ArchiveMemberPtr();
+	return entry._member;
 }
 
 SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) const {
 	if (name.empty())
 		return 0;
 
+	const IndexEntry &entry = lookup(name);
+	if (!entry._arc)
+		return 0;
+
+	SeekableReadStream *stream = entry._arc->createReadStreamForMember(name);
+	if (stream)
+		return stream;
+
+	// The member could not be opened, fall back to the other archives
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
-		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
+		if (it->_arc == entry._arc)
+			continue;
+		stream = it->_arc->createReadStreamForMember(name);
 		if (stream)
 			return stream;
 	}
@@ -24,6 +24,8 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -146,13 +148,29 @@ class SearchSet : public Archive {
 	typedef List<Node> ArchiveNodeList;
 	ArchiveNodeList _list;
 
+	// Which archive, if any, holds a given member. Filled as members are
+	// looked up, and dropped whenever any SearchSet changes, since sets may
+	// be nested.
+	struct IndexEntry {
+		Archive *_arc;
+		ArchiveMemberPtr _member;
+		IndexEntry() : _arc(0) {}
+	};
+	typedef HashMap<String, IndexEntry, IgnoreCase_Hash, IgnoreCase_EqualTo> NameIndex;
+	mutable NameIndex _index;
+	mutable uint32 _indexGeneration;
+	static uint32 _generation;
+
 	ArchiveNodeList::iterator find(const String &name);
 	ArchiveNodeList::const_iterator find(const String &name) const;
 
 	// Add an archive keeping the list sorted by descending priority.
 	void insert(const Node& node);
 
+	IndexEntry &lookup(const String &name) const;
+
 public:
+	SearchSet() : _indexGeneration(_generation) {}
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -236,6 +254,13 @@ public:
 	 */
 	void setPriority(const String& name, int priority);
 
+	/**
+	 * Forget which archives hold which members. Lookups are cached, so this
+	 * must be called when the content of a registered archive changes other
+	 * than by adding or removing archives of a SearchSet.
+	 */
+	static void invalidateIndex() { _generation++; }
+
 	virtual bool hasFile(const String &name) const;
 	virtual int listMatchingMembers(ArchiveMemberList &list, const String &pattern) const;
 	virtual int listMembers(ArchiveMemberList &list) const;
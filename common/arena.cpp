@@ -0,0 +1,125 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/arena.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Common {
+
+// Threads are told apart by the address of this variable, which differs
+// for each thread. Without thread local storage, all the threads share it
+// and the ownership checks of the arenas always pass.
+#if defined(__GNUC__)
+static __thread byte s_threadTag = 0;
+#elif defined(_MSC_VER)
+static __declspec(thread) byte s_threadTag = 0;
+#else
+static byte s_threadTag = 0;
+#endif
+
+Arena::Arena(size_t blockSize, bool poison)
+	: _current(0), _used(0), _blockSize(blockSize), _poison(poison), _blockAllocations(0), _owner(0) {
+}
+
+Arena::~Arena() {
+	reset(true);
+}
+
+void Arena::checkOwner() {
+	if (!_owner)
+		_owner = &s_threadTag;
+	assert(_owner == &s_threadTag);
+}
+
+void *Arena::allocSlow(size_t size) {
+	checkOwner();
+
+	// Move on to the next block, if there is one large enough left over
+	// from before the last release
+	uint next = _current;
+	if (_current < _blocks.size() && _used)
+		next++;
+	if (next >= _blocks.size() || _blocks[next].size < size) {
+		Block block;
+		block.size = MAX(_blockSize, size);
+		block.data = (byte *)malloc(block.size);
+		if (!block.data)
+			::error("Common::Arena: failure to allocate %u bytes", (uint)block.size);
+		_blockAllocations++;
+
+		// Blocks after the new one stay available, and get used once
+		// this one is full
+		_blocks.insert_at(next, block);
+	}
+
+	_current = next;
+	_used = size;
+	return _blocks[_current].data;
+}
+
+void Arena::poisonFrom(uint block, size_t used) {
+	for (; block <= _current && block < _blocks.size(); block++) {
+		const size_t end = (block == _current) ? _used : _blocks[block].size;
+		if (end > used)
+			memset(_blocks[block].data + used, kPoisonValue, end - used);
+		used = 0;
+	}
+}
+
+void Arena::release(const Mark &mark) {
+	checkOwner();
+	assert(mark.block < _current || (mark.block == _current && mark.used <= _used));
+
+	if (_poison)
+		poisonFrom(mark.block, mark.used);
+
+	_current = mark.block;
+	_used = mark.used;
+}
+
+void Arena::reset(bool freeBlocks) {
+	if (!freeBlocks)
+		checkOwner();
+
+	if (_poison)
+		poisonFrom(0, 0);
+
+	if (freeBlocks) {
+		for (uint i = 0; i < _blocks.size(); i++)
+			free(_blocks[i].data);
+		_blocks.clear();
+		_owner = 0;
+	}
+
+	_current = 0;
+	_used = 0;
+}
+
+size_t Arena::getUsedSize() const {
+	size_t size = _used;
+	for (uint i = 0; i < _current && i < _blocks.size(); i++)
+		size += _blocks[i].size;
+	return size;
+}
+
+} // End of namespace Common
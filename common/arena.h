@@ -0,0 +1,221 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ARENA_H
+#define COMMON_ARENA_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * This class provides memory for objects which all die at the same time,
+ * like the temporary lists built to draw a frame, or the data of a room.
+ *
+ * Allocating from an arena only moves a pointer forward inside a block of
+ * memory obtained from malloc(). Memory is never given back one allocation
+ * at a time: instead, everything allocated after a mark is released at
+ * once, or the whole arena is reset. Blocks are kept for later use when
+ * released, so that an arena used over and over again, e.g. once per
+ * frame, stops calling malloc() after the first few frames.
+ *
+ * The arena does not run destructors: objects needing one must be
+ * destroyed by hand before their memory is released.
+ *
+ * An arena does no locking: it belongs to the first thread allocating
+ * from it, and must only be used by that thread afterwards. Other threads
+ * need arenas of their own. Whenever the arena needs a new block or
+ * releases memory, it asserts that it runs on its owner thread. Resetting
+ * the arena with its blocks freed gives up the ownership, so that another
+ * thread may take the arena over, or destroy it.
+ */
+class Arena : NonCopyable {
+public:
+	/** Position in the arena, to release the memory allocated after it. */
+	struct Mark {
+		uint block;
+		size_t used;
+	};
+
+	enum {
+		/** Alignment of every allocation. */
+		kAlignment = 8,
+
+		/** Value released memory is filled with when poisoning it. */
+		kPoisonValue = 0xDD
+	};
+
+	/**
+	 * Constructor for an arena.
+	 * @param blockSize		size of the blocks obtained from malloc();
+	 *						larger allocations get a block of their own
+	 * @param poison		whether to fill released memory with
+	 *						kPoisonValue, to catch uses of stale objects
+	 */
+	explicit Arena(size_t blockSize = 16 * 1024, bool poison = false);
+	~Arena();
+
+	/**
+	 * Allocate memory from the arena. The memory remains valid until it is
+	 * released or the arena is reset or destroyed.
+	 */
+	void *alloc(size_t size) {
+		size = (size + kAlignment - 1) & ~(size_t)(kAlignment - 1);
+		if (_current < _blocks.size() && _blocks[_current].size - _used >= size) {
+			void *ptr = _blocks[_current].data + _used;
+			_used += size;
+			return ptr;
+		}
+		return allocSlow(size);
+	}
+
+	/** The current position in the arena. */
+	Mark mark() const {
+		Mark mark = { _current, _used };
+		return mark;
+	}
+
+	/**
+	 * Release all the memory allocated since the mark was taken. Marks
+	 * taken after it become invalid.
+	 */
+	void release(const Mark &mark);
+
+	/**
+	 * Release all the memory allocated from the arena.
+	 * @param freeBlocks	whether to also give the blocks back to the
+	 *						system, rather than keeping them for later; the
+	 *						arena then has no owner thread anymore
+	 */
+	void reset(bool freeBlocks = false);
+
+	/** Number of bytes currently allocated from the arena. */
+	size_t getUsedSize() const;
+
+	/** Number of blocks obtained from malloc() over the arena's lifetime. */
+	uint getBlockAllocations() const { return _blockAllocations; }
+
+private:
+	struct Block {
+		byte *data;
+		size_t size;
+	};
+
+	Array<Block> _blocks;
+	uint _current;		///< Block allocations currently come from
+	size_t _used;		///< Bytes in use in the current block
+
+	const size_t _blockSize;
+	const bool _poison;
+	uint _blockAllocations;
+
+	const void *_owner;	///< Tag of the thread using the arena, see checkOwner()
+
+	void *allocSlow(size_t size);
+	void checkOwner();
+	void poisonFrom(uint block, size_t used);
+};
+
+/**
+ * Releases on destruction all the memory allocated from an arena during
+ * its lifetime.
+ */
+class ArenaScope : NonCopyable {
+public:
+	explicit ArenaScope(Arena &arena) : _arena(arena), _mark(arena.mark()) {}
+	~ArenaScope() { _arena.release(_mark); }
+
+private:
+	Arena &_arena;
+	const Arena::Mark _mark;
+};
+
+/**
+ * Creates and destroys objects of type T in an arena, or on the heap with
+ * new and delete when no arena is set, for containers which may be used
+ * either way.
+ *
+ * Destroying an object from an arena runs its destructor, but its memory
+ * only comes back when the arena is released.
+ */
+template<class T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+	typedef uint size_type;
+
+	explicit ArenaAllocator(Arena *arena = 0) : _arena(arena) {}
+
+	Arena *getArena() const { return _arena; }
+
+	/** Allocate uninitialized memory for n objects. */
+	T *allocate(size_type n) const {
+		if (_arena)
+			return (T *)_arena->alloc(n * sizeof(T));
+		return (T *)malloc(n * sizeof(T));
+	}
+
+	void deallocate(T *ptr, size_type n) const {
+		if (!_arena)
+			free(ptr);
+	}
+
+	T *create() const {
+		if (_arena)
+			return new ((void *)allocate(1)) T();
+		return new T();
+	}
+
+	T *create(const T &value) const {
+		if (_arena)
+			return new ((void *)allocate(1)) T(value);
+		return new T(value);
+	}
+
+	void destroy(T *ptr) const {
+		if (_arena) {
+			if (ptr)
+				ptr->~T();
+		} else {
+			delete ptr;
+		}
+	}
+
+private:
+	Arena *_arena;
+};
+
+} // End of namespace Common
+
+/**
+ * A custom placement new operator, allocating from an Arena.
+ */
+inline void *operator new(size_t nbytes, Common::Arena &arena) {
+	return arena.alloc(nbytes);
+}
+
+inline void operator delete(void *p, Common::Arena &arena) {
+}
+
+#endif
@@ -42,6 +42,9 @@ namespace Common {
  * For example, a bit stream with the layout parameters 32, true, false
  * for valueBits, isLE and isMSB2LSB, reads 32bit little-endian values
  * from the data stream and hands out the bits in the order of LSB to MSB.
+ *
+ * The values are read ahead into a 64-bit buffer, several at a time, so
+ * the data stream may be positioned past the bits handed out so far.
  */
 template<class STREAM, int valueBits, bool isLE, bool isMSB2LSB>
 class BitStreamImpl {
@@ -49,46 +52,80 @@ private:
 	STREAM *_stream;			///< The input stream.
 	DisposeAfterUse::Flag _disposeAfterUse; ///< Should we delete the stream on destruction?
 
-	uint32 _value;   ///< Current value.
-	uint8  _inValue; ///< Position within the current value.
+	uint64 _value;   ///< Bits read from the stream, but not handed out yet.
+	uint8  _inValue; ///< Number of bits in _value.
 	uint32 _size;    ///< Total bitstream size (in bits)
 	uint32 _pos;     ///< Current bitstream position (in bits)
 
-	/** Read a data value. */
-	inline uint32 readData() {
+	/** Decode a data value from its bytes. */
+	static inline uint32 readData(const byte *data) {
 		if (isLE) {
 			if (valueBits ==  8)
-				return _stream->readByte();
+				return *data;
 			if (valueBits == 16)
-				return _stream->readUint16LE();
+				return READ_LE_UINT16(data);
 			if (valueBits == 32)
-				return _stream->readUint32LE();
+				return READ_LE_UINT32(data);
 		} else {
 			if (valueBits ==  8)
-				return _stream->readByte();
+				return *data;
 			if (valueBits == 16)
-				return _stream->readUint16BE();
+				return READ_BE_UINT16(data);
 			if (valueBits == 32)
-				return _stream->readUint32BE();
+				return READ_BE_UINT32(data);
 		}
 
 		assert(false);
 		return 0;
 	}
 
-	/** Read the next data value. */
-	inline void readValue() {
-		if (_size - _pos < valueBits)
-			error("BitStreamImpl::readValue(): End of bit stream reached");
+	/** Read as many data values as fit into the buffer, so that it holds at least n bits. */
+	void refill(uint8 n) {
+		uint32 count = (64 - _inValue) / valueBits;
+
+		const uint32 left = (_size - _pos - _inValue) / valueBits;
+		if (count > left) {
+			count = left;
+			if (_inValue + count * valueBits < n)
+				error("BitStreamImpl::refill(): End of bit stream reached");
+		}
 
-		_value = readData();
+		byte data[8];
+		_stream->read(data, count * (valueBits >> 3));
 		if (_stream->err() || _stream->eos())
-			error("BitStreamImpl::readValue(): Read error");
+			error("BitStreamImpl::refill(): Read error");
 
-		// If we're reading the bits MSB first, we need to shift the value to that position
-		if (isMSB2LSB)
-			_value <<= 32 - valueBits;
+		for (uint32 i = 0; i < count; i++) {
+			const uint64 value = readData(data + i * (valueBits >> 3));
+
+			// If we're reading the bits MSB first, the next bits are the highest ones
+			if (isMSB2LSB)
+				_value |= value << (64 - valueBits - _inValue);
+			else
+				_value |= value << _inValue;
+
+			_inValue += valueBits;
 		}
+	}
+
+	/** Return the next n bits, 0 < n <= 32, which must be in the buffer. */
+	inline uint32 peekBuffered(uint8 n) const {
+		if (isMSB2LSB)
+			return (uint32)(_value >> (64 - n));
+		else
+			return (uint32)(_value & (((uint64)1 << n) - 1));
+	}
+
+	/** Drop the next n bits, n < 64, which must be in the buffer. */
+	inline void skipBuffered(uint8 n) {
+		if (isMSB2LSB)
+			_value <<= n;
+		else
+			_value >>= n;
+
+		_inValue -= n;
+		_pos += n;
+	}
 
 public:
 	/** Create a bit stream using this input data stream and optionally delete it on destruction. */
@@ -116,37 +153,16 @@ public:
 			delete _stream;
 	}
 
-private:
-	uint32 getBit_internal() {
-		// Get the current bit
-		uint32 b = 0;
-		if (isMSB2LSB)
-			b = ((_value & 0x80000000) == 0) ? 0 : 1;
-		else
-			b = ((_value & 1) == 0) ? 0 : 1;
-
-		// Shift to the next bit
-		if (isMSB2LSB)
-			_value <<= 1;
-		else
-			_value >>= 1;
+	/** Whether the bits are handed out from MSB to LSB of the data values. */
+	static const bool kMSB2LSB = isMSB2LSB;
 
-		return b;
-	}
-
-public:
 	/** Read a bit from the bit stream. */
 	uint32 getBit() {
-		// Check if we need the next value
 		if (_inValue == 0)
-			readValue();
-
-		uint32 b = getBit_internal();
-
-		// Increase the position within the current value
-		_inValue = (_inValue + 1) % valueBits;
-		_pos++;
+			refill(1);
 
+		const uint32 b = peekBuffered(1);
+		skipBuffered(1);
 		return b;
 	}
 
@@ -167,63 +183,20 @@ public:
 		if (n > 32)
 			error("BitStreamImpl::getBits(): Too many bits requested to be read");
 
-		// Read the number of bits
-		uint32 v = 0;
-
-		uint8 nOrig = n;
-		if (_inValue) {
-			int count = MIN((int)n, valueBits - _inValue);
-			for (int i = 0; i < count; ++i) {
-				if (isMSB2LSB) {
-					v = (v << 1) | getBit_internal();
-				} else {
-					v = (v >> 1) | (getBit_internal() << 31);
-				}
-			}
-
-			n -= count;
-		}
-
-		while (n > 0) {
-			// NB: readValue doesn't care that _inValue is incorrect here
-			readValue();
-
-			int count = MIN((int)n, valueBits);
-			for (int i = 0; i < count; ++i) {
-				if (isMSB2LSB) {
-					v = (v << 1) | getBit_internal();
-				} else {
-					v = (v >> 1) | (getBit_internal() << 31);
-				}
-			}
-
-			n -= count;
-		}
-
-		_inValue = (_inValue + nOrig) % valueBits;
-		_pos += nOrig;
-
-		if (!isMSB2LSB)
-			v >>= (32 - nOrig);
+		if (_inValue < n)
+			refill(n);
 
+		const uint32 v = peekBuffered(n);
+		skipBuffered(n);
 		return v;
 	}
 
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	uint32 peekBit() {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curStreamPos  = _stream->pos();
-		uint32 curPos = _pos;
-
-		uint32 v = getBit();
-
-		_pos     = curPos;
-		_stream->seek(curStreamPos);
-		_inValue = inValue;
-		_value   = value;
+		if (_inValue == 0)
+			refill(1);
 
-		return v;
+		return peekBuffered(1);
 	}
 
 	/**
@@ -232,19 +205,16 @@ public:
 	 * The bit order is the same as in getBits().
 	 */
 	uint32 peekBits(uint8 n) {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curStreamPos  = _stream->pos();
-		uint32 curPos = _pos;
+		if (n == 0)
+			return 0;
 
-		uint32 v = getBits(n);
+		if (n > 32)
+			error("BitStreamImpl::peekBits(): Too many bits requested to be read");
 
-		_pos     = curPos;
-		_stream->seek(curStreamPos);
-		_inValue = inValue;
-		_value   = value;
+		if (_inValue < n)
+			refill(n);
 
-		return v;
+		return peekBuffered(n);
 	}
 
 	/**
@@ -279,14 +249,42 @@ public:
 
 	/** Skip the specified amount of bits. */
 	void skip(uint32 n) {
-		while (n-- > 0)
-			getBit();
+		if (n <= _inValue) {
+			if (n < 64) {
+				skipBuffered(n);
+			} else {
+				_value = 0;
+				_inValue = 0;
+				_pos += n;
+			}
+			return;
+		}
+
+		if (n > _size - _pos)
+			error("BitStreamImpl::skip(): End of bit stream reached");
+
+		// Skip whole data values in the data stream
+		n -= _inValue;
+		_pos += _inValue;
+		_value = 0;
+		_inValue = 0;
+
+		const uint32 values = n / valueBits;
+		if (values) {
+			_stream->seek(_stream->pos() + values * (valueBits >> 3));
+			_pos += values * valueBits;
+			n -= values * valueBits;
+		}
+
+		if (n) {
+			refill(n);
+			skipBuffered(n);
+		}
 	}
 
 	/** Skip the bits to closest data value border. */
 	void align() {
-		while (_inValue)
-			getBit();
+		skip((valueBits - _pos % valueBits) % valueBits);
 	}
 
 	/** Return the stream position in bits. */
@@ -363,6 +361,18 @@ public:
 		return true;
 	}
 
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		memcpy(dataPtr, _ptr, dataSize);
+		_pos += dataSize;
+		_ptr += dataSize;
+		return dataSize;
+	}
+
 	byte readByte() {
 		if (_pos >= _size) {
 			_eos = true;
@@ -403,7 +413,7 @@ public:
 			}
 		}
 
-		uint16 val = READ_LE_UINT16(_ptr);
+		uint16 val = READ_BE_UINT16(_ptr);
 
 		_pos += 2;
 		_ptr += 2;
@@ -0,0 +1,541 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The layout of the hash map in this file follows the "Swiss table" design
+// of Abseil: one metadata byte per slot, probed a group of slots at a time.
+
+#ifndef COMMON_FLAT_HASHMAP_H
+#define COMMON_FLAT_HASHMAP_H
+
+#include "common/scummsys.h"
+#include "common/endian.h"
+#include "common/func.h"
+#include "common/math.h"
+
+namespace Common {
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for HashMap<Key,Val>, with
+ * the same interface, which stores its entries inline in one contiguous
+ * array instead of allocating a node per entry.
+ *
+ * Every slot has a metadata byte, telling whether it is empty, erased, or
+ * holding an entry along with 7 bits of the hash of its key. Lookups test
+ * the metadata of eight slots at once with plain 64-bit integer operations,
+ * and only compare keys whose hash bits match. Iterating walks the metadata
+ * array in order.
+ *
+ * This makes lookups and iteration considerably faster than with HashMap,
+ * in particular for small keys and values. On the other hand, inserting an
+ * entry may move the other ones: unlike with HashMap, references to values
+ * and iterators are invalidated whenever a new key is added.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	struct Node {
+		const Key _key;
+		Val _value;
+		explicit Node(const Key &key) : _key(key), _value() {}
+		Node(const Key &key, const Val &value) : _key(key), _value(value) {}
+	};
+
+	enum {
+		FLATHASHMAP_GROUP_SIZE = 8,
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The storage grows once more than 7/8 of the slots are in use,
+		// counting erased ones.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 7,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 8
+	};
+
+	// Metadata of the slots which do not hold an entry. The metadata of the
+	// other slots is 7 bits of the hash of their key.
+	enum {
+		kCtrlEmpty = 0x80,
+		kCtrlErased = 0xFE
+	};
+
+	byte *_ctrl;	///< Metadata of each slot
+	Node *_slots;	///< Entries, only constructed in the slots in use
+	size_type _mask;	///< Capacity minus one; the capacity is a power of two
+	size_type _size;
+	size_type _erased;	///< Number of slots marked as erased
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+	static bool isFull(byte ctrl) { return !(ctrl & 0x80); }
+
+	/** Spread the hash over all of its bits, to cope with weak hash functions. */
+	static uint32 mixHash(uint hash) {
+		const uint32 mix = (uint32)hash * 0x9E3779B1U;
+		return mix ^ (mix >> 16);
+	}
+	static byte hashBits(uint32 hash) { return hash >> 25; }
+
+	/**
+	 * Bit masks over a group of slots, with the highest bit of every byte
+	 * set for the slots matching.
+	 */
+	static uint64 loadGroup(const byte *ctrl) { return READ_LE_UINT64(ctrl); }
+
+	static uint64 matchHash(uint64 group, byte bits) {
+		// May report extra matches among the slots in use right after an
+		// actual one, which is fine since the keys are compared afterwards.
+		const uint64 x = group ^ (0x0101010101010101ULL * bits);
+		return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+	}
+	static uint64 matchEmpty(uint64 group) {
+		return group & (~group << 6) & 0x8080808080808080ULL;
+	}
+	static uint64 matchFree(uint64 group) {
+		return group & (~group << 7) & 0x8080808080808080ULL;
+	}
+
+	/** Index in its group of the first slot set in a match mask. */
+	static size_type firstMatch(uint64 match) {
+#if GCC_ATLEAST(3, 4)
+		return __builtin_ctzll(match) / 8;
+#else
+		const uint64 lowest = match & (~match + 1);
+		if ((uint32)lowest)
+			return intLog2((uint32)lowest) / 8;
+		return 4 + intLog2((uint32)(lowest >> 32)) / 8;
+#endif
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key) const;
+	size_type findFree(uint32 hash) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void expandStorage(size_type newCapacity);
+	void eraseSlot(size_type ctr);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(isFull(_hashmap->_ctrl[_idx]));
+			return &_hashmap->_slots[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			_idx = _hashmap->nextFull(_idx + 1);
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+	/** Index of the first slot in use at or after ctr, or (size_type)-1. */
+	size_type nextFull(size_type ctr) const {
+		for (; ctr <= _mask; ++ctr) {
+			if (isFull(_ctrl[ctr]))
+				return ctr;
+		}
+		return (size_type)-1;
+	}
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		return iterator(nextFull(0), this);
+	}
+	iterator	end() {
+		return iterator((size_type)-1, this);
+	}
+
+	const_iterator	begin() const {
+		return const_iterator(nextFull(0), this);
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		return iterator(lookup(key), this);
+	}
+
+	const_iterator	find(const Key &key) const {
+		return const_iterator(lookup(key), this);
+	}
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	freeStorage();
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	_mask = capacity - 1;
+	_ctrl = new byte[capacity];
+	assert(_ctrl != NULL);
+	memset(_ctrl, kCtrlEmpty, capacity);
+
+	// The entries are constructed in place when they are added
+	_slots = (Node *)malloc(capacity * sizeof(Node));
+	assert(_slots != NULL);
+
+	_size = 0;
+	_erased = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isFull(_ctrl[ctr]))
+			_slots[ctr].~Node();
+	}
+
+	delete[] _ctrl;
+	free(_slots);
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// The slots are cloned as they are, erased ones included
+	memcpy(_ctrl, map._ctrl, _mask + 1);
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isFull(_ctrl[ctr]))
+			new ((void *)&_slots[ctr]) Node(map._slots[ctr]._key, map._slots[ctr]._value);
+	}
+
+	_size = map._size;
+	_erased = map._erased;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+		return;
+	}
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isFull(_ctrl[ctr]))
+			_slots[ctr].~Node();
+	}
+	memset(_ctrl, kCtrlEmpty, _mask + 1);
+
+	_size = 0;
+	_erased = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
+	assert(newCapacity >= _size * FLATHASHMAP_LOADFACTOR_DENOMINATOR / FLATHASHMAP_LOADFACTOR_NUMERATOR);
+
+#ifndef NDEBUG
+	const size_type old_size = _size;
+#endif
+	const size_type old_mask = _mask;
+	byte *old_ctrl = _ctrl;
+	Node *old_slots = _slots;
+
+	allocStorage(newCapacity);
+
+	// Rehash all the old elements. Since we know that no key exists twice
+	// in the old table, we only need to look for a free slot.
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		if (!isFull(old_ctrl[ctr]))
+			continue;
+
+		const uint32 hash = mixHash(_hash(old_slots[ctr]._key));
+		const size_type idx = findFree(hash);
+		_ctrl[idx] = hashBits(hash);
+		new ((void *)&_slots[idx]) Node(old_slots[ctr]._key, old_slots[ctr]._value);
+		old_slots[ctr].~Node();
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	// This check will fail if some previous operation corrupted this hashmap.
+	assert(_size == old_size);
+
+	delete[] old_ctrl;
+	free(old_slots);
+}
+
+/**
+ * Look up a key, and return the index of its slot or (size_type)-1.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+inline typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	const uint32 hash = mixHash(_hash(key));
+	const byte bits = hashBits(hash);
+
+	// Visit the groups in triangular order, which covers all of them since
+	// their number is a power of two
+	size_type group = hash & _mask & ~(size_type)(FLATHASHMAP_GROUP_SIZE - 1);
+	for (size_type step = FLATHASHMAP_GROUP_SIZE; ; step += FLATHASHMAP_GROUP_SIZE) {
+		const uint64 ctrl = loadGroup(_ctrl + group);
+		for (uint64 match = matchHash(ctrl, bits); match; match &= match - 1) {
+			const size_type ctr = group + firstMatch(match);
+			if (_equal(_slots[ctr]._key, key))
+				return ctr;
+		}
+
+		// A key is never stored past a group with an empty slot
+		if (matchEmpty(ctrl))
+			return (size_type)-1;
+
+		group = (group + step) & _mask;
+	}
+}
+
+/**
+ * Find the slot where a key which is not in the map yet would be inserted.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::findFree(uint32 hash) const {
+	size_type group = hash & _mask & ~(size_type)(FLATHASHMAP_GROUP_SIZE - 1);
+	for (size_type step = FLATHASHMAP_GROUP_SIZE; ; step += FLATHASHMAP_GROUP_SIZE) {
+		const uint64 match = matchFree(loadGroup(_ctrl + group));
+		if (match)
+			return group + firstMatch(match);
+
+		group = (group + step) & _mask;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		return ctr;
+
+	// Keep the load factor below a certain threshold.
+	// Erased slots are also counted
+	const size_type capacity = _mask + 1;
+	if ((_size + _erased + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		// Only rehash at the same size when most of the slots were erased
+		if (_size * 2 >= capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR / FLATHASHMAP_LOADFACTOR_DENOMINATOR)
+			expandStorage(capacity < 500 ? (capacity * 4) : (capacity * 2));
+		else
+			expandStorage(capacity);
+	}
+
+	const uint32 hash = mixHash(_hash(key));
+	ctr = findFree(hash);
+	if (_ctrl[ctr] == kCtrlErased)
+		_erased--;
+	_ctrl[ctr] = hashBits(hash);
+	new ((void *)&_slots[ctr]) Node(key);
+	_size++;
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type ctr) {
+	_slots[ctr].~Node();
+	_size--;
+
+	// Lookups stop at groups with an empty slot. When the group had one
+	// already, no lookup ever went past it and the slot can become empty.
+	const size_type group = ctr & ~(size_type)(FLATHASHMAP_GROUP_SIZE - 1);
+	if (matchEmpty(loadGroup(_ctrl + group))) {
+		_ctrl[ctr] = kCtrlEmpty;
+	} else {
+		_ctrl[ctr] = kCtrlErased;
+		_erased++;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key) != (size_type)-1;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	// The storage may be reallocated before the slot is known
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	return _slots[ctr]._value;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	const size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		return _slots[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	_slots[ctr]._value = val;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	const size_type ctr = entry._idx;
+	assert(ctr <= _mask);
+	assert(isFull(_ctrl[ctr]));
+
+	eraseSlot(ctr);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	const size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		eraseSlot(ctr);
+}
+
+} // End of namespace Common
+
+#endif
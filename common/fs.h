@@ -213,6 +213,18 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieve the size and last modification time of the file referred by
+	 * this node, without opening it. Meant to tell whether a file changed,
+	 * e.g. to validate cached data about it.
+	 *
+	 * @param size				the size of the file, in bytes
+	 * @param modificationTime	the modification time, in an unspecified unit
+	 * @return true on success, false if the node is not a file or the
+	 *         backend cannot tell
+	 */
+	bool getFileStats(uint32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -230,6 +242,14 @@ public:
 	 * @return pointer to the stream object, 0 in case of a failure
 	 */
 	WriteStream *createWriteStream() const;
+
+	/**
+	 * Creates the directory referred by this node. The parent directory
+	 * must exist.
+	 *
+	 * @return true if the directory was created, false otherwise
+	 */
+	bool createDirectory() const;
 };
 
 /**
@@ -30,6 +30,8 @@ namespace Common {
 
 uint hashit(const char *str);
 uint hashit_lower(const char *str);	// Generate a hash based on the lowercase version of the string
+uint hashit(const char *str, uint32 len);	// Same hash as hashit, for strings which are not NUL terminated
+uint hashit_lower(const char *str, uint32 len);
 inline uint hashit(const String &str) { return hashit(str.c_str()); }
 inline uint hashit_lower(const String &str) { return hashit_lower(str.c_str()); }
 
@@ -52,6 +52,23 @@ uint hashit_lower(const char *p) {
 	return hash ^ size;
 }
 
+// Like hashit, but for the first len chars of a string which need not be
+// NUL terminated. Gives the same result as hashit for the whole string.
+uint hashit(const char *p, uint32 len) {
+	uint hash = (len ? *p : 0) << 7;
+	for (uint32 i = 0; i < len; i++)
+		hash = (1000003 * hash) ^ (byte)p[i];
+	return hash ^ len;
+}
+
+// Like hashit_lower, for the first len chars of a string.
+uint hashit_lower(const char *p, uint32 len) {
+	uint hash = (len ? tolower(*p) : 0) << 7;
+	for (uint32 i = 0; i < len; i++)
+		hash = (1000003 * hash) ^ tolower((byte)p[i]);
+	return hash ^ len;
+}
+
 #ifdef DEBUG_HASH_COLLISIONS
 static double
 	g_collisions = 0,
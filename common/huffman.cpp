@@ -23,15 +23,26 @@
 // Based on eos' Huffman code
 
 #include "common/huffman.h"
+#include "common/algorithm.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/bitstream.h"
 
 namespace Common {
 
-Huffman::Symbol::Symbol(uint32 c, uint32 s) : code(c), symbol(s) {
-}
+namespace {
+
+struct SymbolLengthLess {
+	const uint8 *lengths;
+
+	SymbolLengthLess(const uint8 *l) : lengths(l) {}
 
+	bool operator()(uint32 x, uint32 y) const {
+		return lengths[x] < lengths[y] || (lengths[x] == lengths[y] && x < y);
+	}
+};
+
+} // End of anonymous namespace
 
 Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols) {
 	assert(codeCount > 0);
@@ -45,19 +56,19 @@ Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const u
 
 	assert(maxLength <= 32);
 
-	_codes.resize(maxLength);
+	_tableBits = MIN<uint8>(maxLength, kTableBits);
 	_symbols.resize(codeCount);
 
 	for (uint32 i = 0; i < codeCount; i++) {
-		// The symbol. If none were specified, just assume it's identical to the code index
-		uint32 symbol = symbols ? symbols[i] : i;
+		assert(lengths[i] > 0 && lengths[i] <= maxLength);
 
-		// Put the code and symbol into the correct list
-		_codes[lengths[i] - 1].push_back(Symbol(codes[i], symbol));
-
-		// And put the pointer to the symbol/code struct into the symbol list.
-		_symbols[i] = &_codes[lengths[i] - 1].back();
+		_symbols[i].code = codes[i];
+		_symbols[i].length = lengths[i];
+		// The symbol. If none were specified, just assume it's identical to the code index
+		_symbols[i].symbol = symbols ? symbols[i] : i;
 	}
+
+	buildTables();
 }
 
 Huffman::~Huffman() {
@@ -65,7 +76,95 @@ Huffman::~Huffman() {
 
 void Huffman::setSymbols(const uint32 *symbols) {
 	for (uint32 i = 0; i < _symbols.size(); i++)
-		_symbols[i]->symbol = symbols ? *symbols++ : i;
+		_symbols[i].symbol = symbols ? *symbols++ : i;
+
+	buildTables();
+}
+
+void Huffman::buildTables() {
+	// Shorter codes take precedence, like when matching the codes bit
+	// by bit, then the codes which were given first
+	Array<uint32> order;
+	Array<uint8> lengths;
+	for (uint32 i = 0; i < _symbols.size(); i++) {
+		order.push_back(i);
+		lengths.push_back(_symbols[i].length);
+	}
+	sort(order.begin(), order.end(), SymbolLengthLess(lengths.begin()));
+
+	SymbolList codes;
+	for (uint32 i = 0; i < order.size(); i++)
+		codes.push_back(_symbols[order[i]]);
+
+	_msbTable.clear();
+	_msbTable.resize(1 << _tableBits);
+	buildTable(_msbTable, 0, _tableBits, codes, true);
+
+	_lsbTable.clear();
+	_lsbTable.resize(1 << _tableBits);
+	buildTable(_lsbTable, 0, _tableBits, codes, false);
+}
+
+void Huffman::buildTable(Table &table, uint32 offset, uint8 tableBits, const SymbolList &codes, bool msb2lsb) {
+	const uint32 size = 1 << tableBits;
+	Array<uint8> subtableBits;
+
+	for (uint32 i = 0; i < codes.size(); i++) {
+		const Symbol &code = codes[i];
+
+		if (code.length <= tableBits) {
+			// A short code fills all the entries starting with its bits
+			const uint8 freeBits = tableBits - code.length;
+			for (uint32 j = 0; j < (1u << freeBits); j++) {
+				const uint32 index = msb2lsb ? (code.code << freeBits) | j : code.code | (j << code.length);
+				TableEntry &entry = table[offset + index];
+				if (!entry.length) {
+					entry.symbol = code.symbol;
+					entry.length = code.length;
+				}
+			}
+		} else {
+			// A long code needs a subtable, large enough for the longest
+			// of the codes starting with the same bits
+			const uint32 index = msb2lsb ? code.code >> (code.length - tableBits) : code.code & (size - 1);
+			if (subtableBits.empty())
+				subtableBits.resize(size);
+			subtableBits[index] = MAX<uint8>(subtableBits[index], MIN<uint8>(code.length - tableBits, kTableBits));
+		}
+	}
+
+	for (uint32 index = 0; index < subtableBits.size(); index++) {
+		if (!subtableBits[index] || table[offset + index].length)
+			continue;
+
+		SymbolList subcodes;
+		for (uint32 i = 0; i < codes.size(); i++) {
+			const Symbol &code = codes[i];
+			if (code.length <= tableBits)
+				continue;
+
+			const uint8 restLength = code.length - tableBits;
+			Symbol rest;
+			rest.length = restLength;
+			rest.symbol = code.symbol;
+			if (msb2lsb) {
+				if ((code.code >> restLength) != index)
+					continue;
+				rest.code = code.code & ((1u << restLength) - 1);
+			} else {
+				if ((code.code & (size - 1)) != index)
+					continue;
+				rest.code = code.code >> tableBits;
+			}
+			subcodes.push_back(rest);
+		}
+
+		const uint32 subtableOffset = table.size();
+		table.resize(subtableOffset + (1 << subtableBits[index]));
+		table[offset + index].symbol = subtableOffset;
+		table[offset + index].subtableBits = subtableBits[index];
+		buildTable(table, subtableOffset, subtableBits[index], subcodes, msb2lsb);
+	}
 }
 
 } // End of namespace Common
@@ -26,7 +26,7 @@
 #define COMMON_HUFFMAN_H
 
 #include "common/array.h"
-#include "common/list.h"
+#include "common/textconsole.h"
 #include "common/types.h"
 
 namespace Common {
@@ -34,6 +34,10 @@ namespace Common {
 /**
  * Huffman bitstream decoding
  *
+ * The codes are decoded with lookup tables: a peek into the bitstream
+ * resolves codes up to kTableBits long in a single step, and longer codes
+ * continue in smaller subtables.
+ *
  * Used in engines:
  *  - scumm
  */
@@ -56,37 +60,76 @@ public:
 	/** Return the next symbol in the bitstream. */
 	template<class BITSTREAM>
 	uint32 getSymbol(BITSTREAM &bits) const {
-		uint32 code = 0;
-
-		for (uint32 i = 0; i < _codes.size(); i++) {
-			bits.addBit(code, i);
-
-			for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-				if (code == cCode->code)
-					return cCode->symbol;
+		const Table &table = BITSTREAM::kMSB2LSB ? _msbTable : _lsbTable;
+		uint32 offset = 0;
+		uint8 tableBits = _tableBits;
+
+		for (;;) {
+			uint32 index;
+			const uint32 available = bits.size() - bits.pos();
+			if (available >= tableBits) {
+				index = bits.peekBits(tableBits);
+			} else {
+				// Near the end of the stream, look up what is left
+				index = bits.peekBits(available);
+				if (BITSTREAM::kMSB2LSB)
+					index <<= tableBits - available;
+			}
+
+			const TableEntry &entry = table[offset + index];
+			if (entry.length) {
+				if (entry.length > available)
+					error("Huffman::getSymbol(): End of bit stream reached");
+
+				bits.skip(entry.length);
+				return entry.symbol;
+			}
+
+			if (!entry.subtableBits)
+				error("Unknown Huffman code");
+
+			bits.skip(tableBits);
+			offset = entry.symbol;
+			tableBits = entry.subtableBits;
 		}
-
-		error("Unknown Huffman code");
-		return 0;
 	}
 
+	/** Maximal number of bits looked up at once. */
+	static const uint8 kTableBits = 9;
+
 private:
 	struct Symbol {
 		uint32 code;
+		uint8 length;
 		uint32 symbol;
-
-		Symbol(uint32 c, uint32 s);
 	};
 
-	typedef List<Symbol> CodeList;
-	typedef Array<CodeList> CodeLists;
-	typedef Array<Symbol *> SymbolList;
+	typedef Array<Symbol> SymbolList;
 
-	/** Lists of codes and their symbols, sorted by code length. */
-	CodeLists _codes;
+	/**
+	 * An entry of a lookup table, which is either a code, a link to a
+	 * subtable decoding the rest of longer codes, or unused.
+	 */
+	struct TableEntry {
+		uint32 symbol;			///< the symbol, or the offset of the subtable
+		uint8 length;			///< the code length within this table; 0 if not a code
+		uint8 subtableBits;		///< the number of bits indexing the subtable
+	};
+
+	typedef Array<TableEntry> Table;
 
-	/** Sorted list of pointers to the symbols. */
+	/** The codes and their symbols, in the order they were given. */
 	SymbolList _symbols;
+
+	/** The number of bits indexing the first table. */
+	uint8 _tableBits;
+
+	/** Lookup tables for bitstreams reading from MSB to LSB, and the other way round. */
+	Table _msbTable;
+	Table _lsbTable;
+
+	void buildTables();
+	static void buildTable(Table &table, uint32 offset, uint8 tableBits, const SymbolList &codes, bool msb2lsb);
 };
 
 } // End of namespace Common
@@ -0,0 +1,51 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/interned-str.h"
+
+namespace Common {
+
+InternedString::Table *InternedString::_table = 0;
+
+const InternedString::Entry *InternedString::intern(const StringView &str) {
+	if (!_table)
+		_table = new Table();
+
+	Table::const_iterator i = _table->find(str);
+	if (i != _table->end())
+		return i->_value;
+
+	Entry *entry = new Entry;
+	entry->str = str.toString();
+	entry->hash = hashit(str);
+
+	// The entry never moves, and neither does the inline storage of its
+	// string, so the key can refer to it
+	(*_table)[StringView(entry->str)] = entry;
+	return entry;
+}
+
+uint InternedString::count() {
+	return _table ? _table->size() : 0;
+}
+
+} // End of namespace Common
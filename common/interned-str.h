@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_INTERNED_STRING_H
+#define COMMON_INTERNED_STRING_H
+
+#include "common/hashmap.h"
+#include "common/str.h"
+#include "common/str-view.h"
+
+namespace Common {
+
+/**
+ * An immutable string, of which only one copy exists in memory for any
+ * given contents. Comparing two interned strings and hashing one are
+ * constant time operations, and copying one never allocates memory, which
+ * makes them fit for names used over and over again as keys, like resource
+ * file names or script symbols.
+ *
+ * Interning a string looks it up in a global table, and only allocates
+ * memory the first time given contents are seen. This also works from a
+ * StringView, so that names can be interned straight from a resource
+ * buffer. Strings are never removed from the table, which hence is not
+ * meant for strings taking arbitrarily many different values.
+ *
+ * An interned string converts to a const String reference, so it can be
+ * passed without any copy to the functions taking file names, like
+ * File::open() or Archive::hasFile().
+ *
+ * @note The table is not thread safe: only intern strings from the main
+ *       thread.
+ */
+class InternedString {
+public:
+	/** The empty string. */
+	InternedString() : _entry(intern(StringView())) {}
+	InternedString(const char *str) : _entry(intern(StringView(str))) {}
+	explicit InternedString(const String &str) : _entry(intern(StringView(str))) {}
+	explicit InternedString(const StringView &str) : _entry(intern(str)) {}
+
+	const String &str() const { return _entry->str; }
+	operator const String &() const { return _entry->str; }
+	const char *c_str() const { return _entry->str.c_str(); }
+	uint32 size() const { return _entry->str.size(); }
+	bool empty() const { return _entry->str.empty(); }
+
+	/** The hash of the string, as computed by hashit(). */
+	uint hash() const { return _entry->hash; }
+
+	bool operator==(const InternedString &x) const { return _entry == x._entry; }
+	bool operator!=(const InternedString &x) const { return _entry != x._entry; }
+
+	/** Number of different strings interned so far. */
+	static uint count();
+
+private:
+	struct Entry {
+		String str;
+		uint hash;
+	};
+
+	// The keys are views of the strings of the entries
+	typedef HashMap<StringView, Entry *> Table;
+
+	const Entry *_entry;
+
+	static Table *_table;
+
+	static const Entry *intern(const StringView &str);
+};
+
+template<>
+struct Hash<InternedString> {
+	uint operator()(const InternedString &s) const {
+		return s.hash();
+	}
+};
+
+} // End of namespace Common
+
+#endif
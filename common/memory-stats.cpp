@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/memory-stats.h"
+#include "common/algorithm.h"
+#include "common/file.h"
+
+namespace Common {
+
+MemoryCounter *MemoryStats::_first = 0;
+
+MemoryCounter::MemoryCounter(const char *name)
+	: _name(name), _liveSize(0), _peakSize(0), _allocations(0), _frees(0), _prev(0) {
+	_next = MemoryStats::_first;
+	if (_next)
+		_next->_prev = this;
+	MemoryStats::_first = this;
+}
+
+MemoryCounter::~MemoryCounter() {
+	if (_prev)
+		_prev->_next = _next;
+	else
+		MemoryStats::_first = _next;
+	if (_next)
+		_next->_prev = _prev;
+}
+
+namespace {
+
+struct InfoNameLess {
+	bool operator()(const MemoryStats::Info &x, const MemoryStats::Info &y) const {
+		return x.name < y.name;
+	}
+};
+
+} // End of anonymous namespace
+
+MemoryStats::InfoList MemoryStats::list() {
+	InfoList infos;
+	for (const MemoryCounter *counter = _first; counter; counter = counter->_next) {
+		InfoList::iterator info = infos.begin();
+		while (info != infos.end() && info->name != counter->_name)
+			++info;
+
+		if (info == infos.end()) {
+			Info newInfo;
+			newInfo.name = counter->_name;
+			newInfo.liveSize = newInfo.peakSize = 0;
+			newInfo.allocations = newInfo.frees = newInfo.counters = 0;
+			infos.push_back(newInfo);
+			info = infos.end() - 1;
+		}
+
+		info->liveSize += counter->_liveSize;
+		info->peakSize += counter->_peakSize;
+		info->allocations += counter->_allocations;
+		info->frees += counter->_frees;
+		info->counters++;
+	}
+
+	sort(infos.begin(), infos.end(), InfoNameLess());
+	return infos;
+}
+
+void MemoryStats::dump(WriteStream &stream) {
+	const InfoList infos = list();
+
+	stream.writeString("# name\tlive\tpeak\tallocations\tfrees\n");
+	for (InfoList::const_iterator i = infos.begin(); i != infos.end(); ++i) {
+		stream.writeString(String::format("%s\t%lu\t%lu\t%u\t%u\n", i->name.c_str(),
+			(unsigned long)i->liveSize, (unsigned long)i->peakSize, i->allocations, i->frees));
+	}
+}
+
+bool MemoryStats::dumpToFile(const String &filename) {
+	DumpFile file;
+	if (!file.open(filename, true))
+		return false;
+
+	dump(file);
+	return file.flush() && !file.err();
+}
+
+} // End of namespace Common
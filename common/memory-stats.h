@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_MEMORY_STATS_H
+#define COMMON_MEMORY_STATS_H
+
+#include "common/array.h"
+#include "common/noncopyable.h"
+#include "common/str.h"
+
+namespace Common {
+
+class WriteStream;
+
+/**
+ * Tracks the memory held by a subsystem, such as a resource cache. The
+ * subsystem reports the size of each allocation and release, and the
+ * counter keeps the live and peak sizes.
+ *
+ * A counter is listed in MemoryStats from its construction to its
+ * destruction. Counters are not locked: a counter must only be updated by
+ * one thread at a time, and created and destroyed on the main thread.
+ */
+class MemoryCounter : NonCopyable {
+public:
+	/** Name of the counter, which must outlive it, e.g. "sci.lru". */
+	explicit MemoryCounter(const char *name);
+	~MemoryCounter();
+
+	void allocated(size_t size) {
+		_liveSize += size;
+		if (_liveSize > _peakSize)
+			_peakSize = _liveSize;
+		_allocations++;
+	}
+
+	void freed(size_t size) {
+		assert(size <= _liveSize);
+		_liveSize -= size;
+		_frees++;
+	}
+
+	const char *getName() const { return _name; }
+	size_t getLiveSize() const { return _liveSize; }
+	size_t getPeakSize() const { return _peakSize; }
+	uint32 getAllocations() const { return _allocations; }
+	uint32 getFrees() const { return _frees; }
+
+private:
+	friend class MemoryStats;
+
+	const char *_name;
+	size_t _liveSize;
+	size_t _peakSize;
+	uint32 _allocations;
+	uint32 _frees;
+
+	MemoryCounter *_prev;
+	MemoryCounter *_next;
+};
+
+/**
+ * The registry of the memory counters, for debugging and for monitoring
+ * the memory used by a game.
+ */
+class MemoryStats {
+public:
+	/**
+	 * Statistics of the counters with the same name.
+	 */
+	struct Info {
+		String name;
+		size_t liveSize;		///< bytes currently held
+		size_t peakSize;		///< sum of the peaks of the counters, in bytes
+		uint32 allocations;
+		uint32 frees;
+		uint32 counters;		///< how many counters have this name
+	};
+
+	typedef Array<Info> InfoList;
+
+	/** List the statistics of the counters, sorted by name. */
+	static InfoList list();
+
+	/**
+	 * Write the statistics in a machine readable format: a line per name,
+	 * with the name, live size, peak size, allocation and release counts
+	 * separated by tabs. Lines starting with '#' are comments.
+	 */
+	static void dump(WriteStream &stream);
+
+	/** Write the statistics to a file, replacing its previous contents. */
+	static bool dumpToFile(const String &filename);
+
+private:
+	friend class MemoryCounter;
+
+	static MemoryCounter *_first;
+};
+
+} // End of namespace Common
+
+#endif
@@ -2,6 +2,7 @@ MODULE := common
 
 MODULE_OBJS := \
 	archive.o \
+	arena.o \
 	config-manager.o \
 	coroutines.o \
 	dcl.o \
@@ -16,10 +17,12 @@ MODULE_OBJS := \
 	iff_container.o \
 	ini-file.o \
 	installshield_cab.o \
+	interned-str.o \
 	json.o \
 	language.o \
 	localization.o \
 	macresman.o \
+	memory-stats.o \
 	memorypool.o \
 	md5.o \
 	mutex.o \
@@ -48,11 +48,19 @@ typedef SeekableReadStream InSaveFile;
 class OutSaveFile: public WriteStream {
 protected:
 	ScopedPtr<WriteStream> _wrapped;
+	bool _screenThumbnail;
 
 public:
-	OutSaveFile(WriteStream *w);
+	OutSaveFile(WriteStream *w, bool screenThumbnail = true);
 	virtual ~OutSaveFile();
 
+	/**
+	 * Whether Graphics::saveThumbnail() grabs the screen for this savefile.
+	 * Backends needing cheap saves (e.g. frontend savestates) open the
+	 * savefile without, a 1x1 placeholder keeping the layout intact instead.
+	 */
+	bool hasScreenThumbnail() const { return _screenThumbnail; }
+
 	virtual bool err() const;
 	virtual void clearErr();
 	virtual void finalize();
@@ -142,6 +150,21 @@ public:
 	 */
 	virtual OutSaveFile *openForSaving(const String &name, bool compress = true) = 0;
 
+	/**
+	 * Open the savefile with the specified name for an autosave. This works
+	 * like openForSaving(), except that the backend may still be writing
+	 * the file once it is finalized. Errors are then reported as warnings
+	 * instead of through err(), since nobody is waiting on an autosave.
+	 *
+	 * @param name      The name of the savefile.
+	 * @param compress  Toggles whether to compress the resulting save file
+	 *                  (default) or not.
+	 * @return Pointer to an OutSaveFile, or NULL if an error occurred.
+	 */
+	virtual OutSaveFile *openForAutosaving(const String &name, bool compress = true) {
+		return openForSaving(name, compress);
+	}
+
 	/**
 	 * Open the file with the specified name in the given directory for loading.
 	 *
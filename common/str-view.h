@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_STRING_VIEW_H
+#define COMMON_STRING_VIEW_H
+
+#include "common/hash-str.h"
+#include "common/str.h"
+#include "common/util.h"
+
+namespace Common {
+
+/**
+ * A read-only reference to a range of characters, which need not be NUL
+ * terminated, such as a name inside a resource buffer or a part of a
+ * String. Creating, copying and comparing views never allocates memory.
+ *
+ * A view does not own its characters: they must outlive it.
+ */
+class StringView {
+public:
+	StringView() : _str(""), _size(0) {}
+	StringView(const char *str) : _str(str), _size(strlen(str)) {}
+	StringView(const char *str, uint32 len) : _str(str), _size(len) {}
+	StringView(const String &str) : _str(str.c_str()), _size(str.size()) {}
+
+	/** The characters of the view. Not NUL terminated in general. */
+	const char *data() const { return _str; }
+	uint32 size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	char operator[](uint32 idx) const {
+		assert(idx < _size);
+		return _str[idx];
+	}
+
+	bool equals(const StringView &x) const {
+		return _size == x._size && !memcmp(_str, x._str, _size);
+	}
+	bool equalsIgnoreCase(const StringView &x) const {
+		for (uint32 i = 0; i < _size; i++) {
+			if (i >= x._size || tolower((byte)_str[i]) != tolower((byte)x._str[i]))
+				return false;
+		}
+		return _size == x._size;
+	}
+
+	bool operator==(const StringView &x) const { return equals(x); }
+	bool operator!=(const StringView &x) const { return !equals(x); }
+
+	/** A part of the view, clipped to its end. */
+	StringView substr(uint32 pos, uint32 len = (uint32)-1) const {
+		if (pos > _size)
+			pos = _size;
+		return StringView(_str + pos, MIN(len, _size - pos));
+	}
+
+	/** Copy the characters into a String. */
+	String toString() const { return String(_str, _size); }
+
+private:
+	const char *_str;
+	uint32 _size;
+};
+
+inline uint hashit(const StringView &str) { return hashit(str.data(), str.size()); }
+inline uint hashit_lower(const StringView &str) { return hashit_lower(str.data(), str.size()); }
+
+// Hashes are the same as those of the String with the same characters.
+template<>
+struct Hash<StringView> {
+	uint operator()(const StringView &s) const {
+		return hashit(s);
+	}
+};
+
+struct IgnoreCaseView_EqualTo {
+	bool operator()(const StringView &x, const StringView &y) const { return x.equalsIgnoreCase(y); }
+};
+
+struct IgnoreCaseView_Hash {
+	uint operator()(const StringView &x) const { return hashit_lower(x); }
+};
+
+} // End of namespace Common
+
+#endif
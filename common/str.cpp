@@ -28,7 +28,35 @@
 
 namespace Common {
 
-MemoryPool *g_refCountPool = 0; // FIXME: This is never freed right now
+// Each thread allocates the reference counts of the strings it shares from
+// a pool of its own, so that worker threads (see OSystem::createThread())
+// need no locking. Storage is never shared between threads, but a string
+// handed over to another thread returns its count to the pool of that one.
+// FIXME: The pools are never freed right now
+#if defined(__GNUC__)
+static __thread MemoryPool *g_refCountPool = 0;
+#elif defined(_MSC_VER)
+static __declspec(thread) MemoryPool *g_refCountPool = 0;
+#else
+static MemoryPool *g_refCountPool = 0;
+#endif
+
+static MemoryPool *getRefCountPool() {
+	if (g_refCountPool == 0) {
+		g_refCountPool = new MemoryPool(sizeof(int));
+		assert(g_refCountPool);
+	}
+	return g_refCountPool;
+}
+
+// Shared with U32String
+int *allocRefCount() {
+	return (int *)getRefCountPool()->allocChunk();
+}
+
+void freeRefCount(int *refCount) {
+	getRefCountPool()->freeChunk(refCount);
+}
 
 static uint32 computeCapacity(uint32 len) {
 	// By default, for the capacity we use the next multiple of 32
@@ -173,12 +201,7 @@ void String::ensureCapacity(uint32 new_size, bool keep_old) {
 void String::incRefCount() const {
 	assert(!isStorageIntern());
 	if (_extern._refCount == 0) {
-		if (g_refCountPool == 0) {
-			g_refCountPool = new MemoryPool(sizeof(int));
-			assert(g_refCountPool);
-		}
-
-		_extern._refCount = (int *)g_refCountPool->allocChunk();
+		_extern._refCount = allocRefCount();
 		*_extern._refCount = 2;
 	} else {
 		++(*_extern._refCount);
@@ -195,10 +218,8 @@ void String::decRefCount(int *oldRefCount) {
 	if (!oldRefCount || *oldRefCount <= 0) {
 		// The ref count reached zero, so we free the string storage
 		// and the ref count storage.
-		if (oldRefCount) {
-			assert(g_refCountPool);
-			g_refCountPool->freeChunk(oldRefCount);
-		}
+		if (oldRefCount)
+			freeRefCount(oldRefCount);
 		delete[] _str;
 
 		// Even though _str points to a freed memory block now,
@@ -511,6 +511,21 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Get direct access to the whole content of the stream, if it is held
+	 * in (or mapped into) memory, so that it can be parsed in place instead
+	 * of being copied by read(). The data is size() bytes long, does not
+	 * depend on the current position, and stays valid as long as the stream
+	 * exists.
+	 *
+	 * The default implementation returns 0. Only streams whose read() returns
+	 * the data as is may override it, e.g. MemoryReadStream; wrappers of
+	 * other streams do not forward it.
+	 *
+	 * @return pointer to the data, or 0 if it is not available
+	 */
+	virtual const byte *getData() const { return 0; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -77,6 +77,14 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+protected:
+	/**
+	 * The data of the parent stream within the range, or 0. Subclasses
+	 * whose reads return the parent data as is may use this to implement
+	 * getData(); it is not exposed by default.
+	 */
+	const byte *getParentData() const;
 };
 
 /**
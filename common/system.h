@@ -1113,6 +1113,74 @@ public:
 
 
 
+	/**
+	 * @name Worker threads
+	 * Optional support for background threads, for work which does not touch
+	 * the rest of the OSystem API, like scanning directories or hashing files.
+	 * Code running on such a thread may only use the mutex functions above,
+	 * the semaphore functions below, the filesystem nodes (Common::FSNode) of
+	 * the backend, and logMessage(), through warning() and debug(), which
+	 * backends supporting threads must make thread safe. String reference
+	 * counts are not atomic, so strings and the objects holding them must
+	 * not share their storage with another thread: hand over copies made
+	 * from the characters, e.g. Common::String(str.c_str()), instead.
+	 *
+	 * Backends which do not support threads simply keep the default
+	 * implementations, and callers are expected to fall back to doing the
+	 * work on the calling thread.
+	 */
+	//@{
+
+	typedef struct OpaqueThread *ThreadRef;
+	typedef void (*ThreadProc)(void *data);
+
+	/**
+	 * Start a new thread running proc(data).
+	 * @return the newly created thread, or 0 if threads are not supported
+	 *         or an error occurred.
+	 */
+	virtual ThreadRef createThread(ThreadProc proc, void *data) { return 0; }
+
+	/**
+	 * Wait for the given thread to finish and release it.
+	 * @param thread	the thread to wait for.
+	 */
+	virtual void joinThread(ThreadRef thread) {}
+
+	typedef struct OpaqueSemaphore *SemaphoreRef;
+
+	/**
+	 * Create a new counting semaphore, for worker threads to wait for work.
+	 * @param value	the initial count
+	 * @return the newly created semaphore, or 0 if threads are not supported
+	 *         or an error occurred.
+	 */
+	virtual SemaphoreRef createSemaphore(uint value) { return 0; }
+
+	/**
+	 * Wait until the count of the given semaphore is positive, and
+	 * decrement it.
+	 * @param semaphore	the semaphore to wait on
+	 */
+	virtual void waitSemaphore(SemaphoreRef semaphore) {}
+
+	/**
+	 * Increment the count of the given semaphore, waking up a thread
+	 * waiting on it.
+	 * @param semaphore	the semaphore to post
+	 */
+	virtual void postSemaphore(SemaphoreRef semaphore) {}
+
+	/**
+	 * Delete the given semaphore. No thread may be waiting on it.
+	 * @param semaphore	the semaphore to delete
+	 */
+	virtual void deleteSemaphore(SemaphoreRef semaphore) {}
+
+	//@}
+
+
+
 	/** @name Sound */
 	//@{
 
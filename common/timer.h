@@ -24,6 +24,7 @@
 #define COMMON_TIMER_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/str.h"
 #include "common/noncopyable.h"
 
@@ -55,6 +56,25 @@ public:
 	 * and no instance of this callback will be running anymore.
 	 */
 	virtual void removeTimerProc(TimerProc proc) = 0;
+
+	/**
+	 * Statistics of an installed timer.
+	 */
+	struct TimerInfo {
+		String id;
+		int32 interval;			///< the interval of the timer, in microseconds
+		uint32 fireCount;		///< how many times the callback was invoked
+		uint32 overrunCount;	///< how many invocations were a full interval late
+		uint32 maxLateness;		///< the longest delay of an invocation, in milliseconds
+	};
+
+	typedef Array<TimerInfo> TimerInfoList;
+
+	/**
+	 * List the installed timers with their statistics, for debugging
+	 * purposes. Timer managers which do not track them return an empty list.
+	 */
+	virtual TimerInfoList listTimers() { return TimerInfoList(); }
 };
 
 } // End of namespace Common
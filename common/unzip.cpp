@@ -103,9 +103,13 @@ typedef struct {
 
 #endif  // !USE_ZLIB
 
+#include "common/array.h"
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/substream.h"
+#include "common/ptr.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -1419,45 +1423,419 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+enum {
+	/** Distance between two inflate checkpoints in the uncompressed data. */
+	kZipCheckpointSpan = 256 * 1024,
 
-class ZipArchive : public Archive {
-	unzFile _zipFile;
+	/**
+	 * Members up to this size are read into memory whole, rather than being
+	 * read from the archive on demand. Random access to those is cheaper,
+	 * and most members are small anyway.
+	 */
+	kZipMaxBufferedSize = 1024 * 1024,
+
+	/** Maximum number of idle inflate states kept by an archive. */
+	kZipMaxIdleInflaters = 4
+};
 
+#ifdef USE_ZLIB
+
+/** Size of the deflate history window. */
+#define ZIP_WINDOW_SIZE (1 << MAX_WBITS)
+
+/**
+ * The inflate state of a member, reused by the next members once it is
+ * closed.
+ */
+struct ZipInflater {
+	z_stream stream;
+	byte window[ZIP_WINDOW_SIZE];	// The last uncompressed data, circular
+	byte input[UNZ_BUFSIZE];
+};
+
+#endif
+
+/**
+ * The data of a ZIP file, shared by the archive and the streams of its
+ * members, which may outlive the archive.
+ */
+class ZipStorage {
 public:
-	ZipArchive(unzFile zipFile);
+	ZipStorage(SeekableReadStream *stream) : _stream(stream) {}
+	~ZipStorage();
 
+	SeekableReadStream *getStream() const { return _stream; }
 
-	~ZipArchive();
+#ifdef USE_ZLIB
+	ZipInflater *acquireInflater();
+	void releaseInflater(ZipInflater *inflater);
+#endif
 
-	virtual bool hasFile(const String &name) const;
-	virtual int listMembers(ArchiveMemberList &list) const;
-	virtual const ArchiveMemberPtr getMember(const String &name) const;
-	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+private:
+	SeekableReadStream *_stream;
+
+#ifdef USE_ZLIB
+	Array<ZipInflater *> _inflaters;
+#endif
 };
 
-/*
-class ZipArchiveMember : public ArchiveMember {
-	unzFile _zipFile;
+typedef SharedPtr<ZipStorage> ZipStoragePtr;
+
+ZipStorage::~ZipStorage() {
+#ifdef USE_ZLIB
+	for (uint i = 0; i < _inflaters.size(); i++) {
+		inflateEnd(&_inflaters[i]->stream);
+		delete _inflaters[i];
+	}
+#endif
+	delete _stream;
+}
+
+#ifdef USE_ZLIB
+
+ZipInflater *ZipStorage::acquireInflater() {
+	if (!_inflaters.empty()) {
+		ZipInflater *inflater = _inflaters.back();
+		_inflaters.pop_back();
+		return inflater;
+	}
+
+	ZipInflater *inflater = new ZipInflater;
+	inflater->stream.zalloc = Z_NULL;
+	inflater->stream.zfree = Z_NULL;
+	inflater->stream.opaque = Z_NULL;
+	inflater->stream.next_in = Z_NULL;
+	inflater->stream.avail_in = 0;
 
+	// Members are raw deflate data, without zlib header
+	if (inflateInit2(&inflater->stream, -MAX_WBITS) != Z_OK) {
+		delete inflater;
+		return 0;
+	}
+
+	return inflater;
+}
+
+void ZipStorage::releaseInflater(ZipInflater *inflater) {
+	if (_inflaters.size() < kZipMaxIdleInflaters) {
+		_inflaters.push_back(inflater);
+	} else {
+		inflateEnd(&inflater->stream);
+		delete inflater;
+	}
+}
+
+#endif
+
+/**
+ * Stream of a stored member, read from the archive on demand.
+ *
+ * When the archive itself is in memory, getData() gives direct access to
+ * the member.
+ */
+class ZipStoredStream : public SafeSeekableSubReadStream {
 public:
-	ZipArchiveMember(FSNode &node) : _node(node) {
+	ZipStoredStream(const ZipStoragePtr &storage, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(storage->getStream(), begin, end), _storage(storage) {
 	}
 
-	String getName() const {
-		...
+	virtual const byte *getData() const { return getParentData(); }
+
+private:
+	ZipStoragePtr _storage;
+};
+
+#ifdef USE_ZLIB
+
+/**
+ * Stream of a deflated member, decompressed on demand.
+ *
+ * Seeking backwards needs to decompress the member again. So that it does
+ * not have to start over from the beginning, the inflate state is saved
+ * every kZipCheckpointSpan bytes, the first time the data is decompressed.
+ * Since deflate blocks only refer to the last ZIP_WINDOW_SIZE bytes, a
+ * checkpoint consists of those bytes along with the position in the
+ * compressed data. Checkpoints are also used to skip data when seeking
+ * forwards.
+ */
+class ZipInflateStream : public SeekableReadStream {
+public:
+	ZipInflateStream(const ZipStoragePtr &storage, ZipInflater *inflater, uint32 dataPos,
+	                 uint32 compressedSize, uint32 size, uint32 crc);
+	~ZipInflateStream();
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _eos = false; _err = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	struct Checkpoint {
+		uint32 in;			// Compressed bytes consumed
+		int bits;			// Bits of the previous compressed byte left
+		uint32 out;			// Uncompressed bytes produced
+		uint32 windowSize;
+		byte *window;		// The uncompressed data before out
+	};
+
+	ZipStoragePtr _storage;
+	ZipInflater *_inflater;
+	const byte *_data;		// The compressed data, if the archive is in memory
+
+	uint32 _dataPos;
+	uint32 _compressedSize;
+	uint32 _size;
+	uint32 _crc;
+
+	uint32 _in;				// Compressed bytes passed to zlib
+	uint32 _out;			// Uncompressed bytes produced
+	uint32 _windowFill;		// Bytes before _out available in the window
+	uint32 _crcData;		// CRC of the data produced, if valid
+	bool _crcValid;
+
+	Array<Checkpoint> _checkpoints;
+
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+	bool restart(const Checkpoint *checkpoint);
+	bool inflateMore();
+	void addCheckpoint();
+};
+
+ZipInflateStream::ZipInflateStream(const ZipStoragePtr &storage, ZipInflater *inflater, uint32 dataPos,
+                                   uint32 compressedSize, uint32 size, uint32 crc)
+	: _storage(storage), _inflater(inflater), _dataPos(dataPos), _compressedSize(compressedSize),
+	  _size(size), _crc(crc), _pos(0), _eos(false), _err(false) {
+
+	_data = storage->getStream()->getData();
+	if (_data)
+		_data += dataPos;
+
+	_err = !restart(0);
+}
+
+ZipInflateStream::~ZipInflateStream() {
+	for (uint i = 0; i < _checkpoints.size(); i++)
+		delete[] _checkpoints[i].window;
+
+	_storage->releaseInflater(_inflater);
+}
+
+bool ZipInflateStream::restart(const Checkpoint *checkpoint) {
+	z_stream &stream = _inflater->stream;
+
+	if (inflateReset(&stream) != Z_OK)
+		return false;
+	stream.next_in = Z_NULL;
+	stream.avail_in = 0;
+
+	if (!checkpoint) {
+		_in = 0;
+		_out = 0;
+		_windowFill = 0;
+		_crcData = crc32(0, Z_NULL, 0);
+		_crcValid = true;
+		return true;
 	}
 
-	SeekableReadStream *open() {
-		...
+	if (checkpoint->bits) {
+		byte partial;
+		if (_data) {
+			partial = _data[checkpoint->in - 1];
+		} else {
+			SeekableReadStream *parent = _storage->getStream();
+			parent->seek(_dataPos + checkpoint->in - 1);
+			partial = parent->readByte();
+			if (parent->err() || parent->eos())
+				return false;
+		}
+		if (inflatePrime(&stream, checkpoint->bits, partial >> (8 - checkpoint->bits)) != Z_OK)
+			return false;
 	}
+
+	if (inflateSetDictionary(&stream, checkpoint->window, checkpoint->windowSize) != Z_OK)
+		return false;
+
+	_in = checkpoint->in;
+	_out = checkpoint->out;
+	_windowFill = checkpoint->windowSize;
+	for (uint32 i = 0; i < checkpoint->windowSize; i++)
+		_inflater->window[(_out - checkpoint->windowSize + i) % ZIP_WINDOW_SIZE] = checkpoint->window[i];
+
+	// The CRC can only be checked when decompressing from the beginning
+	_crcValid = false;
+	return true;
+}
+
+void ZipInflateStream::addCheckpoint() {
+	Checkpoint checkpoint;
+	checkpoint.in = _in - _inflater->stream.avail_in;
+	checkpoint.bits = _inflater->stream.data_type & 7;
+	checkpoint.out = _out;
+	checkpoint.windowSize = _windowFill;
+	checkpoint.window = new byte[_windowFill];
+	for (uint32 i = 0; i < _windowFill; i++)
+		checkpoint.window[i] = _inflater->window[(_out - _windowFill + i) % ZIP_WINDOW_SIZE];
+
+	_checkpoints.push_back(checkpoint);
+}
+
+bool ZipInflateStream::inflateMore() {
+	z_stream &stream = _inflater->stream;
+
+	if (stream.avail_in == 0 && _in < _compressedSize) {
+		uint32 count = _compressedSize - _in;
+		if (_data) {
+			stream.next_in = const_cast<byte *>(_data + _in);
+		} else {
+			count = MIN<uint32>(count, UNZ_BUFSIZE);
+
+			SeekableReadStream *parent = _storage->getStream();
+			parent->seek(_dataPos + _in);
+			if (parent->read(_inflater->input, count) != count)
+				return false;
+			stream.next_in = _inflater->input;
+		}
+		stream.avail_in = count;
+		_in += count;
+	}
+
+	// Stop at the end of the window, and at block boundaries where the
+	// decompression state is easy to save
+	const uint32 offset = _out % ZIP_WINDOW_SIZE;
+	stream.next_out = _inflater->window + offset;
+	stream.avail_out = MIN<uint32>(ZIP_WINDOW_SIZE - offset, _size - _out);
+
+	// Z_BUF_ERROR means the compressed data ended too early
+	const int result = inflate(&stream, Z_BLOCK);
+	if (result != Z_OK && result != Z_STREAM_END)
+		return false;
+
+	const uint32 produced = stream.next_out - (_inflater->window + offset);
+	if (_crcValid)
+		_crcData = crc32(_crcData, _inflater->window + offset, produced);
+	_out += produced;
+	_windowFill = MIN<uint32>(_windowFill + produced, ZIP_WINDOW_SIZE);
+
+	if (_out == _size) {
+		if (_crcValid && _crcData != _crc) {
+			warning("ZipInflateStream: CRC error");
+			return false;
+		}
+	} else if (result == Z_STREAM_END) {
+		return false;
+	} else if ((stream.data_type & 128) && !(stream.data_type & 64)) {
+		const uint32 last = _checkpoints.empty() ? 0 : _checkpoints.back().out;
+		if (_out >= last + kZipCheckpointSpan)
+			addCheckpoint();
+	}
+
+	return true;
+}
+
+uint32 ZipInflateStream::read(void *dataPtr, uint32 dataSize) {
+	if (_err)
+		return 0;
+
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	if (dataSize && (_pos < _out - _windowFill || _pos > _out)) {
+		// Resume from the closest checkpoint when the data was decompressed
+		// before, or when it is further than what is left to skip
+		const Checkpoint *checkpoint = 0;
+		for (uint i = _checkpoints.size(); i-- > 0;) {
+			if (_checkpoints[i].out <= _pos) {
+				checkpoint = &_checkpoints[i];
+				break;
+			}
+		}
+
+		if (_pos < _out - _windowFill || (checkpoint && checkpoint->out > _out)) {
+			if (!restart(checkpoint)) {
+				_err = true;
+				return 0;
+			}
+		}
+	}
+
+	byte *dst = (byte *)dataPtr;
+	uint32 done = 0;
+	while (done < dataSize) {
+		if (_pos < _out) {
+			const uint32 offset = _pos % ZIP_WINDOW_SIZE;
+			const uint32 count = MIN<uint32>(MIN<uint32>(_out - _pos, ZIP_WINDOW_SIZE - offset), dataSize - done);
+			memcpy(dst + done, _inflater->window + offset, count);
+			done += count;
+			_pos += count;
+		} else if (!inflateMore()) {
+			_err = true;
+			break;
+		}
+	}
+
+	return done;
+}
+
+bool ZipInflateStream::seek(int32 offset, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offset += _size;
+		break;
+	case SEEK_CUR:
+		offset += _pos;
+		break;
+	default:
+		break;
+	}
+
+	if (offset < 0 || (uint32)offset > _size)
+		return false;
+
+	// The data is decompressed on the next read
+	_pos = offset;
+	_eos = false;
+	return true;
+}
+
+#endif
+
+
+class ZipArchive : public Archive {
+	unzFile _zipFile;
+	ZipStoragePtr _storage;
+
+public:
+	ZipArchive(unzFile zipFile);
+
+
+	~ZipArchive();
+
+	virtual bool hasFile(const String &name) const;
+	virtual int listMembers(ArchiveMemberList &list) const;
+	virtual const ArchiveMemberPtr getMember(const String &name) const;
+	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
 };
-*/
 
 ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
 	assert(_zipFile);
+
+	// The member streams may outlive the archive, so they share the
+	// ownership of the ZIP file with it
+	unz_s *archive = (unz_s *)_zipFile;
+	_storage = ZipStoragePtr(new ZipStorage(archive->_stream));
 }
 
 ZipArchive::~ZipArchive() {
+	((unz_s *)_zipFile)->_stream = 0;
 	unzClose(_zipFile);
 }
 
@@ -1489,32 +1867,77 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	unz_s *archive = (unz_s *)_zipFile;
+	const unz_file_info &fileInfo = archive->cur_file_info;
+
+	uInt headerSize;
+	uLong extraFieldOffset;
+	uInt extraFieldSize;
+	if (unzlocal_CheckCurrentFileCoherencyHeader(archive, &headerSize, &extraFieldOffset, &extraFieldSize) != UNZ_OK)
 		return 0;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
+	const uint32 dataPos = archive->byte_before_the_zipfile + archive->cur_file_info_internal.offset_curfile +
+	                       SIZEZIPLOCALHEADER + headerSize;
+	const uint32 size = fileInfo.uncompressed_size;
+
+	if (fileInfo.compression_method == 0) {
+		if (_storage->getStream()->getData() || size > kZipMaxBufferedSize)
+			return new ZipStoredStream(_storage, dataPos, dataPos + size);
+
+		byte *buffer = (byte *)malloc(size);
+		assert(size == 0 || buffer);
+
+		SeekableReadStream *parent = _storage->getStream();
+		parent->seek(dataPos);
+		if (parent->read(buffer, size) != size) {
+			free(buffer);
+			return 0;
+		}
+
+#ifdef USE_ZLIB
+		if (crc32(0, buffer, size) != fileInfo.crc) {
+			warning("ZipArchive: CRC error in '%s'", name.c_str());
+			free(buffer);
+			return 0;
+		}
+#endif
+
+		return new MemoryReadStream(buffer, size, DisposeAfterUse::YES);
+	}
+
+#ifdef USE_ZLIB
+	if (fileInfo.compression_method != Z_DEFLATED)
 		return 0;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
+	ZipInflater *inflater = _storage->acquireInflater();
+	if (!inflater)
+		return 0;
 
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
+	SeekableReadStream *stream = new ZipInflateStream(_storage, inflater, dataPos, fileInfo.compressed_size, size, fileInfo.crc);
+	if (stream->err()) {
+		delete stream;
 		return 0;
 	}
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
+	if (size > kZipMaxBufferedSize)
+		return stream;
+
+	// Small members are cheaper to keep in memory
+	byte *buffer = (byte *)malloc(size);
+	assert(size == 0 || buffer);
+
+	const bool success = stream->read(buffer, size) == size && !stream->err();
+	delete stream;
+	if (!success) {
 		free(buffer);
 		return 0;
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	return new MemoryReadStream(buffer, size, DisposeAfterUse::YES);
+#else
+	// Cannot decompress the member without zlib
+	return 0;
+#endif
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -21,12 +21,12 @@
  */
 
 #include "common/ustr.h"
-#include "common/memorypool.h"
 #include "common/util.h"
 
 namespace Common {
 
-extern MemoryPool *g_refCountPool;
+int *allocRefCount();
+void freeRefCount(int *refCount);
 
 static uint32 computeCapacity(uint32 len) {
 	// By default, for the capacity we use the next multiple of 32
@@ -273,12 +273,7 @@ void U32String::ensureCapacity(uint32 new_size, bool keep_old) {
 void U32String::incRefCount() const {
 	assert(!isStorageIntern());
 	if (_extern._refCount == 0) {
-		if (g_refCountPool == 0) {
-			g_refCountPool = new MemoryPool(sizeof(int));
-			assert(g_refCountPool);
-		}
-
-		_extern._refCount = (int *)g_refCountPool->allocChunk();
+		_extern._refCount = allocRefCount();
 		*_extern._refCount = 2;
 	} else {
 		++(*_extern._refCount);
@@ -295,10 +290,8 @@ void U32String::decRefCount(int *oldRefCount) {
 	if (!oldRefCount || *oldRefCount <= 0) {
 		// The ref count reached zero, so we free the string storage
 		// and the ref count storage.
-		if (oldRefCount) {
-			assert(g_refCountPool);
-			g_refCountPool->freeChunk(oldRefCount);
-		}
+		if (oldRefCount)
+			freeRefCount(oldRefCount);
 		delete[] _str;
 
 		// Even though _str points to a freed memory block now,
@@ -334,7 +334,7 @@ protected:
 	}
 
 public:
-	GZipWriteStream(WriteStream *w) : _wrapped(w), _stream(), _pos(0) {
+	GZipWriteStream(WriteStream *w, int level) : _wrapped(w), _stream(), _pos(0) {
 		assert(w != 0);
 
 		// Adding 16 to windowBits indicates to zlib that it is supposed to
@@ -342,7 +342,7 @@ public:
 		// released 10 August 2003.
 		// Note: This is *crucial* for savegame compatibility, do *not* remove!
 		_zlibErr = deflateInit2(&_stream,
-		                 Z_DEFAULT_COMPRESSION,
+		                 level,
 		                 Z_DEFLATED,
 		                 MAX_WBITS + 16,
 		                 8,
@@ -432,10 +432,10 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
-WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
+WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped, int level) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
-		return new GZipWriteStream(toBeWrapped);
+		return new GZipWriteStream(toBeWrapped, CLIP(level, -1, 9));
 #endif
 	return toBeWrapped;
 }
@@ -130,8 +130,12 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
  *
  * It is safe to call this with a NULL parameter (in this case, NULL is
  * returned).
+ *
+ * @param toBeWrapped	the stream to be wrapped
+ * @param level			the zlib compression level, from 0 (none) and 1
+ *						(fastest) to 9 (best), or -1 for zlib's default
  */
-WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped);
+WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped, int level = -1);
 
 } // End of namespace Common
 
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/algorithm.h"
 #include "common/debug.h"
 #include "common/util.h"
 #include "common/file.h"
@@ -31,6 +32,7 @@
 #include "common/translation.h"
 #include "gui/EventRecorder.h"
 #include "engines/advancedDetector.h"
+#include "engines/detectionCache.h"
 #include "engines/obsolete.h"
 
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
@@ -183,6 +185,26 @@ GameList AdvancedMetaEngine::detectGames(const Common::FSList &fslist) const {
 	return detectedGames;
 }
 
+void AdvancedMetaEngine::getDetectionFiles(DetectionFileMap &files) const {
+	for (const byte *descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != 0; descPtr += _descItemSize) {
+		const ADGameDescription *g = (const ADGameDescription *)descPtr;
+
+		// Resource forks are not checksummed through the detection cache
+		if (g->flags & ADGF_MACRESFORK)
+			continue;
+
+		for (const ADGameFileDescription *fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
+			// Only report files found directly in the scanned directory
+			if (strchr(fileDesc->fileName, '/'))
+				continue;
+
+			Common::Array<uint32> &md5Bytes = files[fileDesc->fileName];
+			if (Common::find(md5Bytes.begin(), md5Bytes.end(), (uint32)_md5Bytes) == md5Bytes.end())
+				md5Bytes.push_back(_md5Bytes);
+		}
+	}
+}
+
 const ExtraGuiOptions AdvancedMetaEngine::getExtraGuiOptions(const Common::String &target) const {
 	if (!_extraGuiOptions)
 		return ExtraGuiOptions();
@@ -418,14 +440,7 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
-	Common::File testFile;
-
-	if (!testFile.open(allFiles[fname]))
-		return false;
-
-	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
-	return true;
+	return DetectionCache::instance().getFileProperties(allFiles[fname], _md5Bytes, fileProps.size, fileProps.md5);
 }
 
 ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, const FileMap &allFiles, Common::Language language, Common::Platform platform, const Common::String &extra) const {
@@ -280,6 +280,8 @@ public:
 
 	virtual GameList detectGames(const Common::FSList &fslist) const;
 
+	virtual void getDetectionFiles(DetectionFileMap &files) const;
+
 	virtual Common::Error createInstance(OSystem *syst, Engine **engine) const;
 
 	virtual const ExtraGuiOptions getExtraGuiOptions(const Common::String &target) const;
@@ -0,0 +1,192 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectionCache.h"
+
+#include "common/file.h"
+#include "common/fs.h"
+#include "common/md5.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+#define DETECTION_CACHE_FILENAME "detection.cache"
+#define DETECTION_CACHE_VERSION 1
+
+// The cache is rebuilt from scratch beyond that many entries, so that it
+// does not grow forever with files which were moved or deleted.
+#define DETECTION_CACHE_MAX_ENTRIES 65536
+
+DetectionCache::DetectionCache() : _loaded(false), _dirty(false) {
+}
+
+static Common::String digestToString(const byte *digest) {
+	Common::String md5;
+	for (int i = 0; i < 16; i++)
+		md5 += Common::String::format("%02x", (int)digest[i]);
+	return md5;
+}
+
+// The cache is kept next to the configuration file, out of the saves
+static Common::FSNode getCacheNode() {
+	const Common::FSNode config(g_system->getDefaultConfigFileName());
+	return config.getParent().getChild(DETECTION_CACHE_FILENAME);
+}
+
+Common::String DetectionCache::makeKey(const Common::String &path, uint32 md5Bytes) {
+	return Common::String::format("%u:", md5Bytes) + path;
+}
+
+void DetectionCache::load() {
+	_loaded = true;
+
+	const Common::FSNode node = getCacheNode();
+	if (!node.exists())
+		return;
+
+	Common::SeekableReadStream *in = node.createReadStream();
+	if (!in)
+		return;
+
+	if (in->readUint32BE() != MKTAG('S', 'V', 'D', 'C') || in->readByte() != DETECTION_CACHE_VERSION) {
+		warning("Ignoring invalid detection cache");
+		delete in;
+		return;
+	}
+
+	const uint32 count = in->readUint32LE();
+	for (uint32 i = 0; i < count && !in->eos() && !in->err(); i++) {
+		Entry entry;
+		entry.md5Bytes = in->readUint32LE();
+		entry.size = in->readUint32LE();
+		entry.modificationTime = in->readUint32LE();
+		in->read(entry.md5, sizeof(entry.md5));
+
+		const uint16 pathLength = in->readUint16LE();
+		for (uint16 c = 0; c < pathLength; c++)
+			entry.path += (char)in->readByte();
+
+		if (in->eos() || in->err())
+			break;
+
+		_entries[makeKey(entry.path, entry.md5Bytes)] = entry;
+	}
+
+	delete in;
+}
+
+void DetectionCache::preload() {
+	Common::StackLock lock(_mutex);
+
+	if (!_loaded)
+		load();
+}
+
+void DetectionCache::flush() {
+	Common::StackLock lock(_mutex);
+
+	if (!_dirty)
+		return;
+	_dirty = false;
+
+	Common::WriteStream *out = getCacheNode().createWriteStream();
+	if (!out) {
+		warning("Could not write the detection cache");
+		return;
+	}
+
+	out->writeUint32BE(MKTAG('S', 'V', 'D', 'C'));
+	out->writeByte(DETECTION_CACHE_VERSION);
+	out->writeUint32LE(_entries.size());
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		const Entry &entry = i->_value;
+		out->writeUint32LE(entry.md5Bytes);
+		out->writeUint32LE(entry.size);
+		out->writeUint32LE(entry.modificationTime);
+		out->write(entry.md5, sizeof(entry.md5));
+		out->writeUint16LE(entry.path.size());
+		out->writeString(entry.path);
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("Could not write the detection cache");
+	delete out;
+}
+
+bool DetectionCache::getFileProperties(const Common::FSNode &node, uint32 md5Bytes, int32 &size, Common::String &md5) {
+	uint32 fileSize, modificationTime;
+	const bool haveStats = node.getFileStats(fileSize, modificationTime);
+	const Common::String path = Common::normalizePath(node.getPath(), '/');
+	const Common::String key = makeKey(path, md5Bytes);
+
+	if (haveStats) {
+		Common::StackLock lock(_mutex);
+
+		if (!_loaded)
+			load();
+
+		EntryMap::const_iterator i = _entries.find(key);
+		if (i != _entries.end() && i->_value.size == fileSize && i->_value.modificationTime == modificationTime) {
+			size = (int32)fileSize;
+			md5 = digestToString(i->_value.md5);
+			return true;
+		}
+	}
+
+	Common::File file;
+	if (!file.open(node))
+		return false;
+
+	size = (int32)file.size();
+
+	Entry entry;
+	if (!Common::computeStreamMD5(file, entry.md5, md5Bytes)) {
+		md5.clear();
+		return true;
+	}
+	md5 = digestToString(entry.md5);
+
+	// Only cache the result if the file did not change meanwhile
+	if (haveStats && (uint32)size == fileSize) {
+		Common::StackLock lock(_mutex);
+
+		if (_entries.size() >= DETECTION_CACHE_MAX_ENTRIES)
+			_entries.clear();
+
+		// String storage is reference counted without any locking, so do
+		// not share it with the caller, which may run on another thread.
+		Entry &cached = _entries[Common::String(key.c_str())];
+		cached.path = path.c_str();
+		cached.md5Bytes = md5Bytes;
+		cached.size = fileSize;
+		cached.modificationTime = modificationTime;
+		memcpy(cached.md5, entry.md5, sizeof(cached.md5));
+		_dirty = true;
+	}
+
+	return true;
+}
@@ -0,0 +1,96 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+class FSNode;
+}
+
+/**
+ * On-disk cache of the file sizes and MD5 checksums used by game detection.
+ *
+ * Entries are keyed by the path of the file and the number of bytes the
+ * checksum covers, and record the size and modification time the file had
+ * when it was computed. An entry is checked against the current stats of its
+ * file when it is looked up, and recomputed if the file changed. Files whose
+ * stats the filesystem backend cannot report are never cached.
+ *
+ * The cache is kept next to the configuration file, so that it does not
+ * show up among the saves, and written back by flush().
+ * Once preload() was called, getFileProperties() may also be used from
+ * worker threads.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	/**
+	 * Get the size of a file, along with the MD5 checksum of its first
+	 * md5Bytes bytes (or of the whole file if md5Bytes is 0).
+	 *
+	 * @return true on success, false if the file could not be read
+	 */
+	bool getFileProperties(const Common::FSNode &node, uint32 md5Bytes, int32 &size, Common::String &md5);
+
+	/**
+	 * Read the cache from disk, if that was not done yet. getFileProperties()
+	 * does so on its own, but worker threads cannot ask the backend where
+	 * the configuration file is, so this has to be called before using it
+	 * from one.
+	 */
+	void preload();
+
+	/**
+	 * Write the cache back to disk if it changed.
+	 */
+	void flush();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+
+	struct Entry {
+		Common::String path;
+		uint32 md5Bytes;
+		uint32 size;
+		uint32 modificationTime;
+		byte md5[16];
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	Common::Mutex _mutex;
+	EntryMap _entries;
+	bool _loaded;
+	bool _dirty;
+
+	void load();
+	static Common::String makeKey(const Common::String &path, uint32 md5Bytes);
+};
+
+#endif
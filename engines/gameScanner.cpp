@@ -0,0 +1,188 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/gameScanner.h"
+#include "engines/detectionCache.h"
+
+GameScanner::GameScanner(const Common::FSNode &startDir, uint threadCount)
+	: _semaphore(0), _inFlight(0), _dirCount(1), _stop(false) {
+
+	_pending.push_back(Common::String(startDir.getPath().c_str()));
+
+	// Workers cannot load the cache, nor query the plugins
+	DetectionCache::instance().preload();
+	EngineMan.getDetectionFiles(_detectionFiles);
+
+	if (threadCount > 0)
+		_semaphore = g_system->createSemaphore(1);
+
+	for (uint i = 0; _semaphore && i < threadCount; i++) {
+		OSystem::ThreadRef thread = g_system->createThread(workerProc, this);
+		if (!thread)
+			break;
+		_workers.push_back(thread);
+	}
+
+	// Unless some threads are running, scan on the calling thread
+	if (_workers.empty() && _semaphore) {
+		g_system->deleteSemaphore(_semaphore);
+		_semaphore = 0;
+	}
+}
+
+GameScanner::~GameScanner() {
+	{
+		Common::StackLock lock(_mutex);
+		_stop = true;
+	}
+
+	for (uint i = 0; i < _workers.size(); i++)
+		g_system->postSemaphore(_semaphore);
+	for (uint i = 0; i < _workers.size(); i++)
+		g_system->joinThread(_workers[i]);
+	if (_semaphore)
+		g_system->deleteSemaphore(_semaphore);
+
+	while (!_results.empty())
+		delete _results.pop();
+}
+
+void GameScanner::workerProc(void *data) {
+	GameScanner *scanner = (GameScanner *)data;
+
+	// The semaphore counts the pending directories, plus one per worker
+	// once stopping
+	do {
+		g_system->waitSemaphore(scanner->_semaphore);
+	} while (scanner->scanDirectory());
+}
+
+bool GameScanner::scanDirectory() {
+	Common::String path;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		if (_stop || _pending.empty())
+			return false;
+
+		path = _pending.back().c_str();
+		_pending.pop_back();
+		_inFlight++;
+	}
+
+	Result *result = new Result;
+	Common::Array<Common::String> subdirs;
+
+	{
+		Common::FSNode dir(path);
+		Common::FSList files;
+
+		if (dir.getChildren(files, Common::FSNode::kListAll)) {
+			result->dir = path.c_str();
+			for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+				const Common::String filePath(file->getPath().c_str());
+				result->files.push_back(filePath);
+
+				if (file->isDirectory())
+					subdirs.push_back(filePath);
+				else
+					prefetch(*file);
+			}
+		} else {
+			delete result;
+			result = 0;
+		}
+	}
+
+	const uint newDirs = subdirs.size();
+
+	{
+		Common::StackLock lock(_mutex);
+
+		// Hand the result over while holding the lock, so that no reference
+		// counted data is left behind on this thread
+		for (uint i = 0; i < newDirs; i++)
+			_pending.push_back(subdirs[i]);
+		_dirCount += newDirs;
+		subdirs.clear();
+
+		if (result)
+			_results.push(result);
+		_inFlight--;
+	}
+
+	for (uint i = 0; _semaphore && i < newDirs; i++)
+		g_system->postSemaphore(_semaphore);
+
+	return true;
+}
+
+void GameScanner::prefetch(const Common::FSNode &file) {
+	Common::String name = file.getName();
+
+	// Detectors ignore trailing dots, see composeFileHashMap()
+	if (name.lastChar() == '.')
+		name.deleteLastChar();
+
+	DetectionFileMap::const_iterator i = _detectionFiles.find(name);
+	if (i == _detectionFiles.end())
+		return;
+
+	for (uint j = 0; j < i->_value.size(); j++) {
+		int32 size;
+		Common::String md5;
+		DetectionCache::instance().getFileProperties(file, i->_value[j], size, md5);
+	}
+}
+
+bool GameScanner::nextDirectory(Common::FSNode &dir, Common::FSList &files) {
+	if (!_semaphore)
+		scanDirectory();
+
+	Result *result;
+	{
+		Common::StackLock lock(_mutex);
+		if (_results.empty())
+			return false;
+		result = _results.pop();
+	}
+
+	// Nodes are only created on this thread
+	dir = Common::FSNode(result->dir);
+	files.clear();
+	for (uint i = 0; i < result->files.size(); i++)
+		files.push_back(Common::FSNode(result->files[i]));
+
+	delete result;
+	return true;
+}
+
+bool GameScanner::isDone() {
+	Common::StackLock lock(_mutex);
+	return _pending.empty() && !_inFlight && _results.empty();
+}
+
+uint GameScanner::getDirectoryCount() {
+	Common::StackLock lock(_mutex);
+	return _dirCount;
+}
@@ -0,0 +1,110 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_GAMESCANNER_H
+#define ENGINES_GAMESCANNER_H
+
+#include "common/array.h"
+#include "common/fs.h"
+#include "common/mutex.h"
+#include "common/queue.h"
+#include "common/str.h"
+#include "common/system.h"
+
+#include "engines/metaengine.h"
+
+/**
+ * Recursive directory scanner used to detect games in a whole directory
+ * tree, as done by the mass add dialog.
+ *
+ * Directories are listed by a pool of worker threads, which also compute
+ * the checksums of the files game detectors look at through the
+ * DetectionCache. The workers wait on a semaphore counting the directories
+ * left to list, for as long as the scanner lives. The listings are handed
+ * back as paths, and nextDirectory() turns them into nodes one directory at
+ * a time, for the caller to run the actual detection on them; engines are
+ * not thread safe, so that is left to the calling thread.
+ *
+ * If the backend does not support threads, each call to nextDirectory()
+ * scans a single directory on the calling thread instead.
+ */
+class GameScanner {
+public:
+	enum {
+		kDefaultThreadCount = 4
+	};
+
+	/**
+	 * Start scanning the given directory and all its subdirectories.
+	 *
+	 * @param startDir		the directory to scan
+	 * @param threadCount	the number of worker threads, 0 to scan on the
+	 *						calling thread
+	 */
+	GameScanner(const Common::FSNode &startDir, uint threadCount = kDefaultThreadCount);
+	~GameScanner();
+
+	/**
+	 * Get the next scanned directory and its content. Returns immediately if
+	 * the worker threads did not finish scanning any directory yet.
+	 *
+	 * @return true if a directory was returned, false otherwise
+	 */
+	bool nextDirectory(Common::FSNode &dir, Common::FSList &files);
+
+	/** Whether all directories were scanned and returned by nextDirectory(). */
+	bool isDone();
+
+	/** The number of directories found so far, including the start directory. */
+	uint getDirectoryCount();
+
+private:
+	/** A listed directory, built on the worker and owned by the receiver. */
+	struct Result {
+		Common::String dir;
+		Common::Array<Common::String> files;
+	};
+
+	Common::Array<OSystem::ThreadRef> _workers;
+	OSystem::SemaphoreRef _semaphore;
+
+	// Read-only once the scan started
+	DetectionFileMap _detectionFiles;
+
+	Common::Mutex _mutex;
+
+	// All of the following are protected by _mutex. Paths are passed between
+	// threads rather than nodes, since the node and string reference counts
+	// are not thread safe: each one is a copy of its own.
+	Common::Array<Common::String> _pending;
+	Common::Queue<Result *> _results;
+	uint _inFlight;
+	uint _dirCount;
+	bool _stop;
+
+	bool scanDirectory();
+	void prefetch(const Common::FSNode &file);
+
+	static void workerProc(void *data);
+};
+
+#endif
@@ -26,6 +26,8 @@
 #include "common/scummsys.h"
 #include "common/error.h"
 #include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 
 #include "engines/game.h"
 #include "engines/savestate.h"
@@ -53,6 +55,12 @@ struct ExtraGuiOption {
 
 typedef Common::Array<ExtraGuiOption> ExtraGuiOptions;
 
+/**
+ * Map of the names of the files game detectors look at, to the numbers of
+ * bytes they checksum in these files (0 for the whole file).
+ */
+typedef Common::HashMap<Common::String, Common::Array<uint32>, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> DetectionFileMap;
+
 /**
  * A meta engine is essentially a factory for Engine instances with the
  * added ability of listing and detecting supported games.
@@ -81,6 +89,16 @@ public:
 	 */
 	virtual GameList detectGames(const Common::FSList &fslist) const = 0;
 
+	/**
+	 * Adds the names of the files detectGames() computes checksums of to the
+	 * given map, along with the number of bytes it checksums. This allows
+	 * the checksums to be computed ahead of time, e.g. by the mass add
+	 * scanner.
+	 *
+	 * The default implementation does nothing.
+	 */
+	virtual void getDetectionFiles(DetectionFileMap &files) const {}
+
 	/**
 	 * Tries to instantiate an engine instance based on the settings of
 	 * the currently active ConfMan target. That is, the MetaEngine should
@@ -275,6 +293,7 @@ public:
 	GameDescriptor findGameInLoadedPlugins(const Common::String &gameName, const EnginePlugin **plugin = NULL) const;
 	GameDescriptor findGame(const Common::String &gameName, const EnginePlugin **plugin = NULL) const;
 	GameList detectGames(const Common::FSList &fslist) const;
+	void getDetectionFiles(DetectionFileMap &files) const;
 	const EnginePlugin::List &getPlugins() const;
 };
 
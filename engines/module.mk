@@ -2,9 +2,11 @@ MODULE := engines
 
 MODULE_OBJS := \
 	advancedDetector.o \
+	detectionCache.o \
 	dialogs.o \
 	engine.o \
 	game.o \
+	gameScanner.o \
 	obsolete.o \
 	savestate.o
 
@@ -197,7 +197,11 @@ Common::Error QueenEngine::saveGameState(int slot, const Common::String &desc) {
 	char name[20];
 	Common::Error err = Common::kNoError;
 	makeGameStateName(slot, name);
-	Common::OutSaveFile *file = _saveFileMan->openForSaving(name);
+	Common::OutSaveFile *file;
+	if (slot == SLOT_AUTOSAVE)
+		file = _saveFileMan->openForAutosaving(name);
+	else
+		file = _saveFileMan->openForSaving(name);
 	if (file) {
 		// save data
 		byte *saveData = new byte[SAVESTATE_MAX_SIZE];
@@ -402,12 +402,11 @@ void GfxFrameout::frameOut(const bool shouldShowBits, const Common::Rect &eraseR
 	}
 
 	// SSCI allocated these as static arrays of 100 pointers to
-	// ScreenItemList / RectList
-	ScreenItemListList screenItemLists;
-	EraseListList eraseLists;
-
-	screenItemLists.resize(_planes.size());
-	eraseLists.resize(_planes.size());
+	// ScreenItemList / RectList. Their items only live for this frame, so
+	// they are taken from the frame arena and released together.
+	Common::ArenaScope frameScope(_frameArena);
+	ScreenItemListList screenItemLists(_planes.size(), DrawList(&_frameArena));
+	EraseListList eraseLists(_planes.size(), RectList(&_frameArena));
 
 	if (g_sci->_gfxRemap32->getRemapCount() > 0 && _remapOccurred) {
 		remapMarkRedraw();
@@ -460,12 +459,11 @@ void GfxFrameout::palMorphFrameOut(const int8 *styleRanges, PlaneShowStyle *show
 	showBits();
 
 	// SSCI allocated these as static arrays of 100 pointers to
-	// ScreenItemList / RectList
-	ScreenItemListList screenItemLists;
-	EraseListList eraseLists;
-
-	screenItemLists.resize(_planes.size());
-	eraseLists.resize(_planes.size());
+	// ScreenItemList / RectList. Their items only live for this frame, so
+	// they are taken from the frame arena and released together.
+	Common::ArenaScope frameScope(_frameArena);
+	ScreenItemListList screenItemLists(_planes.size(), DrawList(&_frameArena));
+	EraseListList eraseLists(_planes.size(), RectList(&_frameArena));
 
 	if (g_sci->_gfxRemap32->getRemapCount() > 0 && _remapOccurred) {
 		remapMarkRedraw();
@@ -668,7 +666,7 @@ int splitRectsForRender(Common::Rect &middleRect, const Common::Rect &showRect,
 
 // The third rectangle parameter is only ever passed by VMD code
 void GfxFrameout::calcLists(ScreenItemListList &drawLists, EraseListList &eraseLists, const Common::Rect &eraseRect) {
-	RectList eraseList;
+	RectList eraseList(&_frameArena);
 	Common::Rect outRects[4];
 	int deletedPlaneCount = 0;
 	bool addedToEraseList = false;
@@ -932,7 +930,8 @@ void GfxFrameout::drawScreenItemList(const DrawList &screenItemList) {
 }
 
 void GfxFrameout::mergeToShowList(const Common::Rect &drawRect, RectList &showList, const int overdrawThreshold) {
-	RectList mergeList;
+	Common::ArenaScope mergeScope(_frameArena);
+	RectList mergeList(&_frameArena);
 	Common::Rect merged;
 	mergeList.add(drawRect);
 
@@ -322,6 +322,12 @@ private:
 	 */
 	RectList _showList;
 
+	/**
+	 * Memory for the draw and erase lists which are built for each frame.
+	 * Like the rest of the renderer, it is only used on the engine thread.
+	 */
+	Common::Arena _frameArena;
+
 	/**
 	 * The amount of extra overdraw that is acceptable when merging two show
 	 * list rectangles together into a single larger rectangle.
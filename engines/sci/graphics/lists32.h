@@ -23,6 +23,7 @@
 #ifndef SCI_GRAPHICS_LISTS32_H
 #define SCI_GRAPHICS_LISTS32_H
 
+#include "common/arena.h"
 #include "common/array.h"
 
 namespace Sci {
@@ -33,11 +34,15 @@ namespace Sci {
  * RectList, and ScreenItemList. StablePointerArray takes ownership of all
  * pointers that are passed to it and deletes them when calling `erase` or when
  * destroying the StablePointerArray.
+ *
+ * Items are deleted through the allocator of the array, so when it has an
+ * arena, items passed to `add` must come from `getAllocator().create()`.
  */
 template<class T, uint N>
 class StablePointerArray {
 	uint _size;
 	T *_items[N];
+	Common::ArenaAllocator<T> _allocator;
 
 public:
 	typedef T **iterator;
@@ -45,19 +50,19 @@ public:
 	typedef T *value_type;
 	typedef uint size_type;
 
-	StablePointerArray() : _size(0), _items() {}
-	StablePointerArray(const StablePointerArray &other) : _size(other._size) {
+	explicit StablePointerArray(Common::Arena *arena = nullptr) : _size(0), _items(), _allocator(arena) {}
+	StablePointerArray(const StablePointerArray &other) : _size(other._size), _allocator(other._allocator) {
 		for (size_type i = 0; i < _size; ++i) {
 			if (other._items[i] == nullptr) {
 				_items[i] = nullptr;
 			} else {
-				_items[i] = new T(*other._items[i]);
+				_items[i] = _allocator.create(*other._items[i]);
 			}
 		}
 	}
 	~StablePointerArray() {
 		for (size_type i = 0; i < _size; ++i) {
-			delete _items[i];
+			_allocator.destroy(_items[i]);
 		}
 	}
 
@@ -68,11 +73,18 @@ public:
 			if (other._items[i] == nullptr) {
 				_items[i] = nullptr;
 			} else {
-				_items[i] = new T(*other._items[i]);
+				_items[i] = _allocator.create(*other._items[i]);
 			}
 		}
 	}
 
+	/**
+	 * The allocator used to create and delete the items of the array.
+	 */
+	const Common::ArenaAllocator<T> &getAllocator() const {
+		return _allocator;
+	}
+
 	T *const &operator[](size_type index) const {
 		assert(index < _size);
 		return _items[index];
@@ -101,7 +113,7 @@ public:
 
 	void clear() {
 		for (size_type i = 0; i < _size; ++i) {
-			delete _items[i];
+			_allocator.destroy(_items[i]);
 			_items[i] = nullptr;
 		}
 
@@ -122,7 +134,7 @@ public:
 	void erase(T *item) {
 		for (iterator it = begin(); it != end(); ++it) {
 			if (*it == item) {
-				delete *it;
+				_allocator.destroy(*it);
 				*it = nullptr;
 				break;
 			}
@@ -134,7 +146,7 @@ public:
 	 */
 	void erase(iterator &it) {
 		assert(it >= _items && it < _items + _size);
-		delete *it;
+		_allocator.destroy(*it);
 		*it = nullptr;
 	}
 
@@ -144,7 +156,7 @@ public:
 	void erase_at(size_type index) {
 		assert(index < _size);
 
-		delete _items[index];
+		_allocator.destroy(_items[index]);
 		_items[index] = nullptr;
 	}
 
@@ -54,8 +54,10 @@ enum PlanePictureCodes {
 typedef StablePointerArray<Common::Rect, 200> RectListBase;
 class RectList : public RectListBase {
 public:
+	explicit RectList(Common::Arena *arena = nullptr) : RectListBase(arena) {}
+
 	void add(const Common::Rect &rect) {
-		RectListBase::add(new Common::Rect(rect));
+		RectListBase::add(getAllocator().create(rect));
 	}
 };
 
@@ -85,6 +87,8 @@ private:
 		return *a < *b;
 	}
 public:
+	explicit DrawList(Common::Arena *arena = nullptr) : DrawListBase(arena) {}
+
 	void add(ScreenItem *screenItem, const Common::Rect &rect);
 	inline void sort() {
 		pack();
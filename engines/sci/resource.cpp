@@ -960,7 +960,9 @@ void ResourceManager::freeResourceSources() {
 }
 
 ResourceManager::ResourceManager(const bool detectionMode) :
-	_detectionMode(detectionMode) {}
+	_detectionMode(detectionMode),
+	_memoryLockedStats("sci.locked"),
+	_memoryLRUStats("sci.lru") {}
 
 void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
@@ -1069,6 +1071,7 @@ void ResourceManager::removeFromLRU(Resource *res) {
 	}
 	_LRU.remove(res);
 	_memoryLRU -= res->size();
+	_memoryLRUStats.freed(res->size());
 	res->_status = kResStatusAllocated;
 }
 
@@ -1079,6 +1082,7 @@ void ResourceManager::addToLRU(Resource *res) {
 	}
 	_LRU.push_front(res);
 	_memoryLRU += res->size();
+	_memoryLRUStats.allocated(res->size());
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
 	      res->_id.toString().c_str(), res->size,
@@ -1155,6 +1159,7 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 			retval->_status = kResStatusLocked;
 			retval->_lockers = 0;
 			_memoryLocked += retval->_size;
+			_memoryLockedStats.allocated(retval->_size);
 		}
 		retval->_lockers++;
 	} else if (retval->_status != kResStatusLocked) { // Don't lock it
@@ -1181,6 +1186,7 @@ void ResourceManager::unlockResource(Resource *res) {
 	if (!--res->_lockers) { // No more lockers?
 		res->_status = kResStatusAllocated;
 		_memoryLocked -= res->size();
+		_memoryLockedStats.freed(res->size());
 		addToLRU(res);
 	}
 
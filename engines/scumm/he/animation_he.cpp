@@ -47,6 +47,9 @@ MoviePlayer::MoviePlayer(ScummEngine_v90he *vm, Audio::Mixer *mixer) : _vm(vm) {
 #endif
 		_video = new Video::SmackerDecoder();
 
+	// Decode frames ahead, so that the slower ones do not stall the scripts
+	_video->setDecodeAhead(4);
+
 	_flags = 0;
 	_wizResNum = 0;
 }
@@ -830,6 +830,7 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 
 	memset(ptr, 0, size + SAFETY_AREA);
 	_allocatedSize += size;
+	_memoryStats.allocated(size);
 
 	_types[type][idx]._address = ptr;
 	_types[type][idx]._size = size;
@@ -867,7 +868,7 @@ ResourceManager::ResTypeData::ResTypeData() {
 ResourceManager::ResTypeData::~ResTypeData() {
 }
 
-ResourceManager::ResourceManager(ScummEngine *vm) : _vm(vm) {
+ResourceManager::ResourceManager(ScummEngine *vm) : _vm(vm), _memoryStats("scumm.resources") {
 	_allocatedSize = 0;
 	_maxHeapThreshold = 0;
 	_minHeapThreshold = 0;
@@ -898,6 +899,7 @@ void ResourceManager::nukeResource(ResType type, ResId idx) {
 	if (ptr != NULL) {
 		debugC(DEBUG_RESOURCE, "nukeResource(%s,%d)", nameOfResType(type), idx);
 		_allocatedSize -= _types[type][idx]._size;
+		_memoryStats.freed(_types[type][idx]._size);
 		_types[type][idx].nuke();
 	}
 }
@@ -24,6 +24,7 @@
 #define SCUMM_RESOURCE_H
 
 #include "common/array.h"
+#include "common/memory-stats.h"
 #include "scumm/scumm.h"	// for ResType
 
 namespace Scumm {
@@ -173,6 +174,7 @@ public:
 
 protected:
 	uint32 _allocatedSize;
+	Common::MemoryCounter _memoryStats;
 	uint32 _maxHeapThreshold, _minHeapThreshold;
 	byte _expireCounter;
 
@@ -158,6 +158,9 @@ Common::SeekableReadStream *ScummEngine::openSaveFileForReading(int slot, bool c
 
 Common::WriteStream *ScummEngine::openSaveFileForWriting(int slot, bool compat, Common::String &fileName) {
 	fileName = makeSavegameName(slot, compat);
+	// Slot 0 holds the autosave, no need to wait for it to be written
+	if (slot == 0 && !compat)
+		return _saveFileMan->openForAutosaving(fileName);
 	return _saveFileMan->openForSaving(fileName);
 }
 
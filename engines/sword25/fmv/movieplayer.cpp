@@ -53,6 +53,10 @@ MoviePlayer::MoviePlayer(Kernel *pKernel) : Service(pKernel), _decoder() {
 		error("Script bindings could not be registered.");
 	else
 		debugC(kDebugScript, "Script bindings registered.");
+
+	// Decode a few frames ahead, so that the slower frames of the cutscenes
+	// do not make them stutter
+	_decoder.setDecodeAhead(4);
 }
 
 MoviePlayer::~MoviePlayer() {
@@ -35,6 +35,7 @@
 #include "common/stream.h"
 #include "common/memstream.h"
 #include "common/hashmap.h"
+#include "common/memory-stats.h"
 #include "common/ptr.h"
 
 #include <ft2build.h>
@@ -142,6 +143,7 @@ private:
 	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
 	typedef Common::HashMap<uint32, Glyph> GlyphCache;
 	mutable GlyphCache _glyphs;
+	mutable Common::MemoryCounter _glyphStats;
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
@@ -158,7 +160,7 @@ private:
 
 TTFFont::TTFFont()
     : _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
-      _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
+      _descent(0), _glyphs(), _glyphStats("fonts.ttf"), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
       _hasKerning(false), _allowLateCaching(false) {
 }
 
@@ -169,8 +171,10 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
+		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i) {
+			_glyphStats.freed(i->_value.image.h * i->_value.image.pitch);
 			i->_value.image.free();
+		}
 
 		_initialized = false;
 	}
@@ -641,6 +645,7 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		return false;
 	}
 
+	_glyphStats.allocated(glyph.image.h * glyph.image.pitch);
 	return true;
 }
 
@@ -26,6 +26,7 @@
 #include "common/endian.h"
 #include "common/algorithm.h"
 #include "common/system.h"
+#include "common/savefile.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
 
@@ -211,6 +212,20 @@ bool saveThumbnail(Common::WriteStream &out) {
 	return success;
 }
 
+bool saveThumbnail(Common::OutSaveFile &out) {
+	if (out.hasScreenThumbnail())
+		return saveThumbnail((Common::WriteStream &)out);
+
+	Graphics::Surface thumb;
+	thumb.create(1, 1, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+	*(uint16 *)thumb.getPixels() = 0;
+
+	bool success = saveThumbnail(out, thumb);
+	thumb.free();
+
+	return success;
+}
+
 bool saveThumbnail(Common::WriteStream &out, const Graphics::Surface &thumb) {
 	if (thumb.format.bytesPerPixel != 2 && thumb.format.bytesPerPixel != 4) {
 		warning("trying to save thumbnail with bpp %u", thumb.format.bytesPerPixel);
@@ -28,6 +28,7 @@
 namespace Common{
 class SeekableReadStream;
 class WriteStream;
+class OutSaveFile;
 }
 
 namespace Graphics {
@@ -60,6 +61,13 @@ Graphics::Surface *loadThumbnail(Common::SeekableReadStream &in);
  */
 bool saveThumbnail(Common::WriteStream &out);
 
+/**
+ * Saves a thumbnail to the given savefile. The thumbnail is created from
+ * screen contents, unless the savefile was opened without, in which case
+ * a 1x1 placeholder is written.
+ */
+bool saveThumbnail(Common::OutSaveFile &out);
+
 /**
  * Saves a (given) thumbnail to the given write stream.
  */
@@ -83,9 +83,26 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/util.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUV_USE_SSE2
+#include <emmintrin.h>
+
+// AVX2 kernels are built with a function level target, and only used when
+// the CPU supports them
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define YUV_USE_AVX2
+#include <immintrin.h>
+#define YUV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)) && !defined(SCUMM_BIG_ENDIAN)
+#define YUV_USE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -160,6 +177,14 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
 
+	_implementation = kImplementationTable;
+	if (isImplementationSupported(kImplementationSSE2))
+		_implementation = kImplementationSSE2;
+	if (isImplementationSupported(kImplementationAVX2))
+		_implementation = kImplementationAVX2;
+	if (isImplementationSupported(kImplementationNEON))
+		_implementation = kImplementationNEON;
+
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
 	int16 *Cb_g_tab = &_colorTab[2 * 256];
@@ -192,6 +217,508 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+/**
+ * The parameters of the vector kernels, which compute the same values as the
+ * lookup tables: each channel is the luminance plus an offset taken from the
+ * chroma, clamped, scaled for kScaleITU and shifted into place.
+ */
+struct VectorFormat {
+	int rLoss, rShift;
+	int gLoss, gShift;
+	int bLoss, bShift;
+	uint32 alpha;
+	bool itu;
+
+	VectorFormat(const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale) :
+		rLoss(format.rLoss), rShift(format.rShift),
+		gLoss(format.gLoss), gShift(format.gShift),
+		bLoss(format.bLoss), bShift(format.bShift),
+		alpha((0xFF >> format.aLoss) << format.aShift),
+		itu(scale == YUVToRGBManager::kScaleITU) {
+	}
+};
+
+// The chroma offsets of the color table are trunc(k * (c - 128)). The kernels
+// compute them as |c - 128| * k in 16.16 fixed point, adding |c - 128| apart
+// for the factors above 1, and then restore the sign. These fractions give
+// the same result for all the chroma values.
+enum {
+	kCrRFraction = 26302, // 0.419 / 0.299 - 1
+	kCrGFraction = 46766, // 0.299 / 0.419
+	kCbGFraction = 22571, // 0.114 / 0.331
+	kCbBFraction = 50686, // 0.587 / 0.331 - 1
+
+	// (c - 16) * 255 / 219 is ((c - 16) * 2 * kITUScale) >> 16
+	kITUScale = 38155
+};
+
+struct VectorKernels {
+	/** Luminance columns converted by the YUV444 rows at once; YUV420 rows take twice as many */
+	int step;
+
+	void (*row444To16)(uint16 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &format);
+	void (*row444To32)(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &format);
+	void (*row420To16)(uint16 *dst0, uint16 *dst1, const byte *ySrc0, const byte *ySrc1, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &format);
+	void (*row420To32)(uint32 *dst0, uint32 *dst1, const byte *ySrc0, const byte *ySrc1, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &format);
+};
+
+#ifdef YUV_USE_SSE2
+
+static inline void chromaOffsetsSSE2(__m128i u, __m128i v, __m128i &rOffset, __m128i &gOffset, __m128i &bOffset) {
+	const __m128i bias = _mm_set1_epi16(128);
+	u = _mm_sub_epi16(u, bias);
+	v = _mm_sub_epi16(v, bias);
+
+	const __m128i uSign = _mm_srai_epi16(u, 15);
+	const __m128i vSign = _mm_srai_epi16(v, 15);
+	const __m128i uAbs = _mm_sub_epi16(_mm_xor_si128(u, uSign), uSign);
+	const __m128i vAbs = _mm_sub_epi16(_mm_xor_si128(v, vSign), vSign);
+
+	const __m128i r  = _mm_add_epi16(vAbs, _mm_mulhi_epu16(vAbs, _mm_set1_epi16((int16)kCrRFraction)));
+	const __m128i gv = _mm_mulhi_epu16(vAbs, _mm_set1_epi16((int16)kCrGFraction));
+	const __m128i gu = _mm_mulhi_epu16(uAbs, _mm_set1_epi16((int16)kCbGFraction));
+	const __m128i b  = _mm_add_epi16(uAbs, _mm_mulhi_epu16(uAbs, _mm_set1_epi16((int16)kCbBFraction)));
+
+	rOffset = _mm_sub_epi16(_mm_xor_si128(r, vSign), vSign);
+	bOffset = _mm_sub_epi16(_mm_xor_si128(b, uSign), uSign);
+	gOffset = _mm_add_epi16(_mm_sub_epi16(vSign, _mm_xor_si128(gv, vSign)), _mm_sub_epi16(uSign, _mm_xor_si128(gu, uSign)));
+}
+
+static inline __m128i channelSSE2(__m128i y, __m128i offset, bool itu) {
+	const __m128i c = _mm_add_epi16(y, offset);
+
+	if (itu) {
+		const __m128i clamped = _mm_min_epi16(_mm_max_epi16(c, _mm_set1_epi16(16)), _mm_set1_epi16(235));
+		const __m128i doubled = _mm_slli_epi16(_mm_sub_epi16(clamped, _mm_set1_epi16(16)), 1);
+		return _mm_mulhi_epu16(doubled, _mm_set1_epi16((int16)kITUScale));
+	}
+
+	return _mm_min_epi16(_mm_max_epi16(c, _mm_setzero_si128()), _mm_set1_epi16(255));
+}
+
+static inline void storePixelsSSE2(uint16 *dst, __m128i r, __m128i g, __m128i b, const VectorFormat &format) {
+	__m128i pixels = _mm_set1_epi16((int16)format.alpha);
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(r, _mm_cvtsi32_si128(format.rLoss)), _mm_cvtsi32_si128(format.rShift)));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(g, _mm_cvtsi32_si128(format.gLoss)), _mm_cvtsi32_si128(format.gShift)));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(b, _mm_cvtsi32_si128(format.bLoss)), _mm_cvtsi32_si128(format.bShift)));
+	_mm_storeu_si128((__m128i *)dst, pixels);
+}
+
+/** Place a channel into the low and high 16 bits of 32-bit pixels */
+static inline void packChannelSSE2(__m128i &low, __m128i &high, __m128i c, int loss, int shift) {
+	c = _mm_srl_epi16(c, _mm_cvtsi32_si128(loss));
+	low = _mm_or_si128(low, _mm_sll_epi16(c, _mm_cvtsi32_si128(shift)));
+	high = _mm_or_si128(high, _mm_srl_epi16(_mm_sll_epi16(c, _mm_cvtsi32_si128(MAX(shift - 16, 0))), _mm_cvtsi32_si128(MAX(16 - shift, 0))));
+}
+
+static inline void storePixelsSSE2(uint32 *dst, __m128i r, __m128i g, __m128i b, const VectorFormat &format) {
+	__m128i low = _mm_set1_epi16((int16)(format.alpha & 0xFFFF));
+	__m128i high = _mm_set1_epi16((int16)(format.alpha >> 16));
+	packChannelSSE2(low, high, r, format.rLoss, format.rShift);
+	packChannelSSE2(low, high, g, format.gLoss, format.gShift);
+	packChannelSSE2(low, high, b, format.bLoss, format.bShift);
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(low, high));
+	_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(low, high));
+}
+
+/** Convert eight pixels, given their luminance and chroma offsets as 16-bit values */
+template<typename PixelInt>
+static inline void convertPixelsSSE2(PixelInt *dst, __m128i y, __m128i rOffset, __m128i gOffset, __m128i bOffset, const VectorFormat &format) {
+	storePixelsSSE2(dst, channelSSE2(y, rOffset, format.itu), channelSSE2(y, gOffset, format.itu), channelSSE2(y, bOffset, format.itu), format);
+}
+
+template<typename PixelInt>
+static void convertRow444SSE2(PixelInt *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &rowFormat) {
+	const VectorFormat format = rowFormat;
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int x = 0; x < width; x += 8) {
+		const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero);
+		const __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(uSrc + x)), zero);
+		const __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(vSrc + x)), zero);
+
+		__m128i rOffset, gOffset, bOffset;
+		chromaOffsetsSSE2(u, v, rOffset, gOffset, bOffset);
+		convertPixelsSSE2(dst + x, y, rOffset, gOffset, bOffset, format);
+	}
+}
+
+template<typename PixelInt>
+static void convertRow420SSE2(PixelInt *dst0, PixelInt *dst1, const byte *ySrc0, const byte *ySrc1, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &rowFormat) {
+	const VectorFormat format = rowFormat;
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int x = 0; x < width; x += 16) {
+		const __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(uSrc + x / 2)), zero);
+		const __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(vSrc + x / 2)), zero);
+
+		__m128i rOffset, gOffset, bOffset;
+		chromaOffsetsSSE2(u, v, rOffset, gOffset, bOffset);
+
+		// Each chroma value covers two columns
+		const __m128i rLow = _mm_unpacklo_epi16(rOffset, rOffset), rHigh = _mm_unpackhi_epi16(rOffset, rOffset);
+		const __m128i gLow = _mm_unpacklo_epi16(gOffset, gOffset), gHigh = _mm_unpackhi_epi16(gOffset, gOffset);
+		const __m128i bLow = _mm_unpacklo_epi16(bOffset, bOffset), bHigh = _mm_unpackhi_epi16(bOffset, bOffset);
+
+		const __m128i y0 = _mm_loadu_si128((const __m128i *)(ySrc0 + x));
+		const __m128i y1 = _mm_loadu_si128((const __m128i *)(ySrc1 + x));
+
+		convertPixelsSSE2(dst0 + x,     _mm_unpacklo_epi8(y0, zero), rLow,  gLow,  bLow,  format);
+		convertPixelsSSE2(dst0 + x + 8, _mm_unpackhi_epi8(y0, zero), rHigh, gHigh, bHigh, format);
+		convertPixelsSSE2(dst1 + x,     _mm_unpacklo_epi8(y1, zero), rLow,  gLow,  bLow,  format);
+		convertPixelsSSE2(dst1 + x + 8, _mm_unpackhi_epi8(y1, zero), rHigh, gHigh, bHigh, format);
+	}
+}
+
+static const VectorKernels s_kernelsSSE2 = {
+	8,
+	convertRow444SSE2<uint16>, convertRow444SSE2<uint32>,
+	convertRow420SSE2<uint16>, convertRow420SSE2<uint32>
+};
+
+#endif
+
+#ifdef YUV_USE_AVX2
+
+YUV_TARGET_AVX2 static inline void chromaOffsetsAVX2(__m256i u, __m256i v, __m256i &rOffset, __m256i &gOffset, __m256i &bOffset) {
+	const __m256i bias = _mm256_set1_epi16(128);
+	u = _mm256_sub_epi16(u, bias);
+	v = _mm256_sub_epi16(v, bias);
+
+	const __m256i uSign = _mm256_srai_epi16(u, 15);
+	const __m256i vSign = _mm256_srai_epi16(v, 15);
+	const __m256i uAbs = _mm256_abs_epi16(u);
+	const __m256i vAbs = _mm256_abs_epi16(v);
+
+	const __m256i r  = _mm256_add_epi16(vAbs, _mm256_mulhi_epu16(vAbs, _mm256_set1_epi16((int16)kCrRFraction)));
+	const __m256i gv = _mm256_mulhi_epu16(vAbs, _mm256_set1_epi16((int16)kCrGFraction));
+	const __m256i gu = _mm256_mulhi_epu16(uAbs, _mm256_set1_epi16((int16)kCbGFraction));
+	const __m256i b  = _mm256_add_epi16(uAbs, _mm256_mulhi_epu16(uAbs, _mm256_set1_epi16((int16)kCbBFraction)));
+
+	rOffset = _mm256_sign_epi16(r, v);
+	bOffset = _mm256_sign_epi16(b, u);
+	gOffset = _mm256_add_epi16(_mm256_sub_epi16(vSign, _mm256_xor_si256(gv, vSign)), _mm256_sub_epi16(uSign, _mm256_xor_si256(gu, uSign)));
+}
+
+YUV_TARGET_AVX2 static inline __m256i channelAVX2(__m256i y, __m256i offset, bool itu) {
+	const __m256i c = _mm256_add_epi16(y, offset);
+
+	if (itu) {
+		const __m256i clamped = _mm256_min_epi16(_mm256_max_epi16(c, _mm256_set1_epi16(16)), _mm256_set1_epi16(235));
+		const __m256i doubled = _mm256_slli_epi16(_mm256_sub_epi16(clamped, _mm256_set1_epi16(16)), 1);
+		return _mm256_mulhi_epu16(doubled, _mm256_set1_epi16((int16)kITUScale));
+	}
+
+	return _mm256_min_epi16(_mm256_max_epi16(c, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+}
+
+YUV_TARGET_AVX2 static inline void storePixelsAVX2(uint16 *dst, __m256i r, __m256i g, __m256i b, const VectorFormat &format) {
+	__m256i pixels = _mm256_set1_epi16((int16)format.alpha);
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi16(_mm256_srl_epi16(r, _mm_cvtsi32_si128(format.rLoss)), _mm_cvtsi32_si128(format.rShift)));
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi16(_mm256_srl_epi16(g, _mm_cvtsi32_si128(format.gLoss)), _mm_cvtsi32_si128(format.gShift)));
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi16(_mm256_srl_epi16(b, _mm_cvtsi32_si128(format.bLoss)), _mm_cvtsi32_si128(format.bShift)));
+	_mm256_storeu_si256((__m256i *)dst, pixels);
+}
+
+YUV_TARGET_AVX2 static inline __m256i packPixelsAVX2(__m128i r, __m128i g, __m128i b, const VectorFormat &format) {
+	__m256i pixels = _mm256_set1_epi32(format.alpha);
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi32(_mm256_srl_epi32(_mm256_cvtepu16_epi32(r), _mm_cvtsi32_si128(format.rLoss)), _mm_cvtsi32_si128(format.rShift)));
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi32(_mm256_srl_epi32(_mm256_cvtepu16_epi32(g), _mm_cvtsi32_si128(format.gLoss)), _mm_cvtsi32_si128(format.gShift)));
+	pixels = _mm256_or_si256(pixels, _mm256_sll_epi32(_mm256_srl_epi32(_mm256_cvtepu16_epi32(b), _mm_cvtsi32_si128(format.bLoss)), _mm_cvtsi32_si128(format.bShift)));
+	return pixels;
+}
+
+YUV_TARGET_AVX2 static inline void storePixelsAVX2(uint32 *dst, __m256i r, __m256i g, __m256i b, const VectorFormat &format) {
+	_mm256_storeu_si256((__m256i *)dst, packPixelsAVX2(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b), format));
+	_mm256_storeu_si256((__m256i *)(dst + 8), packPixelsAVX2(_mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1), _mm256_extracti128_si256(b, 1), format));
+}
+
+/** Convert sixteen pixels, given their luminance and chroma offsets as 16-bit values */
+template<typename PixelInt>
+YUV_TARGET_AVX2 static inline void convertPixelsAVX2(PixelInt *dst, __m256i y, __m256i rOffset, __m256i gOffset, __m256i bOffset, const VectorFormat &format) {
+	storePixelsAVX2(dst, channelAVX2(y, rOffset, format.itu), channelAVX2(y, gOffset, format.itu), channelAVX2(y, bOffset, format.itu), format);
+}
+
+template<typename PixelInt>
+YUV_TARGET_AVX2 static void convertRow444AVX2(PixelInt *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &rowFormat) {
+	const VectorFormat format = rowFormat;
+	for (int x = 0; x < width; x += 16) {
+		const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + x)));
+		const __m256i u = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(uSrc + x)));
+		const __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(vSrc + x)));
+
+		__m256i rOffset, gOffset, bOffset;
+		chromaOffsetsAVX2(u, v, rOffset, gOffset, bOffset);
+		convertPixelsAVX2(dst + x, y, rOffset, gOffset, bOffset, format);
+	}
+}
+
+template<typename PixelInt>
+YUV_TARGET_AVX2 static void convertRow420AVX2(PixelInt *dst0, PixelInt *dst1, const byte *ySrc0, const byte *ySrc1, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &rowFormat) {
+	const VectorFormat format = rowFormat;
+	for (int x = 0; x < width; x += 32) {
+		const __m256i u = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(uSrc + x / 2)));
+		const __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(vSrc + x / 2)));
+
+		__m256i rOffset, gOffset, bOffset;
+		chromaOffsetsAVX2(u, v, rOffset, gOffset, bOffset);
+
+		// Each chroma value covers two columns. The unpacks work within
+		// 128-bit lanes, so first put the quarters in the order 0, 2, 1, 3.
+		rOffset = _mm256_permute4x64_epi64(rOffset, _MM_SHUFFLE(3, 1, 2, 0));
+		gOffset = _mm256_permute4x64_epi64(gOffset, _MM_SHUFFLE(3, 1, 2, 0));
+		bOffset = _mm256_permute4x64_epi64(bOffset, _MM_SHUFFLE(3, 1, 2, 0));
+		const __m256i rLow = _mm256_unpacklo_epi16(rOffset, rOffset), rHigh = _mm256_unpackhi_epi16(rOffset, rOffset);
+		const __m256i gLow = _mm256_unpacklo_epi16(gOffset, gOffset), gHigh = _mm256_unpackhi_epi16(gOffset, gOffset);
+		const __m256i bLow = _mm256_unpacklo_epi16(bOffset, bOffset), bHigh = _mm256_unpackhi_epi16(bOffset, bOffset);
+
+		convertPixelsAVX2(dst0 + x,      _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc0 + x))),      rLow,  gLow,  bLow,  format);
+		convertPixelsAVX2(dst0 + x + 16, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc0 + x + 16))), rHigh, gHigh, bHigh, format);
+		convertPixelsAVX2(dst1 + x,      _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc1 + x))),      rLow,  gLow,  bLow,  format);
+		convertPixelsAVX2(dst1 + x + 16, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc1 + x + 16))), rHigh, gHigh, bHigh, format);
+	}
+}
+
+static const VectorKernels s_kernelsAVX2 = {
+	16,
+	convertRow444AVX2<uint16>, convertRow444AVX2<uint32>,
+	convertRow420AVX2<uint16>, convertRow420AVX2<uint32>
+};
+
+#endif
+
+#ifdef YUV_USE_NEON
+
+static inline uint16x8_t mulhiNEON(uint16x8_t a, uint16 b) {
+	return vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(a), b), 16), vshrn_n_u32(vmull_n_u16(vget_high_u16(a), b), 16));
+}
+
+static inline void chromaOffsetsNEON(uint16x8_t u, uint16x8_t v, int16x8_t &rOffset, int16x8_t &gOffset, int16x8_t &bOffset) {
+	const int16x8_t uCentered = vsubq_s16(vreinterpretq_s16_u16(u), vdupq_n_s16(128));
+	const int16x8_t vCentered = vsubq_s16(vreinterpretq_s16_u16(v), vdupq_n_s16(128));
+	const uint16x8_t uAbs = vreinterpretq_u16_s16(vabsq_s16(uCentered));
+	const uint16x8_t vAbs = vreinterpretq_u16_s16(vabsq_s16(vCentered));
+	const uint16x8_t uNegative = vcltq_s16(uCentered, vdupq_n_s16(0));
+	const uint16x8_t vNegative = vcltq_s16(vCentered, vdupq_n_s16(0));
+
+	const int16x8_t r  = vreinterpretq_s16_u16(vaddq_u16(vAbs, mulhiNEON(vAbs, kCrRFraction)));
+	const int16x8_t gv = vreinterpretq_s16_u16(mulhiNEON(vAbs, kCrGFraction));
+	const int16x8_t gu = vreinterpretq_s16_u16(mulhiNEON(uAbs, kCbGFraction));
+	const int16x8_t b  = vreinterpretq_s16_u16(vaddq_u16(uAbs, mulhiNEON(uAbs, kCbBFraction)));
+
+	rOffset = vbslq_s16(vNegative, vnegq_s16(r), r);
+	bOffset = vbslq_s16(uNegative, vnegq_s16(b), b);
+	gOffset = vsubq_s16(vbslq_s16(vNegative, gv, vnegq_s16(gv)), vbslq_s16(uNegative, vnegq_s16(gu), gu));
+}
+
+static inline uint16x8_t channelNEON(uint16x8_t y, int16x8_t offset, bool itu) {
+	const int16x8_t c = vaddq_s16(vreinterpretq_s16_u16(y), offset);
+
+	if (itu) {
+		const int16x8_t clamped = vminq_s16(vmaxq_s16(c, vdupq_n_s16(16)), vdupq_n_s16(235));
+		const uint16x8_t doubled = vshlq_n_u16(vreinterpretq_u16_s16(vsubq_s16(clamped, vdupq_n_s16(16))), 1);
+		return mulhiNEON(doubled, kITUScale);
+	}
+
+	return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(c, vdupq_n_s16(0)), vdupq_n_s16(255)));
+}
+
+static inline uint16x8_t shiftNEON(uint16x8_t c, int loss, int shift) {
+	return vshlq_u16(vshlq_u16(c, vdupq_n_s16(-loss)), vdupq_n_s16(shift));
+}
+
+static inline uint32x4_t shiftNEON(uint16x4_t c, int loss, int shift) {
+	return vshlq_u32(vshlq_u32(vmovl_u16(c), vdupq_n_s32(-loss)), vdupq_n_s32(shift));
+}
+
+static inline void storePixelsNEON(uint16 *dst, uint16x8_t r, uint16x8_t g, uint16x8_t b, const VectorFormat &format) {
+	uint16x8_t pixels = vdupq_n_u16(format.alpha);
+	pixels = vorrq_u16(pixels, shiftNEON(r, format.rLoss, format.rShift));
+	pixels = vorrq_u16(pixels, shiftNEON(g, format.gLoss, format.gShift));
+	pixels = vorrq_u16(pixels, shiftNEON(b, format.bLoss, format.bShift));
+	vst1q_u16(dst, pixels);
+}
+
+static inline uint32x4_t packPixelsNEON(uint16x4_t r, uint16x4_t g, uint16x4_t b, const VectorFormat &format) {
+	uint32x4_t pixels = vdupq_n_u32(format.alpha);
+	pixels = vorrq_u32(pixels, shiftNEON(r, format.rLoss, format.rShift));
+	pixels = vorrq_u32(pixels, shiftNEON(g, format.gLoss, format.gShift));
+	pixels = vorrq_u32(pixels, shiftNEON(b, format.bLoss, format.bShift));
+	return pixels;
+}
+
+static inline void storePixelsNEON(uint32 *dst, uint16x8_t r, uint16x8_t g, uint16x8_t b, const VectorFormat &format) {
+	vst1q_u32(dst, packPixelsNEON(vget_low_u16(r), vget_low_u16(g), vget_low_u16(b), format));
+	vst1q_u32(dst + 4, packPixelsNEON(vget_high_u16(r), vget_high_u16(g), vget_high_u16(b), format));
+}
+
+/** Convert eight pixels, given their luminance and chroma offsets as 16-bit values */
+template<typename PixelInt>
+static inline void convertPixelsNEON(PixelInt *dst, uint16x8_t y, int16x8_t rOffset, int16x8_t gOffset, int16x8_t bOffset, const VectorFormat &format) {
+	storePixelsNEON(dst, channelNEON(y, rOffset, format.itu), channelNEON(y, gOffset, format.itu), channelNEON(y, bOffset, format.itu), format);
+}
+
+template<typename PixelInt>
+static void convertRow444NEON(PixelInt *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &rowFormat) {
+	const VectorFormat format = rowFormat;
+	for (int x = 0; x < width; x += 8) {
+		int16x8_t rOffset, gOffset, bOffset;
+		chromaOffsetsNEON(vmovl_u8(vld1_u8(uSrc + x)), vmovl_u8(vld1_u8(vSrc + x)), rOffset, gOffset, bOffset);
+		convertPixelsNEON(dst + x, vmovl_u8(vld1_u8(ySrc + x)), rOffset, gOffset, bOffset, format);
+	}
+}
+
+template<typename PixelInt>
+static void convertRow420NEON(PixelInt *dst0, PixelInt *dst1, const byte *ySrc0, const byte *ySrc1, const byte *uSrc, const byte *vSrc, int width, const VectorFormat &rowFormat) {
+	const VectorFormat format = rowFormat;
+	for (int x = 0; x < width; x += 16) {
+		int16x8_t rOffset, gOffset, bOffset;
+		chromaOffsetsNEON(vmovl_u8(vld1_u8(uSrc + x / 2)), vmovl_u8(vld1_u8(vSrc + x / 2)), rOffset, gOffset, bOffset);
+
+		// Each chroma value covers two columns
+		const int16x8x2_t r = vzipq_s16(rOffset, rOffset);
+		const int16x8x2_t g = vzipq_s16(gOffset, gOffset);
+		const int16x8x2_t b = vzipq_s16(bOffset, bOffset);
+
+		const uint8x16_t y0 = vld1q_u8(ySrc0 + x);
+		const uint8x16_t y1 = vld1q_u8(ySrc1 + x);
+
+		convertPixelsNEON(dst0 + x,     vmovl_u8(vget_low_u8(y0)),  r.val[0], g.val[0], b.val[0], format);
+		convertPixelsNEON(dst0 + x + 8, vmovl_u8(vget_high_u8(y0)), r.val[1], g.val[1], b.val[1], format);
+		convertPixelsNEON(dst1 + x,     vmovl_u8(vget_low_u8(y1)),  r.val[0], g.val[0], b.val[0], format);
+		convertPixelsNEON(dst1 + x + 8, vmovl_u8(vget_high_u8(y1)), r.val[1], g.val[1], b.val[1], format);
+	}
+}
+
+static const VectorKernels s_kernelsNEON = {
+	8,
+	convertRow444NEON<uint16>, convertRow444NEON<uint32>,
+	convertRow420NEON<uint16>, convertRow420NEON<uint32>
+};
+
+#endif
+
+static const VectorKernels *getVectorKernels(YUVToRGBManager::Implementation implementation) {
+	switch (implementation) {
+#ifdef YUV_USE_SSE2
+	case YUVToRGBManager::kImplementationSSE2:
+		return &s_kernelsSSE2;
+#endif
+#ifdef YUV_USE_AVX2
+	case YUVToRGBManager::kImplementationAVX2:
+		return __builtin_cpu_supports("avx2") ? &s_kernelsAVX2 : 0;
+#endif
+#ifdef YUV_USE_NEON
+	case YUVToRGBManager::kImplementationNEON:
+		return &s_kernelsNEON;
+#endif
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Convert the columns of a YUV444 image which fill whole vectors.
+ *
+ * @return the number of columns converted
+ */
+static int convertYUV444Vector(const VectorKernels &kernels, byte *dstPtr, int dstPitch, const VectorFormat &format, int bytesPerPixel, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const int width = yWidth - yWidth % kernels.step;
+
+	for (int h = 0; h < yHeight; h++) {
+		if (bytesPerPixel == 2)
+			kernels.row444To16((uint16 *)dstPtr, ySrc, uSrc, vSrc, width, format);
+		else
+			kernels.row444To32((uint32 *)dstPtr, ySrc, uSrc, vSrc, width, format);
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	return width;
+}
+
+/**
+ * Convert the columns of a YUV420 image which fill whole vectors.
+ *
+ * @return the number of luminance columns converted
+ */
+static int convertYUV420Vector(const VectorKernels &kernels, byte *dstPtr, int dstPitch, const VectorFormat &format, int bytesPerPixel, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const int width = yWidth - yWidth % (kernels.step * 2);
+
+	for (int h = 0; h < yHeight; h += 2) {
+		if (bytesPerPixel == 2)
+			kernels.row420To16((uint16 *)dstPtr, (uint16 *)(dstPtr + dstPitch), ySrc, ySrc + yPitch, uSrc, vSrc, width, format);
+		else
+			kernels.row420To32((uint32 *)dstPtr, (uint32 *)(dstPtr + dstPitch), ySrc, ySrc + yPitch, uSrc, vSrc, width, format);
+
+		dstPtr += dstPitch * 2;
+		ySrc += yPitch * 2;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	return width;
+}
+
+/**
+ * Convert the columns of a YUV410 image which fill whole vectors. The chroma
+ * is interpolated into rows of YUV444 data first, a chunk at a time.
+ *
+ * @return the number of luminance columns converted
+ */
+static int convertYUV410Vector(const VectorKernels &kernels, byte *dstPtr, int dstPitch, const VectorFormat &format, int bytesPerPixel, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	static const int kChunkSize = 256;
+	byte uRow[kChunkSize], vRow[kChunkSize];
+
+	const int width = yWidth - yWidth % kernels.step;
+
+	for (int y = 0; y < yHeight; y++) {
+		const int yDiff = y & 3;
+		const byte *uLine = uSrc + (y >> 2) * uvPitch;
+		const byte *vLine = vSrc + (y >> 2) * uvPitch;
+
+		for (int start = 0; start < width; start += kChunkSize) {
+			const int count = MIN(kChunkSize, width - start);
+
+			for (int i = 0; i < count; i++) {
+				const int x = start + i;
+				const int xDiff = x & 3;
+				const int index = x >> 2;
+
+				uRow[i] = (uLine[index] * (4 - xDiff) * (4 - yDiff) + uLine[index + 1] * xDiff * (4 - yDiff) +
+						uLine[index + uvPitch] * yDiff * (4 - xDiff) + uLine[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+				vRow[i] = (vLine[index] * (4 - xDiff) * (4 - yDiff) + vLine[index + 1] * xDiff * (4 - yDiff) +
+						vLine[index + uvPitch] * yDiff * (4 - xDiff) + vLine[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+			}
+
+			if (bytesPerPixel == 2)
+				kernels.row444To16((uint16 *)dstPtr + start, ySrc + start, uRow, vRow, count, format);
+			else
+				kernels.row444To32((uint32 *)dstPtr + start, ySrc + start, uRow, vRow, count, format);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+	}
+
+	return width;
+}
+
+bool YUVToRGBManager::isImplementationSupported(Implementation implementation) {
+	return implementation == kImplementationTable || getVectorKernels(implementation);
+}
+
+bool YUVToRGBManager::setImplementation(Implementation implementation) {
+	if (!isImplementationSupported(implementation))
+		return false;
+
+	_implementation = implementation;
+	return true;
+}
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -233,13 +760,30 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 
+	byte *dstPtr = (byte *)dst->getPixels();
+
+	// Convert what fills whole vectors with the vector kernels, and leave the
+	// remaining columns to the lookup tables
+	const VectorKernels *kernels = getVectorKernels(_implementation);
+	if (kernels) {
+		const int done = convertYUV444Vector(*kernels, dstPtr, dst->pitch, VectorFormat(dst->format, scale), dst->format.bytesPerPixel, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		if (done == yWidth)
+			return;
+
+		dstPtr += done * dst->format.bytesPerPixel;
+		ySrc += done;
+		uSrc += done;
+		vSrc += done;
+		yWidth -= done;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
@@ -274,7 +818,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
@@ -289,13 +833,30 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
+	byte *dstPtr = (byte *)dst->getPixels();
+
+	// Convert what fills whole vectors with the vector kernels, and leave the
+	// remaining columns to the lookup tables
+	const VectorKernels *kernels = getVectorKernels(_implementation);
+	if (kernels) {
+		const int done = convertYUV420Vector(*kernels, dstPtr, dst->pitch, VectorFormat(dst->format, scale), dst->format.bytesPerPixel, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		if (done == yWidth)
+			return;
+
+		dstPtr += done * dst->format.bytesPerPixel;
+		ySrc += done;
+		uSrc += done / 2;
+		vSrc += done / 2;
+		yWidth -= done;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -374,13 +935,30 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 3) == 0);
 	assert((yHeight & 3) == 0);
 
+	byte *dstPtr = (byte *)dst->getPixels();
+
+	// Convert what fills whole vectors with the vector kernels, and leave the
+	// remaining columns to the lookup tables
+	const VectorKernels *kernels = getVectorKernels(_implementation);
+	if (kernels) {
+		const int done = convertYUV410Vector(*kernels, dstPtr, dst->pitch, VectorFormat(dst->format, scale), dst->format.bytesPerPixel, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		if (done == yWidth)
+			return;
+
+		dstPtr += done * dst->format.bytesPerPixel;
+		ySrc += done;
+		uSrc += done / 4;
+		vSrc += done / 4;
+		yWidth -= done;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV410ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV410ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
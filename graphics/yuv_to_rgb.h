@@ -105,6 +105,39 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Build the lookup tables for converting to the given format ahead of
+	 * time. The conversions may then run on a worker thread, as long as no
+	 * other thread converts to another format or scale in the meantime.
+	 *
+	 * @param format  the format of the destination surfaces
+	 * @param scale   the scale of the luminance values
+	 */
+	void prepare(const Graphics::PixelFormat &format, LuminanceScale scale) { getLookup(format, scale); }
+
+	/** The implementations of the conversions */
+	enum Implementation {
+		kImplementationTable, /** Lookup tables, one pixel at a time */
+		kImplementationSSE2,
+		kImplementationAVX2,
+		kImplementationNEON
+	};
+
+	/** Whether both the build and the CPU support an implementation. */
+	static bool isImplementationSupported(Implementation implementation);
+
+	/**
+	 * Select the implementation of the conversions. The fastest supported
+	 * one is used by default. They all produce the same output, so this is
+	 * mostly useful to test and benchmark them.
+	 *
+	 * @return whether the implementation is supported
+	 */
+	bool setImplementation(Implementation implementation);
+
+	/** Get the implementation of the conversions. */
+	Implementation getImplementation() const { return _implementation; }
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -114,6 +147,7 @@ private:
 
 	YUVToRGBLookup *_lookup;
 	int16 _colorTab[4 * 256]; // 2048 bytes
+	Implementation _implementation;
 };
 
 } // End of namespace Graphics
@@ -25,7 +25,9 @@
 
 #include "common/debug.h"
 #include "common/debug-channels.h"
+#include "common/memory-stats.h"
 #include "common/system.h"
+#include "common/timer.h"
 
 #ifndef DISABLE_MD5
 #include "common/md5.h"
@@ -78,6 +80,9 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+
+	registerCmd("timers",			WRAP_METHOD(Debugger, cmdTimers));
+	registerCmd("memstats",			WRAP_METHOD(Debugger, cmdMemStats));
 }
 
 Debugger::~Debugger() {
@@ -781,6 +786,55 @@ bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmdTimers(int argc, const char **argv) {
+	const Common::TimerManager::TimerInfoList timers = g_system->getTimerManager()->listTimers();
+
+	debugPrintf("Timers:\n");
+	debugPrintf("-------\n");
+	if (timers.empty()) {
+		debugPrintf("No timer statistics available\n");
+		return true;
+	}
+	debugPrintf("%-24s %10s %10s %10s %8s\n", "id", "interval", "fired", "overruns", "max late");
+	for (Common::TimerManager::TimerInfoList::const_iterator i = timers.begin(); i != timers.end(); ++i) {
+		debugPrintf("%-24s %8dus %10u %10u %6ums\n", i->id.c_str(), i->interval,
+				i->fireCount, i->overrunCount, i->maxLateness);
+	}
+	debugPrintf("\n");
+	return true;
+}
+
+bool Debugger::cmdMemStats(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Usage: %s [<file>]\n", argv[0]);
+		debugPrintf("Prints the memory held by each subsystem, or writes it to a file.\n");
+		return true;
+	}
+
+	if (argc == 2) {
+		if (Common::MemoryStats::dumpToFile(argv[1]))
+			debugPrintf("Memory statistics written to '%s'\n", argv[1]);
+		else
+			debugPrintf("Cannot write to '%s'\n", argv[1]);
+		return true;
+	}
+
+	const Common::MemoryStats::InfoList infos = Common::MemoryStats::list();
+	if (infos.empty()) {
+		debugPrintf("No memory statistics available\n");
+		return true;
+	}
+
+	debugPrintf("%-24s %10s %10s %10s %10s\n", "name", "live KB", "peak KB", "allocs", "frees");
+	for (Common::MemoryStats::InfoList::const_iterator i = infos.begin(); i != infos.end(); ++i) {
+		debugPrintf("%-24s %10lu %10lu %10u %10u\n", i->name.c_str(),
+				(unsigned long)(i->liveSize / 1024), (unsigned long)(i->peakSize / 1024),
+				i->allocations, i->frees);
+	}
+	debugPrintf("\n");
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
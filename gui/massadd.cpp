@@ -20,6 +20,7 @@
  *
  */
 
+#include "engines/gameScanner.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
@@ -62,15 +63,14 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
 	_dirsScanned(0),
 	_oldGamesCount(0),
-	_dirTotal(0),
 	_okButton(0),
 	_dirProgressText(0),
 	_gameProgressText(0) {
 
 	StringArray l;
 
-	// The dir we start our scan at
-	_scanStack.push(startDir);
+	// Start scanning the directory tree in the background
+	_scanner = new GameScanner(startDir);
 
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
@@ -119,6 +119,10 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	}
 }
 
+MassAddDialog::~MassAddDialog() {
+	delete _scanner;
+}
+
 struct GameTargetLess {
 	bool operator()(const GameDescriptor &x, const GameDescriptor &y) const {
 		return x.preferredtarget().compareToIgnoreCase(y.preferredtarget()) < 0;
@@ -172,20 +176,15 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 }
 
 void MassAddDialog::handleTickle() {
-	if (_scanStack.empty())
+	if (!_scanner)
 		return;	// We have finished scanning
 
 	uint32 t = g_system->getMillis();
 
-	// Perform a breadth-first scan of the filesystem.
-	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
-
-		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
-			continue;
-		}
-
+	// Run the detector on the directories listed by the scanner threads
+	Common::FSNode dir;
+	Common::FSList files;
+	while ((g_system->getMillis() - t) < kMaxScanTime && _scanner->nextDirectory(dir, files)) {
 		// Run the detector on the dir
 		GameList candidates(EngineMan.detectGames(files));
 
@@ -231,28 +230,24 @@ void MassAddDialog::handleTickle() {
 		}
 
 
-		// Recurse into all subdirs
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			if (file->isDirectory()) {
-				_scanStack.push(*file);
-
-				_dirTotal++;
-			}
-		}
-
 		_dirsScanned++;
 
 #if defined(USE_TASKBAR)
-		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
+		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _scanner->getDirectoryCount());
 		g_system->getTaskbarManager()->setCount(_games.size());
 #endif
 	}
 
+	if (_scanner->isDone()) {
+		delete _scanner;
+		_scanner = 0;
+	}
+
 
 	// Update the dialog
 	Common::String buf;
 
-	if (_scanStack.empty()) {
+	if (!_scanner) {
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -26,9 +26,10 @@
 #include "gui/dialog.h"
 #include "common/fs.h"
 #include "common/hashmap.h"
-#include "common/stack.h"
 #include "common/str.h"
 
+class GameScanner;
+
 namespace GUI {
 
 class StaticTextWidget;
@@ -37,6 +38,7 @@ class MassAddDialog : public Dialog {
 	typedef Common::Array<Common::String> StringArray;
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog();
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data);
@@ -49,7 +51,7 @@ public:
 	}
 
 private:
-	Common::Stack<Common::FSNode>  _scanStack;
+	GameScanner *_scanner;
 	GameList _games;
 
 	/**
@@ -61,7 +63,6 @@ private:
 
 	int _dirsScanned;
 	int _oldGamesCount;
-	int _dirTotal;
 
 	Widget *_okButton;
 	StaticTextWidget *_dirProgressText;
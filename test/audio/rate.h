@@ -0,0 +1,276 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/config-manager.h"
+#include "common/scummsys.h"
+
+#include "../benchmark.h"
+
+/**
+ * An endless (or, if a length is given, finite) stream of constant samples.
+ */
+class ConstantStream : public Audio::AudioStream {
+public:
+	ConstantStream(int rate, int16 left, int16 right, bool stereo, int length = -1)
+		: _rate(rate), _left(left), _right(right), _stereo(stereo), _remaining(length) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		int count = numSamples;
+		if (_remaining >= 0) {
+			count = MIN(count, _remaining * (_stereo ? 2 : 1));
+			_remaining -= count / (_stereo ? 2 : 1);
+		}
+		for (int i = 0; i < count; i++)
+			buffer[i] = (_stereo && (i & 1)) ? _right : _left;
+		return count;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return _remaining == 0; }
+
+private:
+	int _rate;
+	int16 _left, _right;
+	bool _stereo;
+	int _remaining;
+};
+
+/**
+ * A stream of pseudo random samples, with a bias towards the extremes.
+ */
+class NoiseStream : public Audio::AudioStream {
+public:
+	NoiseStream(int rate, bool stereo, uint32 seed) : _rate(rate), _stereo(stereo), _seed(seed) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; i++)
+			buffer[i] = next();
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+	int16 next() {
+		_seed = _seed * 1103515245 + 12345;
+		switch ((_seed >> 28) & 7) {
+		case 0:
+			return -32768;
+		case 1:
+			return 32767;
+		default:
+			return (int16)(_seed >> 8);
+		}
+	}
+
+private:
+	int _rate;
+	bool _stereo;
+	uint32 _seed;
+};
+
+/**
+ * Scalar reference of the copy and linear converters, mixing sample by
+ * sample with clampedAdd().
+ */
+static void mixReference(int16 *obuf, int16 out0, int16 out1, bool reverseStereo, int vol_l, int vol_r) {
+	Audio::clampedAdd(obuf[reverseStereo    ], (out0 * vol_l) / Audio::Mixer::kMaxMixerVolume);
+	Audio::clampedAdd(obuf[reverseStereo ^ 1], (out1 * vol_r) / Audio::Mixer::kMaxMixerVolume);
+}
+
+static void copyReference(NoiseStream &input, int16 *obuf, int osamp, bool stereo, bool reverseStereo, int vol_l, int vol_r) {
+	for (int i = 0; i < osamp; i++) {
+		const int16 out0 = input.next();
+		const int16 out1 = stereo ? input.next() : out0;
+		mixReference(obuf + i * 2, out0, out1, reverseStereo, vol_l, vol_r);
+	}
+}
+
+struct LinearReference {
+	int32 opos, oposInc;
+	int16 ilast0, ilast1, icur0, icur1;
+
+	LinearReference(int inrate, int outrate) : opos(1 << 15), oposInc((inrate << 15) / outrate),
+		ilast0(0), ilast1(0), icur0(0), icur1(0) {}
+
+	void flow(NoiseStream &input, int16 *obuf, int osamp, bool stereo, bool reverseStereo, int vol_l, int vol_r) {
+		for (int i = 0; i < osamp; i++) {
+			while (opos >= (1 << 15)) {
+				ilast0 = icur0;
+				icur0 = input.next();
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = input.next();
+				}
+				opos -= 1 << 15;
+			}
+
+			const int16 out0 = (int16)(ilast0 + (((icur0 - ilast0) * opos + (1 << 14)) >> 15));
+			const int16 out1 = stereo ? (int16)(ilast1 + (((icur1 - ilast1) * opos + (1 << 14)) >> 15)) : out0;
+			mixReference(obuf + i * 2, out0, out1, reverseStereo, vol_l, vol_r);
+
+			opos += oposInc;
+		}
+	}
+};
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_mixing_parity() {
+		static const int volumes[][2] = { { 256, 256 }, { 0, 256 }, { 255, 1 }, { 127, 200 }, { 256, 511 } };
+		static const int lengths[] = { 1, 3, 4, 7, 8, 9, 255, 1001 };
+		static const int rates[][2] = { { 44100, 44100 }, { 22050, 44100 }, { 44100, 48000 }, { 48000, 22050 } };
+
+		int16 *output = new int16[1001 * 2];
+		int16 *expected = new int16[1001 * 2];
+
+		for (int mode = 0; mode < 3; mode++) {
+			const bool stereo = (mode != 0);
+			const bool reverseStereo = (mode == 2);
+
+			for (int r = 0; r < ARRAYSIZE(rates); r++) {
+				for (int v = 0; v < ARRAYSIZE(volumes); v++) {
+					ConfMan.set("resampler", "linear");
+					Audio::RateConverter *converter = Audio::makeRateConverter(rates[r][0], rates[r][1], stereo, reverseStereo);
+					ConfMan.removeKey("resampler", Common::ConfigManager::kApplicationDomain);
+
+					NoiseStream input(rates[r][0], stereo, r * 16 + v);
+					NoiseStream referenceInput(rates[r][0], stereo, r * 16 + v);
+					LinearReference reference(rates[r][0], rates[r][1]);
+					NoiseStream outputNoise(0, true, 1234);
+
+					for (int l = 0; l < ARRAYSIZE(lengths); l++) {
+						const int osamp = lengths[l];
+						for (int i = 0; i < osamp * 2; i++)
+							output[i] = expected[i] = outputNoise.next();
+
+						TS_ASSERT_EQUALS(converter->flow(input, output, osamp, volumes[v][0], volumes[v][1]), osamp);
+						if (rates[r][0] == rates[r][1])
+							copyReference(referenceInput, expected, osamp, stereo, reverseStereo, volumes[v][0], volumes[v][1]);
+						else
+							reference.flow(referenceInput, expected, osamp, stereo, reverseStereo, volumes[v][0], volumes[v][1]);
+
+						TS_ASSERT_SAME_DATA(output, expected, osamp * 2 * sizeof(int16));
+					}
+
+					delete converter;
+				}
+			}
+		}
+
+		delete[] output;
+		delete[] expected;
+	}
+
+	void test_sinc_dc_gain() {
+		static const int rates[][2] = { { 22050, 44100 }, { 11025, 48000 }, { 48000, 22050 }, { 32000, 44100 } };
+
+		for (int r = 0; r < ARRAYSIZE(rates); r++) {
+			Audio::RateConverter *converter = Audio::makeSincRateConverter(rates[r][0], rates[r][1], false);
+			TS_ASSERT(converter != 0);
+
+			ConstantStream input(rates[r][0], 10000, 10000, false);
+			int16 output[2048 * 2];
+			memset(output, 0, sizeof(output));
+			TS_ASSERT_EQUALS(converter->flow(input, output, 2048, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 2048);
+
+			// Past the filter startup, the output must follow the input
+			for (int i = 512 * 2; i < 2048 * 2; i++)
+				TS_ASSERT_DELTA(output[i], 10000, 2);
+
+			delete converter;
+		}
+	}
+
+	void test_sinc_stereo() {
+		for (int reverse = 0; reverse < 2; reverse++) {
+			Audio::RateConverter *converter = Audio::makeSincRateConverter(22050, 44100, true, reverse);
+			TS_ASSERT(converter != 0);
+
+			ConstantStream input(22050, 8000, -4000, true);
+			int16 output[1024 * 2];
+			memset(output, 0, sizeof(output));
+			TS_ASSERT_EQUALS(converter->flow(input, output, 1024, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume / 2), 1024);
+
+			// Volumes apply to the input channels, before swapping
+			const int16 left = reverse ? -2000 : 8000;
+			const int16 right = reverse ? 8000 : -2000;
+			TS_ASSERT_DELTA(output[1000 * 2 + 0], left, 2);
+			TS_ASSERT_DELTA(output[1000 * 2 + 1], right, 2);
+
+			delete converter;
+		}
+	}
+
+	void test_sinc_output_length() {
+		Audio::RateConverter *converter = Audio::makeSincRateConverter(11025, 44100, false);
+
+		ConstantStream input(11025, 1000, 1000, false, 11025);
+		int16 output[512 * 2];
+		int total = 0, count;
+		do {
+			memset(output, 0, sizeof(output));
+			count = converter->flow(input, output, 512, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			total += count;
+		} while (count > 0);
+
+		// The filter delay holds back a few input samples at the end
+		TS_ASSERT_LESS_THAN_EQUALS(total, 44100);
+		TS_ASSERT_LESS_THAN(44100 - 32 * 4, total);
+
+		delete converter;
+	}
+
+	void test_sinc_fallback() {
+		// Too many phases for the sinc converter
+		TS_ASSERT(Audio::makeSincRateConverter(44100, 44101, false) == 0);
+
+		ConfMan.set("resampler", "sinc");
+		Audio::RateConverter *converter = Audio::makeRateConverter(44100, 44101, false);
+		TS_ASSERT(converter != 0);
+		delete converter;
+		ConfMan.removeKey("resampler", Common::ConfigManager::kApplicationDomain);
+	}
+
+	void test_benchmark_converters() {
+		if (!Benchmark::enabled())
+			return;
+
+		static const int rates[][2] = {
+			{ 11025, 44100 }, { 22050, 44100 }, { 32000, 44100 }, { 44100, 44100 },
+			{ 11025, 48000 }, { 22050, 48000 }, { 32000, 48000 }, { 44100, 48000 }
+		};
+		static const char *const resamplers[] = { "default", "linear", "sinc" };
+		static const int kSamples = 1 << 20;
+		int16 *output = new int16[4096 * 2];
+
+		for (int s = 0; s < 2; s++) {
+			for (int r = 0; r < ARRAYSIZE(rates); r++) {
+				for (int m = 0; m < ARRAYSIZE(resamplers); m++) {
+					ConfMan.set("resampler", resamplers[m]);
+					Audio::RateConverter *converter = Audio::makeRateConverter(rates[r][0], rates[r][1], s != 0);
+					ConstantStream input(rates[r][0], 1000, -1000, s != 0);
+
+					const double start = Benchmark::seconds();
+					for (int done = 0; done < kSamples; done += 4096)
+						converter->flow(input, output, 4096, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+					const double elapsed = Benchmark::seconds() - start;
+
+					Common::String name = Common::String::format("rate %s %s %d -> %d", resamplers[m], s ? "stereo" : "mono", rates[r][0], rates[r][1]);
+					Benchmark::report(name.c_str(), kSamples, "sample", elapsed);
+
+					delete converter;
+				}
+			}
+		}
+
+		ConfMan.removeKey("resampler", Common::ConfigManager::kApplicationDomain);
+		delete[] output;
+	}
+};
@@ -0,0 +1,223 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/fs/abstract-fs.h"
+#include "backends/fs/fs-factory.h"
+#include "backends/fs/stdiostream.h"
+#include "backends/saves/default/default-saves.h"
+#include "common/system.h"
+#include "graphics/pixelformat.h"
+
+/**
+ * Plain files, and a single directory which holds the savefiles. Creating
+ * a file fails while failWrites is set.
+ */
+class SaveTestFSNode : public AbstractFSNode {
+public:
+	SaveTestFSNode(const Common::String &path, bool &failWrites)
+		: _path(path), _failWrites(failWrites) {}
+
+	virtual bool exists() const {
+		if (isDirectory())
+			return true;
+
+		Common::SeekableReadStream *file = StdioStream::makeFromPath(_path, false);
+		delete file;
+		return file != 0;
+	}
+
+	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const { return isDirectory(); }
+	virtual Common::String getName() const { return lastPathComponent(_path, '/'); }
+	virtual Common::String getPath() const { return _path; }
+	virtual bool isDirectory() const { return _path == SAVE_DIR; }
+	virtual bool isReadable() const { return true; }
+	virtual bool isWritable() const { return true; }
+
+	virtual Common::SeekableReadStream *createReadStream() {
+		return StdioStream::makeFromPath(_path, false);
+	}
+
+	virtual Common::WriteStream *createWriteStream() {
+		if (_failWrites)
+			return 0;
+		return StdioStream::makeFromPath(_path, true);
+	}
+
+	virtual bool create(bool isDirectoryFlag) { return false; }
+
+	static const char *const SAVE_DIR;
+
+protected:
+	virtual AbstractFSNode *getChild(const Common::String &name) const {
+		return new SaveTestFSNode(_path + "/" + name, _failWrites);
+	}
+
+	virtual AbstractFSNode *getParent() const { return new SaveTestFSNode(SAVE_DIR, _failWrites); }
+
+private:
+	Common::String _path;
+	bool &_failWrites;
+};
+
+const char *const SaveTestFSNode::SAVE_DIR = ".";
+
+class SaveTestFSFactory : public FilesystemFactory {
+public:
+	SaveTestFSFactory() : failWrites(false) {}
+
+	virtual AbstractFSNode *makeCurrentDirectoryFileNode() const { return makeFileNodePath(SaveTestFSNode::SAVE_DIR); }
+	virtual AbstractFSNode *makeFileNodePath(const Common::String &path) const { return new SaveTestFSNode(path, failWrites); }
+	virtual AbstractFSNode *makeRootFileNode() const { return makeFileNodePath(SaveTestFSNode::SAVE_DIR); }
+
+	mutable bool failWrites;
+};
+
+/**
+ * Just enough of a backend for the savefile manager: a filesystem, and
+ * no threads, so that every file is written right away.
+ */
+class SaveTestSystem : public OSystem {
+public:
+	SaveTestSystem(SaveTestFSFactory *fsFactory) { _fsFactory = fsFactory; }
+
+	virtual const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return false; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat(); }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(void *buf, int pitch) {}
+	virtual void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) {}
+	virtual uint32 getMillis(bool skipRecord) { return 0; }
+	virtual void delayMillis(uint msecs) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+	virtual MutexRef createMutex() { return 0; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void displayActivityIconOnOSD(const Graphics::Surface *icon) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) {}
+};
+
+class SaveFileWriterTestSuite : public CxxTest::TestSuite {
+	SaveTestFSFactory *_fsFactory;
+	SaveTestSystem *_system;
+	DefaultSaveFileManager *_saveFileMan;
+
+	static const char *const SAVE_NAME;
+
+	bool save(const char *text, bool compress, bool autosave) {
+		Common::OutSaveFile *out;
+		if (autosave)
+			out = _saveFileMan->openForAutosaving(SAVE_NAME, compress);
+		else
+			out = _saveFileMan->openForSaving(SAVE_NAME, compress);
+		TS_ASSERT(out);
+		if (!out)
+			return false;
+
+		out->writeString(text);
+		out->finalize();
+		const bool success = !out->err();
+		delete out;
+		return success;
+	}
+
+	Common::String load() {
+		Common::InSaveFile *in = _saveFileMan->openForLoading(SAVE_NAME);
+		if (!in)
+			return "<missing>";
+
+		Common::String text;
+		while (true) {
+			const byte c = in->readByte();
+			if (in->eos() || in->err())
+				break;
+			text += (char)c;
+		}
+		delete in;
+		return text;
+	}
+
+	static bool fileExists(const Common::String &name) {
+		return Common::FSNode(Common::String(SaveTestFSNode::SAVE_DIR) + "/" + name).exists();
+	}
+
+public:
+	void setUp() {
+		_fsFactory = new SaveTestFSFactory();
+		_system = new SaveTestSystem(_fsFactory);
+		g_system = _system;
+		_saveFileMan = new DefaultSaveFileManager(SaveTestFSNode::SAVE_DIR);
+	}
+
+	void tearDown() {
+		_fsFactory->failWrites = false;
+		_saveFileMan->removeSavefile(SAVE_NAME);
+		delete _saveFileMan;
+		delete _system;
+		g_system = 0;
+	}
+
+	void test_save_and_load() {
+		TS_ASSERT(save("uncompressed", false, false));
+		TS_ASSERT_EQUALS(load(), "uncompressed");
+
+		TS_ASSERT(save("compressed", true, false));
+		TS_ASSERT_EQUALS(load(), "compressed");
+	}
+
+	void test_save_replaces_previous_version() {
+		TS_ASSERT(save("first version", true, false));
+		TS_ASSERT(save("second", true, false));
+		TS_ASSERT_EQUALS(load(), "second");
+
+		TS_ASSERT(!fileExists(Common::String(SAVE_NAME) + SAVEFILE_WRITER_TEMP_SUFFIX));
+		TS_ASSERT(!fileExists(Common::String(SAVE_NAME) + SAVEFILE_WRITER_BACKUP_SUFFIX));
+	}
+
+	void test_failed_save_reports_error() {
+		TS_ASSERT(save("kept", true, false));
+
+		_fsFactory->failWrites = true;
+		TS_ASSERT(!save("lost", true, false));
+		_fsFactory->failWrites = false;
+
+		TS_ASSERT_EQUALS(load(), "kept");
+	}
+
+	void test_autosave() {
+		TS_ASSERT(save("autosave", true, true));
+		TS_ASSERT_EQUALS(load(), "autosave");
+
+		// Failures of autosaves only end up as warnings
+		_fsFactory->failWrites = true;
+		TS_ASSERT(save("lost", true, true));
+		_fsFactory->failWrites = false;
+
+		TS_ASSERT_EQUALS(load(), "autosave");
+	}
+};
+
+const char *const SaveFileWriterTestSuite::SAVE_NAME = "savefile-writer-test.sav";
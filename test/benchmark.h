@@ -0,0 +1,49 @@
+#ifndef TEST_BENCHMARK_H
+#define TEST_BENCHMARK_H
+
+/*
+ * Helpers for the benchmark tests. Those only run in the runner built by
+ * "make benchmark", the regular test runner skips them.
+ *
+ * This header is included at the top of the generated runner, before any
+ * ScummVM header forbids the C library symbols it relies on.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+namespace Benchmark {
+
+/** Whether this is the benchmark runner. */
+inline bool enabled() {
+#ifdef TEST_BENCHMARKS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/** Processor time used so far, in seconds. */
+inline double seconds() {
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/** Print the throughput of a benchmark, in millions of units per second. */
+inline void report(const char *name, double count, const char *unit, double elapsed) {
+	if (elapsed <= 0.0)
+		elapsed = 1.0 / CLOCKS_PER_SEC;
+	printf("\n%-48s %10.2f M%s/s", name, count / elapsed / 1000000.0, unit);
+	fflush(stdout);
+}
+
+/** Print the rate of a slower benchmark, such as decoding frames, in units per second. */
+inline void reportRate(const char *name, double count, const char *unit, double elapsed) {
+	if (elapsed <= 0.0)
+		elapsed = 1.0 / CLOCKS_PER_SEC;
+	printf("\n%-48s %10.2f %s/s", name, count / elapsed, unit);
+	fflush(stdout);
+}
+
+} // End of namespace Benchmark
+
+#endif
@@ -0,0 +1,165 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/memstream.h"
+
+/**
+ * Archive of empty in-memory files, counting how often it is queried.
+ */
+class NameArchive : public Common::Archive {
+public:
+	mutable int lookups;
+
+	NameArchive() : lookups(0) {}
+
+	void addFile(const Common::String &name, byte tag = 0) {
+		_files[name] = tag;
+	}
+
+	virtual bool hasFile(const Common::String &name) const {
+		lookups++;
+		return _files.contains(name);
+	}
+
+	virtual int listMembers(Common::ArchiveMemberList &list) const {
+		for (FileMap::const_iterator i = _files.begin(); i != _files.end(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(i->_key, this)));
+		return _files.size();
+	}
+
+	virtual const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+	}
+
+	virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+		lookups++;
+		FileMap::const_iterator i = _files.find(name);
+		if (i == _files.end())
+			return 0;
+		return new Common::MemoryReadStream(&i->_value, 1);
+	}
+
+private:
+	typedef Common::HashMap<Common::String, byte, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileMap;
+	FileMap _files;
+};
+
+class ArchiveTestSuite : public CxxTest::TestSuite {
+	static byte readTag(Common::SeekableReadStream *stream) {
+		if (!stream)
+			return 0;
+		byte tag = stream->readByte();
+		delete stream;
+		return tag;
+	}
+
+public:
+	void test_search_set_priority() {
+		Common::SearchSet set;
+		NameArchive *low = new NameArchive;
+		NameArchive *high = new NameArchive;
+		low->addFile("shared.dat", 1);
+		low->addFile("low.dat", 1);
+		high->addFile("shared.dat", 2);
+		set.add("low", low, 0);
+		set.add("high", high, 1);
+
+		TS_ASSERT(set.hasFile("low.dat"));
+		TS_ASSERT(set.hasFile("SHARED.DAT"));
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("shared.dat")), 2);
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("Shared.Dat")), 2);
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("low.dat")), 1);
+		TS_ASSERT(!set.createReadStreamForMember("missing.dat"));
+
+		Common::ArchiveMemberPtr member = set.getMember("shared.dat");
+		TS_ASSERT(member);
+		TS_ASSERT_EQUALS(readTag(member->createReadStream()), 2);
+
+		set.setPriority("low", 2);
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("shared.dat")), 1);
+		set.remove("low");
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("shared.dat")), 2);
+		TS_ASSERT(!set.hasFile("low.dat"));
+	}
+
+	void test_search_set_index() {
+		Common::SearchSet set;
+		NameArchive *first = new NameArchive;
+		NameArchive *second = new NameArchive;
+		second->addFile("file.dat", 1);
+		set.add("first", first);
+		set.add("second", second);
+
+		// Repeated lookups, whether they succeed or not, only query the
+		// archives once
+		for (int i = 0; i < 4; i++) {
+			TS_ASSERT(set.hasFile("file.dat"));
+			TS_ASSERT(!set.hasFile("missing.dat"));
+			TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("FILE.DAT")), 1);
+		}
+		TS_ASSERT_EQUALS(first->lookups, 2);
+
+		// Adding an archive invalidates the index
+		NameArchive *third = new NameArchive;
+		third->addFile("missing.dat", 3);
+		set.add("third", third, 1);
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("missing.dat")), 3);
+
+		// So does changing an archive registered in a nested set
+		Common::SearchSet *nested = new Common::SearchSet;
+		set.add("nested", nested, 2);
+		TS_ASSERT(!set.hasFile("nested.dat"));
+		NameArchive *inner = new NameArchive;
+		inner->addFile("nested.dat", 4);
+		nested->add("inner", inner);
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("nested.dat")), 4);
+
+		// Or an explicit request, when an archive changed by itself
+		TS_ASSERT(!set.hasFile("late.dat"));
+		first->addFile("late.dat", 5);
+		TS_ASSERT(!set.hasFile("late.dat"));
+		set.invalidateIndex();
+		TS_ASSERT_EQUALS(readTag(set.createReadStreamForMember("late.dat")), 5);
+	}
+
+	void test_benchmark_search_set() {
+		if (!Benchmark::enabled())
+			return;
+
+		// Resembles the search manager of an engine: a few game directories
+		// and data archives, and files looked up over and over again
+		static const int kArchives = 8;
+		static const int kFiles = 512;
+		static const int kLookups = 1 << 20;
+
+		Common::SearchSet set;
+		Common::Array<Common::String> names;
+		for (int a = 0; a < kArchives; a++) {
+			NameArchive *archive = new NameArchive;
+			for (int f = 0; f < kFiles; f++) {
+				Common::String name = Common::String::format("data%d/File_%04d.dat", a, f);
+				archive->addFile(name);
+				names.push_back(name);
+			}
+			set.add(Common::String::format("archive%d", a), archive, -a);
+		}
+		for (int f = 0; f < kFiles; f++)
+			names.push_back(Common::String::format("missing/file_%04d.dat", f));
+
+		uint found = 0;
+		double start = Benchmark::seconds();
+		for (int i = 0; i < kLookups; i++)
+			found += set.hasFile(names[i % names.size()]);
+		Benchmark::report("SearchSet::hasFile", kLookups, "lookup", Benchmark::seconds() - start);
+
+		start = Benchmark::seconds();
+		for (int i = 0; i < kLookups; i++)
+			delete set.createReadStreamForMember(names[i % names.size()]);
+		Benchmark::report("SearchSet::createReadStreamForMember", kLookups, "lookup", Benchmark::seconds() - start);
+
+		TS_ASSERT(found > 0);
+	}
+};
@@ -0,0 +1,142 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/arena.h"
+#include "common/rect.h"
+
+class ArenaTestSuite : public CxxTest::TestSuite {
+	struct Counted {
+		static int alive;
+		int value;
+
+		Counted() : value(0) { alive++; }
+		Counted(const Counted &other) : value(other.value) { alive++; }
+		~Counted() { alive--; }
+	};
+
+	// Resembles an entry of a draw list
+	struct DrawEntry {
+		void *object;
+		Common::Rect rect;
+	};
+
+public:
+	void test_alloc() {
+		Common::Arena arena(256);
+		byte *a = (byte *)arena.alloc(3);
+		byte *b = (byte *)arena.alloc(16);
+		TS_ASSERT_EQUALS((size_t)a % Common::Arena::kAlignment, 0u);
+		TS_ASSERT_EQUALS(b, a + Common::Arena::kAlignment);
+		memset(a, 1, 3);
+		memset(b, 2, 16);
+
+		// Larger than a block
+		byte *c = (byte *)arena.alloc(1000);
+		memset(c, 3, 1000);
+		TS_ASSERT_EQUALS(a[0], 1);
+		TS_ASSERT_EQUALS(b[15], 2);
+		TS_ASSERT_EQUALS(arena.getBlockAllocations(), 2u);
+		TS_ASSERT(arena.getUsedSize() >= 1024u);
+
+		arena.reset();
+		TS_ASSERT_EQUALS(arena.getUsedSize(), 0u);
+		TS_ASSERT_EQUALS(arena.alloc(8), (void *)a);
+	}
+
+	void test_mark_release() {
+		Common::Arena arena(128);
+		arena.alloc(64);
+		const Common::Arena::Mark mark = arena.mark();
+		void *first = arena.alloc(64);
+
+		// Frames allocating the same amount reuse the same blocks
+		for (int frame = 0; frame < 10; frame++) {
+			arena.release(mark);
+			TS_ASSERT_EQUALS(arena.alloc(64), first);
+			for (int i = 0; i < 20; i++)
+				arena.alloc(40);
+		}
+		TS_ASSERT_EQUALS(arena.getBlockAllocations(), 8u);
+
+		{
+			Common::ArenaScope scope(arena);
+			arena.alloc(500);
+		}
+		TS_ASSERT_EQUALS(arena.getBlockAllocations(), 9u);
+		{
+			Common::ArenaScope scope(arena);
+			arena.alloc(500);
+		}
+		TS_ASSERT_EQUALS(arena.getBlockAllocations(), 9u);
+	}
+
+	void test_poison() {
+		Common::Arena arena(64, true);
+		const Common::Arena::Mark mark = arena.mark();
+		byte *data = (byte *)arena.alloc(100);
+		memset(data, 0, 100);
+		arena.release(mark);
+		TS_ASSERT_EQUALS(data[0], Common::Arena::kPoisonValue);
+		TS_ASSERT_EQUALS(data[99], Common::Arena::kPoisonValue);
+	}
+
+	void test_allocator() {
+		Common::Arena arena;
+		Common::ArenaAllocator<Counted> inArena(&arena);
+		Common::ArenaAllocator<Counted> onHeap;
+
+		Counted *a = inArena.create();
+		a->value = 5;
+		Counted *b = inArena.create(*a);
+		Counted *c = onHeap.create(*b);
+		TS_ASSERT_EQUALS(Counted::alive, 3);
+		TS_ASSERT_EQUALS(c->value, 5);
+
+		inArena.destroy(a);
+		inArena.destroy(b);
+		onHeap.destroy(c);
+		TS_ASSERT_EQUALS(Counted::alive, 0);
+
+		Common::Rect *rect = new (arena) Common::Rect(1, 2, 3, 4);
+		TS_ASSERT_EQUALS(rect->width(), 2);
+	}
+
+	void test_benchmark_arena() {
+		if (!Benchmark::enabled())
+			return;
+
+		// Draw lists rebuilt every frame, with a few hundred entries each
+		static const int kFrames = 4096;
+		static const int kEntries = 256;
+		DrawEntry *entries[kEntries];
+
+		double start = Benchmark::seconds();
+		for (int frame = 0; frame < kFrames; frame++) {
+			for (int i = 0; i < kEntries; i++) {
+				entries[i] = new DrawEntry;
+				entries[i]->rect = Common::Rect(i, i, i + frame, i + 10);
+			}
+			for (int i = 0; i < kEntries; i++)
+				delete entries[i];
+		}
+		Benchmark::report("new/delete draw entries", kFrames * kEntries, "entry", Benchmark::seconds() - start);
+
+		Common::Arena arena;
+		Common::ArenaAllocator<DrawEntry> allocator(&arena);
+		start = Benchmark::seconds();
+		for (int frame = 0; frame < kFrames; frame++) {
+			Common::ArenaScope scope(arena);
+			for (int i = 0; i < kEntries; i++) {
+				entries[i] = allocator.create();
+				entries[i]->rect = Common::Rect(i, i, i + frame, i + 10);
+			}
+			for (int i = 0; i < kEntries; i++)
+				allocator.destroy(entries[i]);
+		}
+		Benchmark::report("Arena draw entries", kFrames * kEntries, "entry", Benchmark::seconds() - start);
+
+		// One malloc per entry before, versus a single block now
+		TS_ASSERT_EQUALS(arena.getBlockAllocations(), 1u);
+	}
+};
+
+int ArenaTestSuite::Counted::alive = 0;
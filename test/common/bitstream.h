@@ -1,5 +1,6 @@
 #include <cxxtest/TestSuite.h>
 
+#include "common/array.h"
 #include "common/bitstream.h"
 #include "common/memstream.h"
 
@@ -211,4 +212,169 @@ public:
 		tmpl_peek_bits_lsb<Common::MemoryReadStream, Common::BitStream8LSB>();
 		tmpl_peek_bits_lsb<Common::BitStreamMemoryStream, Common::BitStreamMemory8LSB>();
 	}
+
+private:
+	/** Bit pos of data, as a bit stream with the given layout would hand it out. */
+	static uint32 referenceBit(const byte *data, uint32 pos, int valueBits, bool isLE, bool isMSB2LSB) {
+		const byte *value = data + pos / valueBits * (valueBits / 8);
+		uint32 bit = pos % valueBits;
+		if (isMSB2LSB)
+			bit = valueBits - 1 - bit;
+		const uint32 byteIndex = isLE ? bit / 8 : (valueBits / 8 - 1 - bit / 8);
+		return (value[byteIndex] >> (bit % 8)) & 1;
+	}
+
+	static uint32 referenceBits(const byte *data, uint32 pos, uint8 n, int valueBits, bool isLE, bool isMSB2LSB) {
+		uint32 v = 0;
+		for (uint8 i = 0; i < n; i++) {
+			const uint32 bit = referenceBit(data, pos + i, valueBits, isLE, isMSB2LSB);
+			if (isMSB2LSB)
+				v = (v << 1) | bit;
+			else
+				v |= bit << i;
+		}
+		return v;
+	}
+
+	template<class MS, class BS, int valueBits, bool isLE, bool isMSB2LSB>
+	void tmpl_against_reference() {
+		byte contents[256];
+		uint32 seed = valueBits * 4 + isLE * 2 + isMSB2LSB;
+		for (uint i = 0; i < sizeof(contents); i++) {
+			seed = seed * 1103515245 + 12345;
+			contents[i] = seed >> 16;
+		}
+
+		MS ms(contents, sizeof(contents));
+		BS bs(ms);
+		TS_ASSERT_EQUALS(bs.size(), sizeof(contents) * 8);
+
+		// Random reads, peeks and skips, some of them across several values
+		uint32 pos = 0;
+		while (bs.size() - pos > 100) {
+			seed = seed * 1103515245 + 12345;
+			const uint8 n = (seed >> 8) % 33;
+			switch ((seed >> 16) % 6) {
+			case 0:
+				TS_ASSERT_EQUALS(bs.getBit(), referenceBit(contents, pos, valueBits, isLE, isMSB2LSB));
+				pos++;
+				break;
+			case 1:
+				TS_ASSERT_EQUALS(bs.peekBits(n), referenceBits(contents, pos, n, valueBits, isLE, isMSB2LSB));
+				break;
+			case 2:
+				bs.skip(n * 2);
+				pos += n * 2;
+				break;
+			case 3:
+				bs.align();
+				pos = (pos + valueBits - 1) / valueBits * valueBits;
+				break;
+			default:
+				TS_ASSERT_EQUALS(bs.getBits(n), referenceBits(contents, pos, n, valueBits, isLE, isMSB2LSB));
+				pos += n;
+				break;
+			}
+			TS_ASSERT_EQUALS(bs.pos(), pos);
+		}
+
+		// Up to the very end of the stream
+		bs.skip(bs.size() - pos - 20);
+		TS_ASSERT_EQUALS(bs.peekBits(20), referenceBits(contents, bs.size() - 20, 20, valueBits, isLE, isMSB2LSB));
+		TS_ASSERT_EQUALS(bs.getBits(20), referenceBits(contents, bs.size() - 20, 20, valueBits, isLE, isMSB2LSB));
+		TS_ASSERT(bs.eos());
+
+		bs.rewind();
+		TS_ASSERT_EQUALS(bs.getBits(32), referenceBits(contents, 0, 32, valueBits, isLE, isMSB2LSB));
+	}
+
+	template<class MS, int valueBits, bool isLE, bool isMSB2LSB>
+	void tmpl_against_reference() {
+		tmpl_against_reference<MS, Common::BitStreamImpl<MS, valueBits, isLE, isMSB2LSB>, valueBits, isLE, isMSB2LSB>();
+	}
+
+	template<class MS>
+	void tmpl_all_layouts() {
+		tmpl_against_reference<MS,  8, false, true >();
+		tmpl_against_reference<MS,  8, false, false>();
+		tmpl_against_reference<MS, 16, true , true >();
+		tmpl_against_reference<MS, 16, true , false>();
+		tmpl_against_reference<MS, 16, false, true >();
+		tmpl_against_reference<MS, 16, false, false>();
+		tmpl_against_reference<MS, 32, true , true >();
+		tmpl_against_reference<MS, 32, true , false>();
+		tmpl_against_reference<MS, 32, false, true >();
+		tmpl_against_reference<MS, 32, false, false>();
+	}
+
+	template<class BS>
+	static double benchmarkGetBits(const byte *data, uint32 size, int passes, uint32 &sum) {
+		const double start = Benchmark::seconds();
+		for (int pass = 0; pass < passes; pass++) {
+			Common::MemoryReadStream ms(data, size);
+			BS bs(ms);
+			// Field sizes as found in video codecs, from 1 to 12 bits
+			for (uint8 n = 1; bs.size() - bs.pos() >= 12; n = n % 12 + 1)
+				sum += bs.getBits(n);
+		}
+		return Benchmark::seconds() - start;
+	}
+
+	template<class BS>
+	static double benchmarkMemoryGetBit(const byte *data, uint32 size, int passes, uint32 &sum) {
+		const double start = Benchmark::seconds();
+		for (int pass = 0; pass < passes; pass++) {
+			Common::BitStreamMemoryStream ms(data, size);
+			BS bs(ms);
+			while (!bs.eos())
+				sum += bs.getBit();
+		}
+		return Benchmark::seconds() - start;
+	}
+
+	template<class BS>
+	static double benchmarkPeekSkip(const byte *data, uint32 size, int passes, uint32 &sum) {
+		const double start = Benchmark::seconds();
+		for (int pass = 0; pass < passes; pass++) {
+			Common::MemoryReadStream ms(data, size);
+			BS bs(ms);
+			// Like a table driven decoder: peek a few bits, use part of them
+			while (bs.size() - bs.pos() >= 9) {
+				const uint32 v = bs.peekBits(9);
+				sum += v;
+				bs.skip((v & 7) + 1);
+			}
+		}
+		return Benchmark::seconds() - start;
+	}
+
+public:
+	void test_against_reference() {
+		tmpl_all_layouts<Common::MemoryReadStream>();
+		tmpl_all_layouts<Common::BitStreamMemoryStream>();
+	}
+
+	void test_benchmark_bitstream() {
+		if (!Benchmark::enabled())
+			return;
+
+		static const uint32 kSize = 1 << 20;
+		static const int kPasses = 8;
+		Common::Array<byte> data;
+		uint32 seed = 1;
+		for (uint32 i = 0; i < kSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			data.push_back(seed >> 16);
+		}
+
+		uint32 sum = 0;
+		const double bits = (double)kSize * 8 * kPasses;
+		Benchmark::report("BitStream32LELSB getBits", bits, "bit", benchmarkGetBits<Common::BitStream32LELSB>(data.begin(), kSize, kPasses, sum));
+		Benchmark::report("BitStream32BEMSB getBits", bits, "bit", benchmarkGetBits<Common::BitStream32BEMSB>(data.begin(), kSize, kPasses, sum));
+		Benchmark::report("BitStream8MSB getBits", bits, "bit", benchmarkGetBits<Common::BitStream8MSB>(data.begin(), kSize, kPasses, sum));
+		Benchmark::report("BitStreamMemory8LSB getBit", bits, "bit", benchmarkMemoryGetBit<Common::BitStreamMemory8LSB>(data.begin(), kSize, kPasses, sum));
+		Benchmark::report("BitStream32LELSB peekBits/skip", bits, "bit", benchmarkPeekSkip<Common::BitStream32LELSB>(data.begin(), kSize, kPasses, sum));
+
+		TS_ASSERT(sum > 0);
+	}
 };
@@ -0,0 +1,246 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flat-hashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FlatStringMap;
+
+	template<class Map>
+	static double benchmarkInsert(Map &map, const Common::Array<Common::String> &names) {
+		const double start = Benchmark::seconds();
+		for (uint i = 0; i < names.size(); i++)
+			map[names[i]] = i;
+		return Benchmark::seconds() - start;
+	}
+
+	template<class Map>
+	static double benchmarkLookup(const Map &map, const Common::Array<Common::String> &names, int lookups, int &found) {
+		const double start = Benchmark::seconds();
+		for (int i = 0; i < lookups; i++)
+			found += map.getVal(names[i % names.size()], -1) >= 0;
+		return Benchmark::seconds() - start;
+	}
+
+	template<class Map>
+	static double benchmarkIterate(const Map &map, int passes, uint &sum) {
+		const double start = Benchmark::seconds();
+		for (int i = 0; i < passes; i++) {
+			for (typename Map::const_iterator j = map.begin(); j != map.end(); ++j)
+				sum += j->_value;
+		}
+		return Benchmark::seconds() - start;
+	}
+
+	template<class Map>
+	static double benchmarkIntLookup(const Map &map, const Common::Array<int> &keys, int lookups, int &found) {
+		const double start = Benchmark::seconds();
+		for (int i = 0; i < lookups; i++)
+			found += map.contains(keys[i % keys.size()]);
+		return Benchmark::seconds() - start;
+	}
+
+public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		FlatStringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = 1;
+		container2["quux"] = 2;
+		TS_ASSERT(!container2.empty());
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(!container2.contains("foo"));
+	}
+
+	void test_contains() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(container.contains(0));
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.contains(17));
+		TS_ASSERT(!container.contains(-1));
+
+		FlatStringMap container2;
+		container2["foo"] = 1;
+		container2["quux"] = 2;
+		TS_ASSERT(container2.contains("foo"));
+		TS_ASSERT(container2.contains("QUUX"));
+		TS_ASSERT(!container2.contains("bar"));
+		TS_ASSERT(!container2.contains("asdf"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT_EQUALS(container[1], 42);
+		container.erase(container.find(0));
+		container.erase(container.find(1));
+		TS_ASSERT(!container.empty());
+		container.erase(2);
+		TS_ASSERT(container.empty());
+		container.erase(2);
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+
+		const Common::FlatHashMap<int, int> &containerRef = container;
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(1), -1);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(containerRef.size(), 2u);
+		TS_ASSERT(containerRef.find(17) == containerRef.end());
+	}
+
+	void test_iterator() {
+		Common::FlatHashMap<int, int> container;
+
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+		for (int i = 0; i < 5; i++)
+			container[i] = i * 10;
+		container.erase(0);
+		container.erase(1);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			TS_ASSERT_EQUALS(i->_value, i->_key * 10);
+			TS_ASSERT(!(found & (1 << i->_key)));
+			found |= 1 << i->_key;
+		}
+		TS_ASSERT(found == 16+8+4);
+
+		// Erasing while iterating
+		for (i = container.begin(); i != container.end(); ++i) {
+			if (i->_key == 3)
+				container.erase(i);
+		}
+		found = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		for (j = container.begin(); j != container.end(); ++j)
+			found |= 1 << j->_key;
+		TS_ASSERT(found == 16+4);
+	}
+
+	void test_copy() {
+		FlatStringMap map1, map2;
+		map1["a"] = 1;
+		map1["b"] = 2;
+		map1.erase("a");
+		map2 = map1;
+		FlatStringMap map3(map2);
+		map1["b"] = 3;
+		TS_ASSERT_EQUALS(map2["b"], 2);
+		TS_ASSERT_EQUALS(map3["B"], 2);
+		TS_ASSERT(!map3.contains("a"));
+		TS_ASSERT_EQUALS(map3.size(), 1u);
+	}
+
+	void test_against_hashmap() {
+		// Random inserts and removals, with keys which share low bits
+		Common::FlatHashMap<int, int> flat;
+		Common::HashMap<int, int> reference;
+		uint32 seed = 1;
+		for (int i = 0; i < 100000; i++) {
+			seed = seed * 1103515245 + 12345;
+			const int key = ((seed >> 16) % 2000) * 64;
+			if (seed & 0x100) {
+				flat[key] = i;
+				reference[key] = i;
+			} else {
+				flat.erase(key);
+				reference.erase(key);
+			}
+			if (i % 30000 == 29999) {
+				flat.clear(i % 60000 == 29999);
+				reference.clear();
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+		for (Common::HashMap<int, int>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(flat.getVal(i->_key, -1), i->_value);
+		uint count = 0;
+		for (Common::FlatHashMap<int, int>::const_iterator i = flat.begin(); i != flat.end(); ++i, count++)
+			TS_ASSERT_EQUALS(reference.getVal(i->_key, -1), i->_value);
+		TS_ASSERT_EQUALS(count, flat.size());
+	}
+
+	void test_benchmark_flat_hashmap() {
+		if (!Benchmark::enabled())
+			return;
+
+		// Resembles a symbol table: a few thousand string keys looked up
+		// over and over again
+		static const int kNames = 4096;
+		static const int kLookups = 1 << 21;
+		static const int kPasses = 1024;
+
+		Common::Array<Common::String> names;
+		for (int i = 0; i < kNames; i++)
+			names.push_back(Common::String::format("symbol_%d", i * 7919));
+
+		Common::HashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> map;
+		FlatStringMap flat;
+		int found = 0;
+		uint sum = 0;
+
+		Benchmark::report("HashMap insert", kNames, "key", benchmarkInsert(map, names));
+		Benchmark::report("FlatHashMap insert", kNames, "key", benchmarkInsert(flat, names));
+
+		// Look up missing names too
+		for (int i = 0; i < kNames; i++)
+			names.push_back(Common::String::format("missing_%d", i));
+		Benchmark::report("HashMap lookup", kLookups, "lookup", benchmarkLookup(map, names, kLookups, found));
+		Benchmark::report("FlatHashMap lookup", kLookups, "lookup", benchmarkLookup(flat, names, kLookups, found));
+
+		Benchmark::report("HashMap iterate", kPasses * kNames, "entry", benchmarkIterate(map, kPasses, sum));
+		Benchmark::report("FlatHashMap iterate", kPasses * kNames, "entry", benchmarkIterate(flat, kPasses, sum));
+
+		// Integer keys, like object and selector tables
+		Common::HashMap<int, int> intMap;
+		Common::FlatHashMap<int, int> flatIntMap;
+		double start = Benchmark::seconds();
+		for (int i = 0; i < kNames * 16; i++)
+			intMap[i] = i;
+		Benchmark::report("HashMap<int> insert", kNames * 16, "key", Benchmark::seconds() - start);
+		start = Benchmark::seconds();
+		for (int i = 0; i < kNames * 16; i++)
+			flatIntMap[i] = i;
+		Benchmark::report("FlatHashMap<int> insert", kNames * 16, "key", Benchmark::seconds() - start);
+
+		// In random order, half of them missing
+		Common::Array<int> keys;
+		uint32 seed = 1;
+		for (int i = 0; i < kNames * 32; i++) {
+			seed = seed * 1103515245 + 12345;
+			keys.push_back((seed >> 8) % (kNames * 32));
+		}
+		Benchmark::report("HashMap<int> lookup", kLookups * 4, "lookup", benchmarkIntLookup(intMap, keys, kLookups * 4, found));
+		Benchmark::report("FlatHashMap<int> lookup", kLookups * 4, "lookup", benchmarkIntLookup(flatIntMap, keys, kLookups * 4, found));
+
+		TS_ASSERT(found > 0);
+		TS_ASSERT(sum > 0);
+	}
+};
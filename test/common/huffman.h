@@ -10,6 +10,103 @@
 * TODO: It could be improved by generating one at runtime.
 */
 class HuffmanTestSuite : public CxxTest::TestSuite {
+	/** A code with codeCount symbols and lengths up to maxLength, with random frequencies. */
+	static void generateCode(uint32 codeCount, uint8 maxLength, uint32 *codes, uint8 *lengths, uint32 &seed) {
+		// Split leaves of a code tree until there are enough of them. Half
+		// of the time, the last leaf is split, making for some long codes.
+		uint32 count = 1;
+		lengths[0] = 0;
+		while (count < codeCount) {
+			seed = seed * 1103515245 + 12345;
+			uint32 leaf = (seed & 0x10000) ? count - 1 : (seed >> 8) % count;
+			while (lengths[leaf] >= maxLength)
+				leaf = (leaf + 1) % count;
+			lengths[leaf]++;
+			lengths[count++] = lengths[leaf];
+		}
+
+		// Canonical codes, assigned in the order of the lengths
+		uint32 code = 0;
+		for (uint8 length = 1; length <= maxLength; length++) {
+			for (uint32 i = 0; i < codeCount; i++) {
+				if (lengths[i] == length)
+					codes[i] = code++;
+			}
+			code <<= 1;
+		}
+	}
+
+	/** Write the codes of symbols into data, in the bit order of the bitstreams. */
+	static uint32 encode(const uint32 *symbols, uint32 symbolCount, const uint32 *codes, const uint8 *lengths, bool msb2lsb, byte *data) {
+		uint32 pos = 0;
+		for (uint32 i = 0; i < symbolCount; i++) {
+			const uint32 code = codes[symbols[i]];
+			for (int bit = lengths[symbols[i]] - 1; bit >= 0; bit--, pos++) {
+				if (code & (1 << bit))
+					data[pos / 8] |= msb2lsb ? 0x80 >> (pos % 8) : 1 << (pos % 8);
+			}
+		}
+		return pos;
+	}
+
+	/** Reverse the bits of the codes, for bitstreams reading from LSB to MSB. */
+	static void reverseCodes(uint32 codeCount, const uint32 *codes, const uint8 *lengths, uint32 *reversed) {
+		for (uint32 i = 0; i < codeCount; i++) {
+			reversed[i] = 0;
+			for (uint8 bit = 0; bit < lengths[i]; bit++)
+				reversed[i] |= ((codes[i] >> bit) & 1) << (lengths[i] - 1 - bit);
+		}
+	}
+
+	/** The decoder as it was before it used lookup tables: matching the codes one bit at a time. */
+	template<class BITSTREAM>
+	static uint32 getSymbolBitwise(BITSTREAM &bits, uint32 codeCount, const uint32 *codes, const uint8 *lengths) {
+		uint32 code = 0;
+		for (uint32 length = 1; length <= 32; length++) {
+			bits.addBit(code, length - 1);
+			for (uint32 i = 0; i < codeCount; i++) {
+				if (lengths[i] == length && codes[i] == code)
+					return i;
+			}
+		}
+		return (uint32)-1;
+	}
+
+	template<class BITSTREAM>
+	static void checkAgainstBitwise(uint8 maxLength, bool msb2lsb) {
+		static const uint32 kCodeCount = 200;
+		static const uint32 kSymbolCount = 2000;
+		uint32 codes[kCodeCount], bitstreamCodes[kCodeCount];
+		uint8 lengths[kCodeCount];
+		uint32 symbols[kSymbolCount];
+		byte data[kSymbolCount * 32 / 8 + 4];
+		memset(data, 0, sizeof(data));
+
+		uint32 seed = maxLength;
+		generateCode(kCodeCount, maxLength, codes, lengths, seed);
+		for (uint32 i = 0; i < kSymbolCount; i++) {
+			seed = seed * 1103515245 + 12345;
+			symbols[i] = (seed >> 8) % kCodeCount;
+		}
+		const uint32 bitCount = encode(symbols, kSymbolCount, codes, lengths, msb2lsb, data);
+
+		if (msb2lsb)
+			memcpy(bitstreamCodes, codes, sizeof(codes));
+		else
+			reverseCodes(kCodeCount, codes, lengths, bitstreamCodes);
+		Common::Huffman h(0, kCodeCount, bitstreamCodes, lengths);
+
+		Common::MemoryReadStream ms1(data, (bitCount + 31) / 32 * 4);
+		Common::MemoryReadStream ms2(data, (bitCount + 31) / 32 * 4);
+		BITSTREAM bits1(ms1), bits2(ms2);
+		for (uint32 i = 0; i < kSymbolCount; i++) {
+			const uint32 symbol = h.getSymbol(bits1);
+			TS_ASSERT_EQUALS(symbol, symbols[i]);
+			TS_ASSERT_EQUALS(symbol, getSymbolBitwise(bits2, kCodeCount, bitstreamCodes, lengths));
+			TS_ASSERT_EQUALS(bits1.pos(), bits2.pos());
+		}
+	}
+
 	public:
 	void test_get_with_full_symbols() {
 
@@ -141,4 +238,82 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[5]);
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[6]);
 	}
+
+	void test_against_bitwise() {
+		// Codes decoded with the first table, and with one or two subtables
+		checkAgainstBitwise<Common::BitStream8MSB>(8, true);
+		checkAgainstBitwise<Common::BitStream32LELSB>(8, false);
+		checkAgainstBitwise<Common::BitStream16BEMSB>(16, true);
+		checkAgainstBitwise<Common::BitStream32LELSB>(16, false);
+		checkAgainstBitwise<Common::BitStream32BEMSB>(24, true);
+		checkAgainstBitwise<Common::BitStream8LSB>(24, false);
+	}
+
+	void test_end_of_stream() {
+		// A code longer than the lookup table, ending the stream
+		const uint8 lengths[] = {1, 12, 12};
+		const uint32 codes[] = {0x0, 0x800, 0x801};
+		Common::Huffman h(0, 3, codes, lengths);
+
+		byte input[] = {0x80, 0x00};
+		Common::MemoryReadStream ms(input, sizeof(input));
+		Common::BitStream8MSB bs(ms);
+
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 1u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 0u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 0u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 0u);
+		TS_ASSERT_EQUALS(h.getSymbol(bs), 0u);
+		TS_ASSERT(bs.eos());
+	}
+
+	void test_benchmark_huffman() {
+		if (!Benchmark::enabled())
+			return;
+
+		// Resembles the AC coefficient codes of video decoders: most codes
+		// are short, a few are longer than the lookup table
+		static const uint32 kCodeCount = 128;
+		static const uint32 kSymbolCount = 1 << 18;
+		static const int kPasses = 8;
+		uint32 codes[kCodeCount];
+		uint8 lengths[kCodeCount];
+		uint32 seed = 1;
+		generateCode(kCodeCount, 16, codes, lengths, seed);
+
+		// Symbols with the frequencies the code was made for
+		Common::Array<uint32> symbols;
+		while (symbols.size() < kSymbolCount) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 symbol = (seed >> 8) % kCodeCount;
+			if (((seed >> 4) & 0xFFF) < (0x1000u >> MIN<uint8>(lengths[symbol], 12)))
+				symbols.push_back(symbol);
+		}
+
+		Common::Array<byte> data;
+		data.resize(kSymbolCount * 16 / 8 + 4);
+		const uint32 bitCount = encode(symbols.begin(), kSymbolCount, codes, lengths, true, data.begin());
+		Common::Huffman h(0, kCodeCount, codes, lengths);
+
+		uint32 sum = 0;
+		double start = Benchmark::seconds();
+		for (int pass = 0; pass < kPasses; pass++) {
+			Common::MemoryReadStream ms(data.begin(), (bitCount + 31) / 32 * 4);
+			Common::BitStream32BEMSB bits(ms);
+			for (uint32 i = 0; i < kSymbolCount; i++)
+				sum += getSymbolBitwise(bits, kCodeCount, codes, lengths);
+		}
+		Benchmark::report("Bitwise Huffman decoding", kPasses * kSymbolCount, "symbol", Benchmark::seconds() - start);
+
+		start = Benchmark::seconds();
+		for (int pass = 0; pass < kPasses; pass++) {
+			Common::MemoryReadStream ms(data.begin(), (bitCount + 31) / 32 * 4);
+			Common::BitStream32BEMSB bits(ms);
+			for (uint32 i = 0; i < kSymbolCount; i++)
+				sum -= h.getSymbol(bits);
+		}
+		Benchmark::report("Table Huffman decoding", kPasses * kSymbolCount, "symbol", Benchmark::seconds() - start);
+
+		TS_ASSERT_EQUALS(sum, 0u);
+	}
 };
@@ -0,0 +1,119 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/interned-str.h"
+#include "common/str-view.h"
+
+class InternedStringTestSuite : public CxxTest::TestSuite {
+	static uint lookupLength(const Common::String &name) {
+		return name.size();
+	}
+
+public:
+	void test_string_view() {
+		const char buffer[] = "sound.dat;music.dat";
+		Common::StringView sound(buffer, 9);
+		Common::StringView music = Common::StringView(buffer).substr(10);
+
+		TS_ASSERT_EQUALS(sound.size(), 9u);
+		TS_ASSERT(sound == Common::StringView("sound.dat"));
+		TS_ASSERT(sound != music);
+		TS_ASSERT(music.equalsIgnoreCase("MUSIC.DAT"));
+		TS_ASSERT(!music.equalsIgnoreCase("MUSIC.DA"));
+		TS_ASSERT(!music.equalsIgnoreCase("MUSIC.DATA"));
+		TS_ASSERT_EQUALS(music.toString(), "music.dat");
+		TS_ASSERT(music.substr(6) == Common::StringView("dat"));
+		TS_ASSERT(music.substr(20).empty());
+		TS_ASSERT(Common::StringView().empty());
+
+		// Hashes match those of Strings, so views can stand in for them
+		TS_ASSERT_EQUALS(Common::hashit(sound), Common::hashit(Common::String("sound.dat")));
+		TS_ASSERT_EQUALS(Common::hashit(Common::StringView()), Common::hashit(Common::String()));
+		TS_ASSERT_EQUALS(Common::hashit_lower(music), Common::hashit_lower(Common::String("MUSIC.DAT")));
+
+		Common::HashMap<Common::StringView, int, Common::IgnoreCaseView_Hash, Common::IgnoreCaseView_EqualTo> map;
+		map[sound] = 1;
+		map[music] = 2;
+		TS_ASSERT_EQUALS(map.getVal("SOUND.DAT", 0), 1);
+		TS_ASSERT_EQUALS(map.getVal(Common::String("Music.dat"), 0), 2);
+		TS_ASSERT(!map.contains("sound"));
+	}
+
+	void test_interned_string() {
+		Common::InternedString a("sound.dat");
+		Common::InternedString b(Common::String("sound") + ".dat");
+		Common::InternedString c("music.dat");
+		Common::InternedString empty;
+
+		TS_ASSERT(a == b);
+		TS_ASSERT(a != c);
+		TS_ASSERT(&a.str() == &b.str());
+		TS_ASSERT_EQUALS(a.hash(), Common::hashit("sound.dat"));
+		TS_ASSERT(empty.empty());
+		TS_ASSERT(empty == Common::InternedString(""));
+
+		// Interning existing contents does not grow the table
+		const uint count = Common::InternedString::count();
+		const char buffer[] = "xxmusic.datxx";
+		Common::InternedString d(Common::StringView(buffer + 2, 9));
+		TS_ASSERT(d == c);
+		TS_ASSERT_EQUALS(Common::InternedString::count(), count);
+
+		// Passing as a String does not copy it
+		TS_ASSERT_EQUALS(lookupLength(d), 9u);
+		TS_ASSERT_EQUALS(strcmp(d.c_str(), "music.dat"), 0);
+
+		Common::HashMap<Common::InternedString, int> map;
+		map[a] = 1;
+		map[c] = 2;
+		TS_ASSERT_EQUALS(map["sound.dat"], 1);
+		TS_ASSERT_EQUALS(map[d], 2);
+	}
+
+	void test_benchmark_interned_string() {
+		if (!Benchmark::enabled())
+			return;
+
+		// Resembles a symbol table, looked up by names of similar lengths
+		static const int kNames = 1024;
+		static const int kLookups = 1 << 21;
+
+		Common::Array<Common::String> names;
+		Common::Array<Common::InternedString> interned;
+		Common::HashMap<Common::String, int> map;
+		Common::HashMap<Common::InternedString, int> internedMap;
+		for (int i = 0; i < kNames; i++) {
+			names.push_back(Common::String::format("script_variable_%d", i * 7919));
+			interned.push_back(Common::InternedString(names[i]));
+			map[names[i]] = i;
+			internedMap[interned[i]] = i;
+		}
+
+		int sum = 0;
+		double start = Benchmark::seconds();
+		for (int i = 0; i < kLookups; i++)
+			sum += map[names[i % kNames]];
+		Benchmark::report("HashMap<String> lookup", kLookups, "lookup", Benchmark::seconds() - start);
+
+		start = Benchmark::seconds();
+		for (int i = 0; i < kLookups; i++)
+			sum += internedMap[interned[i % kNames]];
+		Benchmark::report("HashMap<InternedString> lookup", kLookups, "lookup", Benchmark::seconds() - start);
+
+		// Comparing names, a common operation in script interpreters
+		int equal = 0;
+		start = Benchmark::seconds();
+		for (int i = 0; i < kLookups; i++)
+			equal += names[i % kNames] == names[(i * 3) % kNames];
+		Benchmark::report("String comparison", kLookups, "comparison", Benchmark::seconds() - start);
+
+		start = Benchmark::seconds();
+		for (int i = 0; i < kLookups; i++)
+			equal += interned[i % kNames] == interned[(i * 3) % kNames];
+		Benchmark::report("InternedString comparison", kLookups, "comparison", Benchmark::seconds() - start);
+
+		TS_ASSERT(sum > 0);
+		TS_ASSERT(equal > 0);
+	}
+};
@@ -0,0 +1,67 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memory-stats.h"
+#include "common/memstream.h"
+
+class MemoryStatsTestSuite : public CxxTest::TestSuite {
+	static const Common::MemoryStats::Info *findInfo(const Common::MemoryStats::InfoList &infos, const char *name) {
+		for (uint i = 0; i < infos.size(); i++) {
+			if (infos[i].name == name)
+				return &infos[i];
+		}
+		return 0;
+	}
+
+public:
+	void test_counter() {
+		Common::MemoryCounter counter("test.counter");
+		counter.allocated(100);
+		counter.allocated(50);
+		counter.freed(100);
+		counter.allocated(20);
+
+		TS_ASSERT_EQUALS(counter.getLiveSize(), 70u);
+		TS_ASSERT_EQUALS(counter.getPeakSize(), 150u);
+		TS_ASSERT_EQUALS(counter.getAllocations(), 3u);
+		TS_ASSERT_EQUALS(counter.getFrees(), 1u);
+	}
+
+	void test_list() {
+		Common::MemoryCounter fonts1("test.fonts");
+		Common::MemoryCounter resources("test.resources");
+		fonts1.allocated(10);
+		resources.allocated(1000);
+
+		{
+			Common::MemoryCounter fonts2("test.fonts");
+			fonts2.allocated(30);
+
+			// Counters with the same name are added up
+			const Common::MemoryStats::InfoList infos = Common::MemoryStats::list();
+			const Common::MemoryStats::Info *fonts = findInfo(infos, "test.fonts");
+			TS_ASSERT(fonts);
+			TS_ASSERT_EQUALS(fonts->liveSize, 40u);
+			TS_ASSERT_EQUALS(fonts->allocations, 2u);
+			TS_ASSERT_EQUALS(fonts->counters, 2u);
+			TS_ASSERT(fonts < findInfo(infos, "test.resources"));
+		}
+
+		// Destroyed counters are no longer listed
+		const Common::MemoryStats::InfoList infos = Common::MemoryStats::list();
+		TS_ASSERT_EQUALS(findInfo(infos, "test.fonts")->counters, 1u);
+		TS_ASSERT(!findInfo(infos, "test.counter"));
+	}
+
+	void test_dump() {
+		Common::MemoryCounter counter("test.dump");
+		counter.allocated(4096);
+		counter.freed(1024);
+
+		Common::MemoryWriteStreamDynamic stream(DisposeAfterUse::YES);
+		Common::MemoryStats::dump(stream);
+		const Common::String text((const char *)stream.getData(), stream.size());
+
+		TS_ASSERT(text.hasPrefix("#"));
+		TS_ASSERT(text.contains("\ntest.dump\t3072\t4096\t1\t1\n"));
+	}
+};
@@ -70,4 +70,25 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	class DirectSubReadStream : public Common::SeekableSubReadStream {
+	public:
+		DirectSubReadStream(Common::SeekableReadStream *parentStream, uint32 begin, uint32 end)
+			: Common::SeekableSubReadStream(parentStream, begin, end) {}
+
+		virtual const byte *getData() const { return getParentData(); }
+	};
+
+	void test_get_data() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		// Not exposed unless a subclass opts in
+		Common::SeekableSubReadStream ssrs(&ms, 2, 8);
+		TS_ASSERT(!ssrs.getData());
+
+		DirectSubReadStream dsrs(&ms, 2, 8);
+		TS_ASSERT_EQUALS(dsrs.getData(), contents + 2);
+		TS_ASSERT_EQUALS(dsrs.getData()[0], 2);
+	}
 };
@@ -0,0 +1,240 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+/**
+ * Memory stream hiding its data, like files which are not memory mapped.
+ */
+class UnmappedReadStream : public Common::MemoryReadStream {
+public:
+	UnmappedReadStream(const byte *data, uint32 size)
+		: Common::MemoryReadStream(data, size, DisposeAfterUse::YES) {}
+
+	virtual const byte *getData() const { return 0; }
+};
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+	struct Member {
+		const char *name;
+		uint32 size;
+		bool deflate;
+	};
+
+	static const Member *members() {
+		static const Member list[] = {
+			{ "small.txt", 1000, true },
+			{ "stored.bin", 300 * 1024, false },
+			{ "large.bin", 1536 * 1024, true },
+			{ "empty.bin", 0, true },
+			{ 0, 0, false }
+		};
+		return list;
+	}
+
+	// Text-like data, compressible but not trivially so
+	static byte *makeData(uint32 size, uint32 seed) {
+		byte *data = (byte *)malloc(size + 1);
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = "etaoin shrdlu\n"[(seed >> 16) % 14];
+		}
+		return data;
+	}
+
+	static void writeHeader(Common::WriteStream &stream, uint32 signature, bool central, const Member &member,
+	                        uint32 crc, uint32 compressedSize, uint32 localOffset) {
+		stream.writeUint32LE(signature);
+		if (central)
+			stream.writeUint16LE(20);
+		stream.writeUint16LE(20);
+		stream.writeUint16LE(0);
+		stream.writeUint16LE(member.deflate ? 8 : 0);
+		stream.writeUint32LE(0);
+		stream.writeUint32LE(crc);
+		stream.writeUint32LE(compressedSize);
+		stream.writeUint32LE(member.size);
+		stream.writeUint16LE(strlen(member.name));
+		stream.writeUint16LE(0);
+		if (central) {
+			stream.writeUint16LE(0);
+			stream.writeUint16LE(0);
+			stream.writeUint16LE(0);
+			stream.writeUint32LE(0);
+			stream.writeUint32LE(localOffset);
+		}
+		stream.write(member.name, strlen(member.name));
+	}
+
+	// Build a ZIP file out of members(), compressed with the gzip writer
+	static Common::MemoryWriteStreamDynamic *makeZip() {
+		Common::MemoryWriteStreamDynamic *zip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::MemoryWriteStreamDynamic central(DisposeAfterUse::YES);
+		uint count = 0;
+
+		for (const Member *member = members(); member->name; member++, count++) {
+			byte *data = makeData(member->size, count);
+
+			Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+			Common::WriteStream *compressor = Common::wrapCompressedWriteStream(gzip);
+			compressor->write(data, member->size);
+			compressor->finalize();
+			byte *gzipData = gzip->getData();
+			const uint32 gzipSize = gzip->size();
+			delete compressor;
+
+			// Strip the gzip header and footer around the deflate data
+			const uint32 crc = READ_LE_UINT32(gzipData + gzipSize - 8);
+			const byte *compressed = member->deflate ? gzipData + 10 : data;
+			const uint32 compressedSize = member->deflate ? gzipSize - 18 : member->size;
+
+			const uint32 localOffset = zip->pos();
+			writeHeader(*zip, 0x04034b50, false, *member, crc, compressedSize, 0);
+			zip->write(compressed, compressedSize);
+			writeHeader(central, 0x02014b50, true, *member, crc, compressedSize, localOffset);
+
+			free(gzipData);
+			free(data);
+		}
+
+		const uint32 centralOffset = zip->pos();
+		zip->write(central.getData(), central.size());
+		zip->writeUint32LE(0x06054b50);
+		zip->writeUint16LE(0);
+		zip->writeUint16LE(0);
+		zip->writeUint16LE(count);
+		zip->writeUint16LE(count);
+		zip->writeUint32LE(central.size());
+		zip->writeUint32LE(centralOffset);
+		zip->writeUint16LE(0);
+		return zip;
+	}
+
+	static Common::Archive *openZip(bool mapped) {
+		Common::MemoryWriteStreamDynamic *zip = makeZip();
+		byte *data = (byte *)malloc(zip->size());
+		memcpy(data, zip->getData(), zip->size());
+
+		Common::SeekableReadStream *stream;
+		if (mapped)
+			stream = new Common::MemoryReadStream(data, zip->size(), DisposeAfterUse::YES);
+		else
+			stream = new UnmappedReadStream(data, zip->size());
+		delete zip;
+
+		return Common::makeZipArchive(stream);
+	}
+
+	static bool checkRange(Common::SeekableReadStream *stream, const byte *expected, uint32 pos, uint32 size) {
+		byte *buffer = (byte *)malloc(size + 1);
+		stream->seek(pos);
+		const bool success = stream->read(buffer, size) == size && !memcmp(buffer, expected + pos, size);
+		free(buffer);
+		return success;
+	}
+
+	void checkArchive(bool mapped) {
+		Common::Archive *archive = openZip(mapped);
+		TS_ASSERT(archive);
+
+		Common::Array<Common::SeekableReadStream *> streams;
+		uint count = 0;
+		for (const Member *member = members(); member->name; member++, count++) {
+			byte *data = makeData(member->size, count);
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(member->name);
+			TS_ASSERT(stream);
+			TS_ASSERT_EQUALS(stream->size(), (int32)member->size);
+
+			// Sequential reads, then random ones
+			TS_ASSERT(checkRange(stream, data, 0, member->size));
+			uint32 seed = count;
+			for (int i = 0; i < 64 && member->size; i++) {
+				seed = seed * 1103515245 + 12345;
+				const uint32 pos = (seed >> 8) % member->size;
+				const uint32 size = MIN<uint32>(1 + (seed >> 20), member->size - pos);
+				TS_ASSERT(checkRange(stream, data, pos, size));
+			}
+
+			// Reading past the end
+			byte buffer[16];
+			stream->seek(-(int32)MIN<uint32>(member->size, 4), SEEK_END);
+			TS_ASSERT_EQUALS(stream->read(buffer, 16), MIN<uint32>(member->size, 4));
+			TS_ASSERT(!stream->err());
+			stream->seek(member->size);
+			TS_ASSERT_EQUALS(stream->read(buffer, 1), 0u);
+			TS_ASSERT(stream->eos());
+			stream->seek(0);
+			TS_ASSERT(!stream->eos());
+
+			if (!member->deflate && mapped)
+				TS_ASSERT(stream->getData() && !memcmp(stream->getData(), data, member->size));
+
+			free(data);
+			streams.push_back(stream);
+		}
+
+		// Members remain readable after the archive is gone
+		delete archive;
+		count = 0;
+		for (const Member *member = members(); member->name; member++, count++) {
+			byte *data = makeData(member->size, count);
+			TS_ASSERT(checkRange(streams[count], data, member->size / 2, member->size / 2));
+			delete streams[count];
+			free(data);
+		}
+	}
+
+public:
+	void test_members() {
+#ifdef USE_ZLIB
+		checkArchive(true);
+		checkArchive(false);
+#endif
+	}
+
+	void test_benchmark_members() {
+#ifdef USE_ZLIB
+		if (!Benchmark::enabled())
+			return;
+
+		static const int kOpens = 64;
+		static const int kReads = 4096;
+		static const uint32 kReadSize = 4096;
+		Common::Archive *archive = openZip(true);
+		byte *buffer = new byte[kReadSize];
+
+		// Open a large member to read its start, like a header
+		double start = Benchmark::seconds();
+		for (int i = 0; i < kOpens; i++) {
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember("large.bin");
+			stream->read(buffer, kReadSize);
+			delete stream;
+		}
+		Benchmark::report("ZipArchive open and read header", kOpens * kReadSize, "B", Benchmark::seconds() - start);
+
+		// Random reads in a large member
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("large.bin");
+		uint32 seed = 1;
+		start = Benchmark::seconds();
+		for (int i = 0; i < kReads; i++) {
+			seed = seed * 1103515245 + 12345;
+			stream->seek((seed >> 8) % (stream->size() - kReadSize));
+			stream->read(buffer, kReadSize);
+		}
+		Benchmark::report("ZipArchive random reads", kReads * kReadSize, "B", Benchmark::seconds() - start);
+
+		// Sequential reads
+		start = Benchmark::seconds();
+		stream->seek(0);
+		while (!stream->eos())
+			stream->read(buffer, kReadSize);
+		Benchmark::report("ZipArchive sequential reads", stream->size(), "B", Benchmark::seconds() - start);
+
+		delete stream;
+		delete[] buffer;
+		delete archive;
+#endif
+	}
+};
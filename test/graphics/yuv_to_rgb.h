@@ -0,0 +1,190 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	enum Subsampling {
+		kYUV444,
+		kYUV420,
+		kYUV410
+	};
+
+	struct Image {
+		Common::Array<byte> y, u, v;
+		int width, height, yPitch, uvPitch;
+	};
+
+	static byte nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+	static Image makeImage(Subsampling subsampling, int width, int height, uint32 seed) {
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.yPitch = width + 3;
+
+		int uvWidth = width, uvHeight = height;
+		if (subsampling == kYUV420) {
+			uvWidth = width / 2;
+			uvHeight = height / 2;
+		} else if (subsampling == kYUV410) {
+			// With the extra row and column the interpolation reads
+			uvWidth = width / 4 + 1;
+			uvHeight = height / 4 + 1;
+		}
+		image.uvPitch = uvWidth + 5;
+
+		image.y.resize(image.yPitch * height);
+		image.u.resize(image.uvPitch * uvHeight);
+		image.v.resize(image.uvPitch * uvHeight);
+		for (uint i = 0; i < image.y.size(); i++)
+			image.y[i] = nextRandom(seed);
+		for (uint i = 0; i < image.u.size(); i++) {
+			image.u[i] = nextRandom(seed);
+			image.v[i] = nextRandom(seed);
+		}
+
+		return image;
+	}
+
+	static void convert(Graphics::Surface &dst, Subsampling subsampling, Graphics::YUVToRGBManager::LuminanceScale scale, const Image &image) {
+		switch (subsampling) {
+		case kYUV444:
+			YUVToRGBMan.convert444(&dst, scale, image.y.begin(), image.u.begin(), image.v.begin(), image.width, image.height, image.yPitch, image.uvPitch);
+			break;
+		case kYUV420:
+			YUVToRGBMan.convert420(&dst, scale, image.y.begin(), image.u.begin(), image.v.begin(), image.width, image.height, image.yPitch, image.uvPitch);
+			break;
+		case kYUV410:
+			YUVToRGBMan.convert410(&dst, scale, image.y.begin(), image.u.begin(), image.v.begin(), image.width, image.height, image.yPitch, image.uvPitch);
+			break;
+		}
+	}
+
+	/** Whether the surfaces match, ignoring their padding */
+	static bool equals(const Graphics::Surface &a, const Graphics::Surface &b, int width) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), width * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	/** Check every implementation against the lookup tables */
+	static void checkImplementations(Subsampling subsampling, const Image &image) {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const Graphics::YUVToRGBManager::LuminanceScale scales[] = {
+			Graphics::YUVToRGBManager::kScaleFull,
+			Graphics::YUVToRGBManager::kScaleITU
+		};
+		const Graphics::YUVToRGBManager::Implementation defaultImplementation = YUVToRGBMan.getImplementation();
+
+		for (int f = 0; f < ARRAYSIZE(formats); f++) {
+			for (int s = 0; s < ARRAYSIZE(scales); s++) {
+				Graphics::Surface expected;
+				expected.create(image.width, image.height, formats[f]);
+				YUVToRGBMan.setImplementation(Graphics::YUVToRGBManager::kImplementationTable);
+				convert(expected, subsampling, scales[s], image);
+
+				for (int i = Graphics::YUVToRGBManager::kImplementationSSE2; i <= Graphics::YUVToRGBManager::kImplementationNEON; i++) {
+					if (!YUVToRGBMan.setImplementation((Graphics::YUVToRGBManager::Implementation)i))
+						continue;
+
+					Graphics::Surface actual;
+					actual.create(image.width, image.height, formats[f]);
+					convert(actual, subsampling, scales[s], image);
+					TS_ASSERT(equals(expected, actual, image.width));
+					actual.free();
+				}
+
+				expected.free();
+			}
+		}
+
+		YUVToRGBMan.setImplementation(defaultImplementation);
+	}
+
+public:
+	void test_implementations() {
+		TS_ASSERT(Graphics::YUVToRGBManager::isImplementationSupported(Graphics::YUVToRGBManager::kImplementationTable));
+		TS_ASSERT(Graphics::YUVToRGBManager::isImplementationSupported(YUVToRGBMan.getImplementation()));
+	}
+
+	void test_all_chroma() {
+		// Every combination of u and v, one per pixel
+		Image image = makeImage(kYUV444, 256, 256, 1);
+		for (int v = 0; v < 256; v++) {
+			for (int u = 0; u < 256; u++) {
+				image.u[v * image.uvPitch + u] = u;
+				image.v[v * image.uvPitch + u] = v;
+			}
+		}
+
+		checkImplementations(kYUV444, image);
+	}
+
+	void test_convert444() {
+		checkImplementations(kYUV444, makeImage(kYUV444, 77, 9, 2));
+		checkImplementations(kYUV444, makeImage(kYUV444, 5, 3, 3));
+	}
+
+	void test_convert420() {
+		checkImplementations(kYUV420, makeImage(kYUV420, 102, 10, 4));
+		checkImplementations(kYUV420, makeImage(kYUV420, 6, 2, 5));
+	}
+
+	void test_convert410() {
+		checkImplementations(kYUV410, makeImage(kYUV410, 300, 12, 6));
+		checkImplementations(kYUV410, makeImage(kYUV410, 12, 4, 7));
+	}
+
+	void test_benchmark_yuv_to_rgb() {
+		if (!Benchmark::enabled())
+			return;
+
+		static const int kSizes[][2] = { { 640, 480 }, { 1024, 768 } };
+		static const int kFrames = 100;
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		static const char *const kImplementationNames[] = { "table", "SSE2", "AVX2", "NEON" };
+		const Graphics::YUVToRGBManager::Implementation defaultImplementation = YUVToRGBMan.getImplementation();
+
+		for (int size = 0; size < ARRAYSIZE(kSizes); size++) {
+			const int width = kSizes[size][0], height = kSizes[size][1];
+			const Image image = makeImage(kYUV420, width, height, 8);
+
+			for (int f = 0; f < ARRAYSIZE(formats); f++) {
+				Graphics::Surface dst;
+				dst.create(width, height, formats[f]);
+
+				for (int i = Graphics::YUVToRGBManager::kImplementationTable; i <= Graphics::YUVToRGBManager::kImplementationNEON; i++) {
+					if (!YUVToRGBMan.setImplementation((Graphics::YUVToRGBManager::Implementation)i))
+						continue;
+
+					const double start = Benchmark::seconds();
+					for (int frame = 0; frame < kFrames; frame++)
+						convert(dst, kYUV420, Graphics::YUVToRGBManager::kScaleITU, image);
+
+					const Common::String name = Common::String::format("YUV420 %dx%d to %dbpp, %s",
+						width, height, formats[f].bytesPerPixel * 8, kImplementationNames[i]);
+					Benchmark::report(name.c_str(), (double)kFrames * width * height, "pixel", Benchmark::seconds() - start);
+				}
+
+				dst.free();
+			}
+		}
+
+		YUVToRGBMan.setImplementation(defaultImplementation);
+	}
+};
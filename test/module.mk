@@ -1,20 +1,28 @@
 ######################################################################
 # Unit/regression tests, based on CxxTest.
-# Use the 'test' target to run them.
+# Use the 'test' target to run them, and the 'benchmark' target to run
+# them along with the benchmarks.
 # Edit TESTS and TESTLIBS to add more tests.
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/backends/*.h
+TEST_LIBS    := backends/saves/default/default-saves.o backends/saves/default/savefile-writer.o \
+	backends/saves/savefile.o backends/fs/abstract-fs.o backends/fs/stdiostream.o \
+	audio/libaudio.a graphics/libgraphics.a common/libcommon.a
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
 	TEST_LIBS += engines/wintermute/libwintermute.a
 endif
 
+ifdef USE_BINK
+	TESTS += $(srcdir)/test/video/*.h
+	TEST_LIBS := video/libvideo.a $(TEST_LIBS)
+endif
+
 #
-TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
+TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h --include=$(srcdir)/test/benchmark.h
 TEST_CFLAGS  := $(CFLAGS) -I$(srcdir)/test/cxxtest
 TEST_LDFLAGS := $(LDFLAGS) $(LIBS)
 TEST_CXXFLAGS := $(filter-out -Wglobal-constructors,$(CXXFLAGS))
@@ -42,8 +50,13 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+benchmark: test/benchmark-runner
+	./test/benchmark-runner
+test/benchmark-runner: test/runner.cpp $(TEST_LIBS)
+	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -DTEST_BENCHMARKS -o $@ $+ $(TEST_LDFLAGS)
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark-runner
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
@@ -0,0 +1,401 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/math.h"
+#include "common/memstream.h"
+#include "graphics/surface.h"
+#include "video/bink_decoder.h"
+
+class BinkDecoderTestSuite : public CxxTest::TestSuite {
+	/** The block types of the synthetic videos */
+	enum BlockType {
+		kBlockMotion  = 2,
+		kBlockResidue = 4,
+		kBlockIntra   = 5,
+		kBlockInter   = 7
+	};
+
+	static const int kMaxBlockWidth = 128;
+
+	/** Writes bits in the order the decoder reads them, from the lowest bit of 32-bit words */
+	class BitWriter {
+	public:
+		BitWriter() : _bitCount(0) {}
+
+		void putBit(uint32 bit) {
+			if ((_bitCount & 31) == 0)
+				_words.push_back(0);
+
+			_words.back() |= (bit & 1) << (_bitCount & 31);
+			_bitCount++;
+		}
+
+		void putBits(uint32 value, int count) {
+			for (int i = 0; i < count; i++)
+				putBit(value >> i);
+		}
+
+		/** Write a symbol of the first Huffman tree, whose codes are the raw nibbles */
+		void putNibble(uint32 value) {
+			putBits(value, 4);
+		}
+
+		void align() {
+			while (_bitCount & 31)
+				putBit(0);
+		}
+
+		uint32 size() const { return _words.size() * 4; }
+
+		void writeTo(Common::WriteStream &stream) const {
+			for (uint i = 0; i < _words.size(); i++)
+				stream.writeUint32LE(_words[i]);
+		}
+
+	private:
+		Common::Array<uint32> _words;
+		uint32 _bitCount;
+	};
+
+	static int nextRandom(uint32 &seed, int range) {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) % range;
+	}
+
+	static int randomBetween(uint32 &seed, int min, int max) {
+		return min + nextRandom(seed, max - min + 1);
+	}
+
+	/** The length of an element count of a bundle */
+	static int countLength(uint32 maxCount) {
+		return Common::intLog2(maxCount + 511) + 1;
+	}
+
+	static void putCoefficient(BitWriter &bits, int level, uint32 &seed) {
+		if (level)
+			bits.putBits(nextRandom(seed, 1 << level), level);
+
+		bits.putBit(nextRandom(seed, 2));
+	}
+
+	/**
+	 * Write up to 15 of the lowest frequency DCT coefficients, with the same
+	 * magnitude range, in the format read by readDCTCoeffs().
+	 */
+	static void writeCoefficients(BitWriter &bits, uint32 &seed) {
+		const int level = nextRandom(seed, 15);
+		bits.putBits(level + 1, 4);
+
+		bool groups[3], singles[3];
+		for (int i = 0; i < 3; i++) {
+			groups[i] = nextRandom(seed, 2);
+			singles[i] = nextRandom(seed, 2);
+		}
+
+		// Groups of four coefficients, then single ones. All are read at the
+		// first level, and skipped at the others.
+		for (int l = level; l >= 0; l--) {
+			for (int i = 0; i < 3; i++) {
+				if (l == level && groups[i]) {
+					bits.putBit(1);
+					for (int j = 0; j < 4; j++) {
+						bits.putBit(0);
+						putCoefficient(bits, level, seed);
+					}
+				}
+				bits.putBit(0);
+			}
+
+			for (int i = 0; i < 3; i++) {
+				if (l == level && singles[i]) {
+					bits.putBit(1);
+					putCoefficient(bits, level, seed);
+				} else if (!singles[i]) {
+					bits.putBit(0);
+				}
+			}
+		}
+
+		// Quantizer
+		bits.putBits(nextRandom(seed, 16), 4);
+	}
+
+	/** Write groups of residue coefficients, refined over a few levels, in the format read by readResidue() */
+	static void writeResidue(BitWriter &bits, uint32 &seed) {
+		// More masks than the block can use
+		bits.putBits(127, 7);
+
+		const int levels = nextRandom(seed, 3);
+		bits.putBits(levels, 3);
+
+		bool groups[3];
+		for (int i = 0; i < 3; i++)
+			groups[i] = nextRandom(seed, 2);
+
+		int coefficients = 0;
+		for (int l = levels; l >= 0; l--) {
+			for (int i = 0; i < coefficients; i++)
+				bits.putBit(nextRandom(seed, 2));
+
+			for (int i = 0; i < 3; i++) {
+				if (l == levels && groups[i]) {
+					bits.putBit(1);
+					for (int j = 0; j < 4; j++) {
+						bits.putBit(0);
+						bits.putBit(nextRandom(seed, 2));
+					}
+					coefficients += 4;
+				}
+				bits.putBit(0);
+			}
+
+			// The DC coefficient
+			bits.putBit(0);
+		}
+	}
+
+	static void writeMotionValues(BitWriter &bits, int length, const int *values, int count) {
+		bits.putBits(count, length);
+		bits.putBit(0);
+
+		for (int i = 0; i < count; i++) {
+			bits.putNibble(ABS(values[i]));
+			if (values[i])
+				bits.putBit(values[i] < 0);
+		}
+	}
+
+	/** Write DC values as differences from the previous ones, which must be below 16 */
+	static void writeDCs(BitWriter &bits, int length, const int *values, int count, bool hasSign) {
+		bits.putBits(count, length);
+
+		bits.putBits(ABS(values[0]), hasSign ? 10 : 11);
+		if (values[0] && hasSign)
+			bits.putBit(values[0] < 0);
+
+		for (int i = 1; i < count; i++) {
+			if ((i - 1) % 8 == 0)
+				bits.putBits(4, 4);
+
+			const int difference = values[i] - values[i - 1];
+			bits.putBits(ABS(difference), 4);
+			if (difference)
+				bits.putBit(difference < 0);
+		}
+	}
+
+	static int nextDC(uint32 &seed, int previous, int min, int max) {
+		return CLIP(previous + randomBetween(seed, -15, 15), min, max);
+	}
+
+	/**
+	 * Write a plane where every row has DCT, residue and motion blocks. With
+	 * all the types in every row, none of their bundles runs out of values.
+	 */
+	static void writePlane(BitWriter &bits, int videoWidth, int videoHeight, bool isChroma, uint32 &seed) {
+		static const int kTypes[] = { kBlockIntra, kBlockInter, kBlockResidue, kBlockMotion };
+
+		const int blockWidth  = isChroma ? (videoWidth  + 15) >> 4 : (videoWidth  + 7) >> 3;
+		const int blockHeight = isChroma ? (videoHeight + 15) >> 4 : (videoHeight + 7) >> 3;
+		const int width = MAX(isChroma ? videoWidth >> 1 : videoWidth, 8);
+		const int valueLength = countLength(width >> 3);
+		assert(blockWidth >= ARRAYSIZE(kTypes) && blockWidth <= kMaxBlockWidth);
+
+		// The Huffman trees of all the bundles but the DC ones, and of the
+		// high nibbles of colors, all giving raw nibbles
+		for (int i = 0; i < 7 + 16; i++)
+			bits.putBits(0, 4);
+
+		int intraDC = randomBetween(seed, 0, 2047), interDC = 0;
+		for (int y = 0; y < blockHeight; y++) {
+			int types[kMaxBlockWidth], xOffs[kMaxBlockWidth], yOffs[kMaxBlockWidth];
+			int intraDCs[kMaxBlockWidth], interDCs[kMaxBlockWidth];
+			int motionCount = 0, intraCount = 0, interCount = 0;
+
+			for (int x = 0; x < blockWidth; x++) {
+				types[x] = kTypes[x < ARRAYSIZE(kTypes) ? x : nextRandom(seed, ARRAYSIZE(kTypes))];
+
+				if (types[x] != kBlockIntra) {
+					// Copy from anywhere in the previous plane
+					xOffs[motionCount] = randomBetween(seed, MAX(-15, -x * 8), MIN(15, (blockWidth  - 1 - x) * 8));
+					yOffs[motionCount] = randomBetween(seed, MAX(-15, -y * 8), MIN(15, (blockHeight - 1 - y) * 8));
+					motionCount++;
+				}
+
+				if (types[x] == kBlockIntra)
+					intraDCs[intraCount++] = intraDC = nextDC(seed, intraDC, 0, 2047);
+				else if (types[x] == kBlockInter)
+					interDCs[interCount++] = interDC = nextDC(seed, interDC, -1023, 1023);
+			}
+
+			bits.putBits(blockWidth, valueLength);
+			bits.putBit(0);
+			for (int x = 0; x < blockWidth; x++)
+				bits.putNibble(types[x]);
+
+			// No 16x16 blocks, colors nor patterns
+			if (y == 0) {
+				bits.putBits(0, countLength((width + 7) >> 4));
+				bits.putBits(0, countLength(blockWidth * 64));
+				bits.putBits(0, countLength(blockWidth << 3));
+			}
+
+			writeMotionValues(bits, valueLength, xOffs, motionCount);
+			writeMotionValues(bits, valueLength, yOffs, motionCount);
+			writeDCs(bits, valueLength, intraDCs, intraCount, false);
+			writeDCs(bits, valueLength, interDCs, interCount, true);
+
+			// No runs
+			if (y == 0)
+				bits.putBits(0, countLength(blockWidth * 48));
+
+			for (int x = 0; x < blockWidth; x++) {
+				if (types[x] == kBlockResidue)
+					writeResidue(bits, seed);
+				else if (types[x] == kBlockIntra || types[x] == kBlockInter)
+					writeCoefficients(bits, seed);
+			}
+		}
+
+		bits.align();
+	}
+
+	/** Make a BIKg video without audio */
+	static Common::SeekableReadStream *makeVideo(int width, int height, int frameCount, uint32 seed) {
+		Common::Array<BitWriter> frames;
+		frames.resize(frameCount);
+
+		uint32 largestFrameSize = 0;
+		for (int i = 0; i < frameCount; i++) {
+			writePlane(frames[i], width, height, false, seed);
+			writePlane(frames[i], width, height, true, seed);
+			writePlane(frames[i], width, height, true, seed);
+			largestFrameSize = MAX(largestFrameSize, frames[i].size());
+		}
+
+		const uint32 headerSize = 44 + frameCount * 4;
+		uint32 fileSize = headerSize;
+		for (int i = 0; i < frameCount; i++)
+			fileSize += frames[i].size();
+
+		Common::MemoryWriteStreamDynamic stream(DisposeAfterUse::NO);
+		stream.writeUint32BE(MKTAG('B', 'I', 'K', 'g'));
+		stream.writeUint32LE(fileSize - 8);
+		stream.writeUint32LE(frameCount);
+		stream.writeUint32LE(largestFrameSize);
+		stream.writeUint32LE(0);
+		stream.writeUint32LE(width);
+		stream.writeUint32LE(height);
+		stream.writeUint32LE(15);
+		stream.writeUint32LE(1);
+		stream.writeUint32LE(0);
+		stream.writeUint32LE(0);
+
+		// Only the first frame is a key frame
+		uint32 offset = headerSize;
+		for (int i = 0; i < frameCount; i++) {
+			stream.writeUint32LE(i == 0 ? offset | 1 : offset);
+			offset += frames[i].size();
+		}
+
+		for (int i = 0; i < frameCount; i++)
+			frames[i].writeTo(stream);
+
+		return new Common::MemoryReadStream(stream.getData(), stream.size(), DisposeAfterUse::YES);
+	}
+
+	static int countDifferentRows(const Graphics::Surface &a, const Graphics::Surface &b) {
+		int count = 0;
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				count++;
+		}
+		return count;
+	}
+
+	/** Decode a video with the scalar implementation and another one, which must give the same frames */
+	static void checkImplementation(Video::BinkDecoder::Implementation implementation, int width, int height) {
+		static const int kFrames = 8;
+
+		Video::BinkDecoder reference, decoder;
+		TS_ASSERT(reference.loadStream(makeVideo(width, height, kFrames, width * height)));
+		TS_ASSERT(decoder.loadStream(makeVideo(width, height, kFrames, width * height)));
+
+		for (int frame = 0; frame < kFrames; frame++) {
+			Video::BinkDecoder::setImplementation(Video::BinkDecoder::kImplementationScalar);
+			const Graphics::Surface *expected = reference.decodeNextFrame();
+			Video::BinkDecoder::setImplementation(implementation);
+			const Graphics::Surface *actual = decoder.decodeNextFrame();
+
+			TS_ASSERT(expected && actual);
+			TS_ASSERT_EQUALS(countDifferentRows(*expected, *actual), 0);
+		}
+
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), kFrames - 1);
+	}
+
+public:
+	void test_synthetic_video() {
+		Video::BinkDecoder decoder;
+		TS_ASSERT(decoder.loadStream(makeVideo(120, 72, 2, 1)));
+		TS_ASSERT_EQUALS(decoder.getWidth(), 120);
+		TS_ASSERT_EQUALS(decoder.getHeight(), 72);
+
+		const Graphics::Surface *frame = decoder.decodeNextFrame();
+		Graphics::Surface first;
+		first.copyFrom(*frame);
+
+		// The blocks are not all alike, and change between frames
+		const Graphics::Surface *second = decoder.decodeNextFrame();
+		TS_ASSERT(memcmp(first.getBasePtr(0, 0), first.getBasePtr(0, 40), first.w * first.format.bytesPerPixel));
+		TS_ASSERT(countDifferentRows(first, *second) > 0);
+		TS_ASSERT(decoder.endOfVideo());
+
+		first.free();
+	}
+
+	void test_implementations() {
+		const Video::BinkDecoder::Implementation defaultImplementation = Video::BinkDecoder::getImplementation();
+		TS_ASSERT(Video::BinkDecoder::isImplementationSupported(Video::BinkDecoder::kImplementationScalar));
+		TS_ASSERT(Video::BinkDecoder::isImplementationSupported(defaultImplementation));
+
+		for (int i = Video::BinkDecoder::kImplementationSSE2; i <= Video::BinkDecoder::kImplementationNEON; i++) {
+			const Video::BinkDecoder::Implementation implementation = (Video::BinkDecoder::Implementation)i;
+			if (!Video::BinkDecoder::isImplementationSupported(implementation)) {
+				TS_ASSERT(!Video::BinkDecoder::setImplementation(implementation));
+				continue;
+			}
+
+			checkImplementation(implementation, 120, 72);
+			checkImplementation(implementation, 64, 33);
+		}
+
+		Video::BinkDecoder::setImplementation(defaultImplementation);
+	}
+
+	void test_benchmark_decode() {
+		if (!Benchmark::enabled())
+			return;
+
+		static const int kFrames = 100;
+		static const char *const kImplementationNames[] = { "scalar", "SSE2", "NEON" };
+		const Video::BinkDecoder::Implementation defaultImplementation = Video::BinkDecoder::getImplementation();
+
+		for (int i = Video::BinkDecoder::kImplementationScalar; i <= Video::BinkDecoder::kImplementationNEON; i++) {
+			if (!Video::BinkDecoder::setImplementation((Video::BinkDecoder::Implementation)i))
+				continue;
+
+			Video::BinkDecoder decoder;
+			decoder.loadStream(makeVideo(640, 480, kFrames, 2));
+
+			const double start = Benchmark::seconds();
+			for (int frame = 0; frame < kFrames; frame++)
+				decoder.decodeNextFrame();
+
+			const Common::String name = Common::String::format("Bink 640x480 decode, %s", kImplementationNames[i]);
+			Benchmark::reportRate(name.c_str(), kFrames, "frame", Benchmark::seconds() - start);
+		}
+
+		Video::BinkDecoder::setImplementation(defaultImplementation);
+	}
+};
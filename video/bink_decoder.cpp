@@ -31,6 +31,7 @@
 #include "common/textconsole.h"
 #include "common/math.h"
 #include "common/stream.h"
+#include "common/memstream.h"
 #include "common/substream.h"
 #include "common/file.h"
 #include "common/str.h"
@@ -46,6 +47,14 @@
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BINK_USE_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)) && !defined(SCUMM_BIG_ENDIAN)
+#define BINK_USE_NEON
+#include <arm_neon.h>
+#endif
+
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
 static const uint32 kBIKhID = MKTAG('B', 'I', 'K', 'h');
@@ -162,6 +171,37 @@ void BinkDecoder::readNextPacket() {
 
 	VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
 
+	uint32 frameSize = readAudioPackets(frame);
+
+	uint32 videoPacketStart = _bink->pos();
+	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+
+	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
+			videoPacketStart, videoPacketEnd), DisposeAfterUse::YES);
+
+	videoTrack->decodePacket(frame);
+	videoTrack->increaseCurFrame();
+
+	delete frame.bits;
+	frame.bits = 0;
+}
+
+VideoDecoder::VideoPacket *BinkDecoder::readNextVideoPacket() {
+	BinkVideoTrack *videoTrack = (BinkVideoTrack *)getTrack(0);
+
+	if (videoTrack->endOfTrack())
+		return 0;
+
+	const VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
+
+	BinkVideoPacket *packet = new BinkVideoPacket(readAudioPackets(frame));
+	_bink->read(packet->data, packet->size);
+
+	videoTrack->increaseCurFrame();
+	return packet;
+}
+
+uint32 BinkDecoder::readAudioPackets(const VideoFrame &frame) {
 	if (!_bink->seek(frame.offset))
 		error("Bad bink seek");
 
@@ -200,16 +240,7 @@ void BinkDecoder::readNextPacket() {
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
-
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), DisposeAfterUse::YES);
-
-	videoTrack->decodePacket(frame);
-
-	delete frame.bits;
-	frame.bits = 0;
+	return frameSize;
 }
 
 VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
@@ -222,6 +253,14 @@ VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
 	return (AudioTrack *)track;
 }
 
+BinkDecoder::BinkVideoPacket::BinkVideoPacket(uint32 packetSize) : size(packetSize) {
+	data = (byte *)malloc(size);
+}
+
+BinkDecoder::BinkVideoPacket::~BinkVideoPacket() {
+	free(data);
+}
+
 BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
 }
 
@@ -243,7 +282,8 @@ BinkDecoder::AudioInfo::~AudioInfo() {
 }
 
 BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id) :
-		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id) {
+		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id),
+		_frameStats("video.frames") {
 	_curFrame = -1;
 
 	for (int i = 0; i < 16; i++)
@@ -312,6 +352,9 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_oldPlanes[2],   0, _uvBlockWidth * 8 * _uvBlockHeight * 8);
 	memset(_oldPlanes[3], 255, _yBlockWidth  * 8 * _yBlockHeight  * 8);
 
+	_frameStats.allocated(_surface.pitch * _surfaceHeight +
+		2 * 2 * (_yBlockWidth * 8 * _yBlockHeight * 8 + _uvBlockWidth * 8 * _uvBlockHeight * 8));
+
 	initBundles();
 	initHuffman();
 }
@@ -321,6 +364,7 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
 	}
+	_frameStats.freed(_frameStats.getLiveSize());
 
 	deinitBundles();
 
@@ -365,8 +409,21 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
 		SWAP(_curPlanes[i], _oldPlanes[i]);
+}
+
+const Graphics::Surface *BinkDecoder::BinkVideoTrack::decodeVideoPacket(VideoPacket *packet) {
+	BinkVideoPacket *binkPacket = (BinkVideoPacket *)packet;
 
-	_curFrame++;
+	VideoFrame frame;
+	frame.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(binkPacket->data,
+			binkPacket->size), DisposeAfterUse::YES);
+
+	decodePacket(frame);
+	return &_surface;
+}
+
+void BinkDecoder::BinkVideoTrack::prepareDecodeAhead() {
+	YUVToRGBMan.prepare(_surface.format, Graphics::YUVToRGBManager::kScaleITU);
 }
 
 void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
@@ -816,11 +873,7 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 
 	readResidue(*ctx.video, block, v);
 
-	byte  *dst = ctx.dest;
-	int16 *src = block;
-	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8)
-		for (int j = 0; j < 8; j++)
-			dst[j] += src[j];
+	addBlock(ctx, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
@@ -1323,7 +1376,7 @@ static inline void IDCTCol(int16 *dest, const int16 *src) {
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
+static void IDCTScalar(int16 *block) {
 	int i;
 	int16 temp[64];
 
@@ -1334,26 +1387,390 @@ void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int16 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int16 *block) {
+static void IDCTPutScalar(byte *dest, uint32 pitch, const int16 *block) {
 	int i;
 	int16 temp[64];
 	for (i = 0; i < 8; i++)
 		IDCTCol(&temp[i], &block[i]);
 	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
+		IDCT_ROW( (&dest[i*pitch]), (&temp[8*i]) );
 	}
 }
 
+static void addBlockScalar(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8)
+		for (int j = 0; j < 8; j++)
+			dest[j] += block[j];
+}
+
+static void IDCTAddScalar(byte *dest, uint32 pitch, int16 *block) {
+	IDCTScalar(block);
+	addBlockScalar(dest, pitch, block);
+}
+
+// The vector versions give the same results as the macros above: the
+// transforms are computed with 32-bit values, which are truncated to 16 bits
+// between the passes, and the pixels wrap around instead of saturating.
+
+#ifdef BINK_USE_SSE2
+
+/** Pairs of 16-bit factors, to multiply pairs of coefficients with _mm_madd_epi16 */
+static inline __m128i factorsSSE2(int16 a, int16 b) {
+	return _mm_set1_epi32((int32)(((uint32)(uint16)b << 16) | (uint16)a));
+}
+
+/**
+ * Apply IDCT_TRANSFORM to four columns, given their coefficients
+ * interleaved in pairs: 0 and 4, 2 and 6, 5 and 3, 1 and 7.
+ */
+static inline void IDCTColumnsSSE2(__m128i p04, __m128i p26, __m128i p53, __m128i p17, __m128i *out) {
+	const __m128i sum = factorsSSE2(1, 1);
+	const __m128i diff = factorsSSE2(1, -1);
+
+	const __m128i a0 = _mm_madd_epi16(p04, sum);
+	const __m128i a1 = _mm_madd_epi16(p04, diff);
+	const __m128i a2 = _mm_madd_epi16(p26, sum);
+	const __m128i a3 = _mm_srai_epi32(_mm_madd_epi16(p26, factorsSSE2(A1, -A1)), 11);
+	const __m128i a4 = _mm_madd_epi16(p53, sum);
+	const __m128i a6 = _mm_madd_epi16(p17, sum);
+
+	// The products of a5 and a7 are those of their pairs of coefficients
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(p53, factorsSSE2(A3, -A3)), _mm_madd_epi16(p17, factorsSSE2(A3, -A3))), 11);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(_mm_srai_epi32(_mm_madd_epi16(p53, factorsSSE2(A4, -A4)), 11), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(_mm_srai_epi32(_mm_sub_epi32(_mm_madd_epi16(p17, factorsSSE2(A1, A1)), _mm_madd_epi16(p53, factorsSSE2(A1, A1))), 11), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(_mm_srai_epi32(_mm_madd_epi16(p17, factorsSSE2(A2, -A2)), 11), b3), b1);
+
+	const __m128i c0 = _mm_add_epi32(a0, a2);
+	const __m128i c1 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i c2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+	const __m128i c3 = _mm_sub_epi32(a0, a2);
+
+	out[0] = _mm_add_epi32(c0, b0);
+	out[1] = _mm_add_epi32(c1, b2);
+	out[2] = _mm_add_epi32(c2, b3);
+	out[3] = _mm_sub_epi32(c3, b4);
+	out[4] = _mm_add_epi32(c3, b4);
+	out[5] = _mm_sub_epi32(c2, b3);
+	out[6] = _mm_sub_epi32(c1, b2);
+	out[7] = _mm_sub_epi32(c0, b0);
+}
+
+/** Apply IDCT_TRANSFORM to the columns of eight rows, giving the left and right halves */
+static inline void IDCTPassSSE2(const __m128i *rows, __m128i *left, __m128i *right) {
+	IDCTColumnsSSE2(_mm_unpacklo_epi16(rows[0], rows[4]), _mm_unpacklo_epi16(rows[2], rows[6]),
+			_mm_unpacklo_epi16(rows[5], rows[3]), _mm_unpacklo_epi16(rows[1], rows[7]), left);
+	IDCTColumnsSSE2(_mm_unpackhi_epi16(rows[0], rows[4]), _mm_unpackhi_epi16(rows[2], rows[6]),
+			_mm_unpackhi_epi16(rows[5], rows[3]), _mm_unpackhi_epi16(rows[1], rows[7]), right);
+}
+
+/** Truncate two halves of a row to 16 bits, like storing them into int16 */
+static inline __m128i truncateSSE2(__m128i left, __m128i right) {
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(left, 16), 16), _mm_srai_epi32(_mm_slli_epi32(right, 16), 16));
+}
+
+static inline void transposeSSE2(__m128i *rows) {
+	const __m128i a0 = _mm_unpacklo_epi16(rows[0], rows[1]), a1 = _mm_unpackhi_epi16(rows[0], rows[1]);
+	const __m128i a2 = _mm_unpacklo_epi16(rows[2], rows[3]), a3 = _mm_unpackhi_epi16(rows[2], rows[3]);
+	const __m128i a4 = _mm_unpacklo_epi16(rows[4], rows[5]), a5 = _mm_unpackhi_epi16(rows[4], rows[5]);
+	const __m128i a6 = _mm_unpacklo_epi16(rows[6], rows[7]), a7 = _mm_unpackhi_epi16(rows[6], rows[7]);
+
+	const __m128i b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2);
+	const __m128i b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3);
+	const __m128i b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6);
+	const __m128i b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7);
+
+	rows[0] = _mm_unpacklo_epi64(b0, b4); rows[1] = _mm_unpackhi_epi64(b0, b4);
+	rows[2] = _mm_unpacklo_epi64(b1, b5); rows[3] = _mm_unpackhi_epi64(b1, b5);
+	rows[4] = _mm_unpacklo_epi64(b2, b6); rows[5] = _mm_unpackhi_epi64(b2, b6);
+	rows[6] = _mm_unpacklo_epi64(b3, b7); rows[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/** Transform a block into eight rows of 16-bit values */
+static inline void IDCTRowsSSE2(const int16 *block, __m128i *rows) {
+	__m128i left[8], right[8];
+
+	for (int i = 0; i < 8; i++)
+		rows[i] = _mm_loadu_si128((const __m128i *)(block + i * 8));
+
+	// The columns, then the rows as columns of the transposed block
+	IDCTPassSSE2(rows, left, right);
+	for (int i = 0; i < 8; i++)
+		rows[i] = truncateSSE2(left[i], right[i]);
+	transposeSSE2(rows);
+
+	IDCTPassSSE2(rows, left, right);
+	const __m128i round = _mm_set1_epi32(0x7F);
+	for (int i = 0; i < 8; i++)
+		rows[i] = truncateSSE2(_mm_srai_epi32(_mm_add_epi32(left[i], round), 8), _mm_srai_epi32(_mm_add_epi32(right[i], round), 8));
+	transposeSSE2(rows);
+}
+
+/** Keep the low bytes of two rows, like storing them into bytes */
+static inline __m128i lowBytesSSE2(__m128i row0, __m128i row1) {
+	const __m128i mask = _mm_set1_epi16(0xFF);
+	return _mm_packus_epi16(_mm_and_si128(row0, mask), _mm_and_si128(row1, mask));
+}
+
+static inline void storeRowsSSE2(byte *dest, uint32 pitch, __m128i pixels) {
+	_mm_storel_epi64((__m128i *)dest, pixels);
+	_mm_storel_epi64((__m128i *)(dest + pitch), _mm_srli_si128(pixels, 8));
+}
+
+static inline void addRowsSSE2(byte *dest, uint32 pitch, const __m128i *rows) {
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2) {
+		const __m128i pixels = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)dest), _mm_loadl_epi64((const __m128i *)(dest + pitch)));
+		storeRowsSSE2(dest, pitch, _mm_add_epi8(pixels, lowBytesSSE2(rows[i], rows[i + 1])));
+	}
+}
+
+static void IDCTSSE2(int16 *block) {
+	__m128i rows[8];
+	IDCTRowsSSE2(block, rows);
+
+	for (int i = 0; i < 8; i++)
+		_mm_storeu_si128((__m128i *)(block + i * 8), rows[i]);
+}
+
+static void IDCTPutSSE2(byte *dest, uint32 pitch, const int16 *block) {
+	__m128i rows[8];
+	IDCTRowsSSE2(block, rows);
+
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2)
+		storeRowsSSE2(dest, pitch, lowBytesSSE2(rows[i], rows[i + 1]));
+}
+
+static void IDCTAddSSE2(byte *dest, uint32 pitch, int16 *block) {
+	__m128i rows[8];
+	IDCTRowsSSE2(block, rows);
+	addRowsSSE2(dest, pitch, rows);
+}
+
+static void addBlockSSE2(byte *dest, uint32 pitch, const int16 *block) {
+	__m128i rows[8];
+	for (int i = 0; i < 8; i++)
+		rows[i] = _mm_loadu_si128((const __m128i *)(block + i * 8));
+
+	addRowsSSE2(dest, pitch, rows);
+}
+
+#endif
+
+#ifdef BINK_USE_NEON
+
+/** Apply IDCT_TRANSFORM to four columns */
+static inline void IDCTColumnsNEON(const int32x4_t *s, int32x4_t *out) {
+	const int32x4_t a0 = vaddq_s32(s[0], s[4]);
+	const int32x4_t a1 = vsubq_s32(s[0], s[4]);
+	const int32x4_t a2 = vaddq_s32(s[2], s[6]);
+	const int32x4_t a3 = vshrq_n_s32(vmulq_n_s32(vsubq_s32(s[2], s[6]), A1), 11);
+	const int32x4_t a4 = vaddq_s32(s[5], s[3]);
+	const int32x4_t a5 = vsubq_s32(s[5], s[3]);
+	const int32x4_t a6 = vaddq_s32(s[1], s[7]);
+	const int32x4_t a7 = vsubq_s32(s[1], s[7]);
+
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = vshrq_n_s32(vmulq_n_s32(vaddq_s32(a5, a7), A3), 11);
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(vshrq_n_s32(vmulq_n_s32(a5, A4), 11), b0), b1);
+	const int32x4_t b3 = vsubq_s32(vshrq_n_s32(vmulq_n_s32(vsubq_s32(a6, a4), A1), 11), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(vshrq_n_s32(vmulq_n_s32(a7, A2), 11), b3), b1);
+
+	const int32x4_t c0 = vaddq_s32(a0, a2);
+	const int32x4_t c1 = vsubq_s32(vaddq_s32(a1, a3), a2);
+	const int32x4_t c2 = vaddq_s32(vsubq_s32(a1, a3), a2);
+	const int32x4_t c3 = vsubq_s32(a0, a2);
+
+	out[0] = vaddq_s32(c0, b0);
+	out[1] = vaddq_s32(c1, b2);
+	out[2] = vaddq_s32(c2, b3);
+	out[3] = vsubq_s32(c3, b4);
+	out[4] = vaddq_s32(c3, b4);
+	out[5] = vsubq_s32(c2, b3);
+	out[6] = vsubq_s32(c1, b2);
+	out[7] = vsubq_s32(c0, b0);
+}
+
+/** Apply IDCT_TRANSFORM to the columns of eight rows, giving the left and right halves */
+static inline void IDCTPassNEON(const int16x8_t *rows, int32x4_t *left, int32x4_t *right) {
+	int32x4_t s[8];
+
+	for (int i = 0; i < 8; i++)
+		s[i] = vmovl_s16(vget_low_s16(rows[i]));
+	IDCTColumnsNEON(s, left);
+
+	for (int i = 0; i < 8; i++)
+		s[i] = vmovl_s16(vget_high_s16(rows[i]));
+	IDCTColumnsNEON(s, right);
+}
+
+static inline void transposeNEON(int16x8_t *rows) {
+	const int16x8x2_t a01 = vzipq_s16(rows[0], rows[1]);
+	const int16x8x2_t a23 = vzipq_s16(rows[2], rows[3]);
+	const int16x8x2_t a45 = vzipq_s16(rows[4], rows[5]);
+	const int16x8x2_t a67 = vzipq_s16(rows[6], rows[7]);
+
+	const int32x4x2_t b01 = vzipq_s32(vreinterpretq_s32_s16(a01.val[0]), vreinterpretq_s32_s16(a23.val[0]));
+	const int32x4x2_t b23 = vzipq_s32(vreinterpretq_s32_s16(a01.val[1]), vreinterpretq_s32_s16(a23.val[1]));
+	const int32x4x2_t b45 = vzipq_s32(vreinterpretq_s32_s16(a45.val[0]), vreinterpretq_s32_s16(a67.val[0]));
+	const int32x4x2_t b67 = vzipq_s32(vreinterpretq_s32_s16(a45.val[1]), vreinterpretq_s32_s16(a67.val[1]));
+
+	for (int i = 0; i < 2; i++) {
+		const int16x8_t low0 = vreinterpretq_s16_s32(b01.val[i]), high0 = vreinterpretq_s16_s32(b45.val[i]);
+		const int16x8_t low1 = vreinterpretq_s16_s32(b23.val[i]), high1 = vreinterpretq_s16_s32(b67.val[i]);
+
+		rows[i * 2 + 0] = vcombine_s16(vget_low_s16(low0), vget_low_s16(high0));
+		rows[i * 2 + 1] = vcombine_s16(vget_high_s16(low0), vget_high_s16(high0));
+		rows[i * 2 + 4] = vcombine_s16(vget_low_s16(low1), vget_low_s16(high1));
+		rows[i * 2 + 5] = vcombine_s16(vget_high_s16(low1), vget_high_s16(high1));
+	}
+}
+
+/** Transform a block into eight rows of 16-bit values */
+static inline void IDCTRowsNEON(const int16 *block, int16x8_t *rows) {
+	int32x4_t left[8], right[8];
+
+	for (int i = 0; i < 8; i++)
+		rows[i] = vld1q_s16(block + i * 8);
+
+	// The columns, then the rows as columns of the transposed block
+	IDCTPassNEON(rows, left, right);
+	for (int i = 0; i < 8; i++)
+		rows[i] = vcombine_s16(vmovn_s32(left[i]), vmovn_s32(right[i]));
+	transposeNEON(rows);
+
+	IDCTPassNEON(rows, left, right);
+	const int32x4_t round = vdupq_n_s32(0x7F);
+	for (int i = 0; i < 8; i++)
+		rows[i] = vcombine_s16(vmovn_s32(vshrq_n_s32(vaddq_s32(left[i], round), 8)), vmovn_s32(vshrq_n_s32(vaddq_s32(right[i], round), 8)));
+	transposeNEON(rows);
+}
+
+static inline uint8x8_t lowBytesNEON(int16x8_t row) {
+	return vmovn_u16(vreinterpretq_u16_s16(row));
+}
+
+static inline void addRowsNEON(byte *dest, uint32 pitch, const int16x8_t *rows) {
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), lowBytesNEON(rows[i])));
+}
+
+static void IDCTNEON(int16 *block) {
+	int16x8_t rows[8];
+	IDCTRowsNEON(block, rows);
+
+	for (int i = 0; i < 8; i++)
+		vst1q_s16(block + i * 8, rows[i]);
+}
+
+static void IDCTPutNEON(byte *dest, uint32 pitch, const int16 *block) {
+	int16x8_t rows[8];
+	IDCTRowsNEON(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, lowBytesNEON(rows[i]));
+}
+
+static void IDCTAddNEON(byte *dest, uint32 pitch, int16 *block) {
+	int16x8_t rows[8];
+	IDCTRowsNEON(block, rows);
+	addRowsNEON(dest, pitch, rows);
+}
+
+static void addBlockNEON(byte *dest, uint32 pitch, const int16 *block) {
+	int16x8_t rows[8];
+	for (int i = 0; i < 8; i++)
+		rows[i] = vld1q_s16(block + i * 8);
+
+	addRowsNEON(dest, pitch, rows);
+}
+
+#endif
+
+/** The IDCT and the block additions of an implementation */
+struct BlockFunctions {
+	void (*IDCT)(int16 *block);
+	void (*IDCTPut)(byte *dest, uint32 pitch, const int16 *block);
+	void (*IDCTAdd)(byte *dest, uint32 pitch, int16 *block);
+	void (*addBlock)(byte *dest, uint32 pitch, const int16 *block);
+};
+
+static const BlockFunctions s_blockFunctionsScalar = { IDCTScalar, IDCTPutScalar, IDCTAddScalar, addBlockScalar };
+
+#if defined(BINK_USE_SSE2)
+static const BlockFunctions s_blockFunctionsSSE2 = { IDCTSSE2, IDCTPutSSE2, IDCTAddSSE2, addBlockSSE2 };
+static const BlockFunctions *s_blockFunctions = &s_blockFunctionsSSE2;
+#elif defined(BINK_USE_NEON)
+static const BlockFunctions s_blockFunctionsNEON = { IDCTNEON, IDCTPutNEON, IDCTAddNEON, addBlockNEON };
+static const BlockFunctions *s_blockFunctions = &s_blockFunctionsNEON;
+#else
+static const BlockFunctions *s_blockFunctions = &s_blockFunctionsScalar;
+#endif
+
+bool BinkDecoder::isImplementationSupported(Implementation implementation) {
+	switch (implementation) {
+	case kImplementationScalar:
+		return true;
+#ifdef BINK_USE_SSE2
+	case kImplementationSSE2:
+		return true;
+#endif
+#ifdef BINK_USE_NEON
+	case kImplementationNEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+bool BinkDecoder::setImplementation(Implementation implementation) {
+	switch (implementation) {
+	case kImplementationScalar:
+		s_blockFunctions = &s_blockFunctionsScalar;
+		return true;
+#ifdef BINK_USE_SSE2
+	case kImplementationSSE2:
+		s_blockFunctions = &s_blockFunctionsSSE2;
+		return true;
+#endif
+#ifdef BINK_USE_NEON
+	case kImplementationNEON:
+		s_blockFunctions = &s_blockFunctionsNEON;
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+BinkDecoder::Implementation BinkDecoder::getImplementation() {
+#ifdef BINK_USE_SSE2
+	if (s_blockFunctions == &s_blockFunctionsSSE2)
+		return kImplementationSSE2;
+#endif
+#ifdef BINK_USE_NEON
+	if (s_blockFunctions == &s_blockFunctionsNEON)
+		return kImplementationNEON;
+#endif
+	return kImplementationScalar;
+}
+
+void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
+	s_blockFunctions->IDCT(block);
+}
+
+void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int16 *block) {
+	s_blockFunctions->IDCTAdd(ctx.dest, ctx.pitch, block);
+}
+
+void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int16 *block) {
+	s_blockFunctions->IDCTPut(ctx.dest, ctx.pitch, block);
+}
+
+void BinkDecoder::BinkVideoTrack::addBlock(DecodeContext &ctx, const int16 *block) {
+	s_blockFunctions->addBlock(ctx.dest, ctx.pitch, block);
+}
+
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio, Audio::Mixer::SoundType soundType) :
 		AudioTrack(soundType),
 		_audioInfo(&audio) {
@@ -33,6 +33,7 @@
 
 #include "common/array.h"
 #include "common/bitstream.h"
+#include "common/memory-stats.h"
 #include "common/rational.h"
 
 #include "video/video_decoder.h"
@@ -72,8 +73,33 @@ public:
 	bool loadStream(Common::SeekableReadStream *stream);
 	void close();
 
+	/** The implementations of the IDCT and of the block additions */
+	enum Implementation {
+		kImplementationScalar,
+		kImplementationSSE2,
+		kImplementationNEON
+	};
+
+	/** Whether an implementation is built in. */
+	static bool isImplementationSupported(Implementation implementation);
+
+	/**
+	 * Select the implementation of the IDCT and of the block additions used
+	 * by all the Bink decoders. The fastest supported one is used by default.
+	 * They all produce the same output, so this is mostly useful to test and
+	 * benchmark them.
+	 *
+	 * @return whether the implementation is supported
+	 */
+	static bool setImplementation(Implementation implementation);
+
+	/** Get the implementation of the IDCT and of the block additions. */
+	static Implementation getImplementation();
+
 protected:
 	void readNextPacket();
+	bool supportsDecodeAhead() const { return true; }
+	VideoPacket *readNextVideoPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
 	AudioTrack *getAudioTrack(int index);
 
@@ -139,6 +165,15 @@ private:
 		~VideoFrame();
 	};
 
+	/** The video data of a frame, read ahead of its decoding. */
+	struct BinkVideoPacket : public VideoPacket {
+		byte *data;
+		uint32 size;
+
+		BinkVideoPacket(uint32 packetSize);
+		~BinkVideoPacket();
+	};
+
 	class BinkVideoTrack : public FixedRateVideoTrack {
 	public:
 		BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id);
@@ -151,6 +186,11 @@ private:
 		int getFrameCount() const { return _frameCount; }
 		const Graphics::Surface *decodeNextFrame() { return &_surface; }
 
+		const Graphics::Surface *decodeVideoPacket(VideoPacket *packet);
+		void prepareDecodeAhead();
+
+		void increaseCurFrame() { _curFrame++; }
+
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
 
@@ -262,6 +302,8 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		Common::MemoryCounter _frameStats; ///< Memory of the surface and planes.
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -321,6 +363,9 @@ private:
 		void IDCT(int16 *block);
 		void IDCTPut(DecodeContext &ctx, int16 *block);
 		void IDCTAdd(DecodeContext &ctx, int16 *block);
+
+		/** Add a block of residue to the destination. */
+		void addBlock(DecodeContext &ctx, const int16 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -358,6 +403,12 @@ private:
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
 	void initAudioTrack(AudioInfo &audio);
+
+	/**
+	 * Seek to a frame and decode its audio packets.
+	 * @return the size of the video packet which follows
+	 */
+	uint32 readAudioPackets(const VideoFrame &frame);
 };
 
 } // End of namespace Video
@@ -29,6 +29,7 @@
 #include "common/endian.h"
 #include "common/util.h"
 #include "common/stream.h"
+#include "common/memstream.h"
 #include "common/bitstream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -419,22 +420,42 @@ bool SmackerDecoder::rewind() {
 void SmackerDecoder::readNextPacket() {
 	SmackerVideoTrack *videoTrack = (SmackerVideoTrack *)getTrack(0);
 
-	if (videoTrack->endOfTrack())
+	VideoPacket *packet = readNextVideoPacket();
+	if (!packet)
 		return;
 
+	videoTrack->decodeVideoPacket(packet);
+	delete packet;
+}
+
+VideoDecoder::VideoPacket *SmackerDecoder::readNextVideoPacket() {
+	SmackerVideoTrack *videoTrack = (SmackerVideoTrack *)getTrack(0);
+
+	if (videoTrack->endOfTrack())
+		return 0;
+
 	videoTrack->increaseCurFrame();
 
+	SmackerVideoPacket *packet = new SmackerVideoPacket();
+
 	uint i;
 	uint32 chunkSize = 0;
 	uint32 dataSizeUnpacked = 0;
 
 	uint32 startPos = _fileStream->pos();
 
-	// Check if we got a frame with palette data, and
-	// call back the virtual setPalette function to set
-	// the current palette
-	if (_frameTypes[videoTrack->getCurFrame()] & 1)
-		videoTrack->unpackPalette(_fileStream);
+	// Check if we got a frame with palette data, which is unpacked when
+	// the frame is decoded
+	if (_frameTypes[videoTrack->getCurFrame()] & 1) {
+		packet->paletteSize = 4 * _fileStream->readByte();
+		_fileStream->seek(startPos);
+
+		packet->palette = (byte *)malloc(packet->paletteSize + 1);
+		// Padding for the byte following the chunk, which unpackPalette() reads
+		packet->palette[packet->paletteSize] = 0x00;
+
+		_fileStream->read(packet->palette, packet->paletteSize);
+	}
 
 	// Load audio tracks
 	for (i = 0; i < 7; ++i) {
@@ -460,18 +481,16 @@ void SmackerDecoder::readNextPacket() {
 	if (_fileStream->pos() - startPos > frameSize)
 		error("Smacker actual frame size exceeds recorded frame size");
 
-	uint32 frameDataSize = frameSize - (_fileStream->pos() - startPos);
+	packet->frameDataSize = frameSize - (_fileStream->pos() - startPos);
 
-	byte *frameData = (byte *)malloc(frameDataSize + 1);
+	packet->frameData = (byte *)malloc(packet->frameDataSize + 1);
 	// Padding to keep the BigHuffmanTrees from reading past the data end
-	frameData[frameDataSize] = 0x00;
+	packet->frameData[packet->frameDataSize] = 0x00;
 
-	_fileStream->read(frameData, frameDataSize);
-
-	Common::BitStreamMemory8LSB bs(new Common::BitStreamMemoryStream(frameData, frameDataSize + 1, DisposeAfterUse::YES), DisposeAfterUse::YES);
-	videoTrack->decodeFrame(bs);
+	_fileStream->read(packet->frameData, packet->frameDataSize);
 
 	_fileStream->seek(startPos + frameSize);
+	return packet;
 }
 
 void SmackerDecoder::handleAudioTrack(byte track, uint32 chunkSize, uint32 unpackedSize) {
@@ -517,6 +536,14 @@ VideoDecoder::AudioTrack *SmackerDecoder::getAudioTrack(int index) {
 	return (AudioTrack *)track;
 }
 
+SmackerDecoder::SmackerVideoPacket::SmackerVideoPacket() : palette(0), paletteSize(0), frameData(0), frameDataSize(0) {
+}
+
+SmackerDecoder::SmackerVideoPacket::~SmackerVideoPacket() {
+	free(palette);
+	free(frameData);
+}
+
 SmackerDecoder::SmackerVideoTrack::SmackerVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, uint32 flags, uint32 signature) {
 	_surface = new Graphics::Surface();
 	_surface->create(width, height * (flags ? 2 : 1), Graphics::PixelFormat::createFormatCLUT8());
@@ -700,6 +727,20 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStreamMemory8LSB
 	}
 }
 
+const Graphics::Surface *SmackerDecoder::SmackerVideoTrack::decodeVideoPacket(VideoPacket *packet) {
+	SmackerVideoPacket *smackerPacket = (SmackerVideoPacket *)packet;
+
+	if (smackerPacket->palette) {
+		Common::MemoryReadStream paletteStream(smackerPacket->palette, smackerPacket->paletteSize + 1);
+		unpackPalette(&paletteStream);
+	}
+
+	Common::BitStreamMemory8LSB bs(new Common::BitStreamMemoryStream(smackerPacket->frameData, smackerPacket->frameDataSize + 1), DisposeAfterUse::YES);
+	decodeFrame(bs);
+
+	return decodeNextFrame();
+}
+
 void SmackerDecoder::SmackerVideoTrack::unpackPalette(Common::SeekableReadStream *stream) {
 	uint startPos = stream->pos();
 	uint32 len = 4 * stream->readByte();
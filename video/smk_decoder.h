@@ -69,11 +69,24 @@ public:
 
 protected:
 	void readNextPacket();
+	bool supportsDecodeAhead() const { return true; }
+	VideoPacket *readNextVideoPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
 	AudioTrack *getAudioTrack(int index);
 
 	virtual void handleAudioTrack(byte track, uint32 chunkSize, uint32 unpackedSize);
 
+	/** The palette and video data of a frame, read ahead of its decoding. */
+	struct SmackerVideoPacket : public VideoPacket {
+		byte *palette;
+		uint32 paletteSize;
+		byte *frameData;
+		uint32 frameDataSize;
+
+		SmackerVideoPacket();
+		~SmackerVideoPacket();
+	};
+
 	class SmackerVideoTrack : public FixedRateVideoTrack {
 	public:
 		SmackerVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, uint32 flags, uint32 signature);
@@ -91,6 +104,8 @@ protected:
 		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
 		bool hasDirtyPalette() const { return _dirtyPalette; }
 
+		const Graphics::Surface *decodeVideoPacket(VideoPacket *packet);
+
 		void readTrees(Common::BitStreamMemory8LSB &bs, uint32 mMapSize, uint32 mClrSize, uint32 fullSize, uint32 typeSize);
 		void increaseCurFrame() { _curFrame++; }
 		void decodeFrame(Common::BitStreamMemory8LSB &bs);
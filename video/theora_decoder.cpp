@@ -249,7 +249,46 @@ void TheoraDecoder::readNextPacket() {
 	ensureAudioBufferSize();
 }
 
-TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &format, th_info &theoraInfo, th_setup_info *theoraSetup) {
+VideoDecoder::VideoPacket *TheoraDecoder::readNextVideoPacket() {
+	TheoraVideoPacket *packet = 0;
+
+	if (_hasVideo) {
+		while (!packet && !_videoTrack->endOfTrack()) {
+			if (ogg_stream_packetout(&_theoraOut, &_oggPacket) > 0) {
+				// Empty packets repeat the previous frame, and are skipped
+				// like in readNextPacket()
+				if (_oggPacket.bytes > 0) {
+					packet = new TheoraVideoPacket(_oggPacket);
+					_videoTrack->increaseCurFrame(_oggPacket.granulepos);
+				}
+			} else if (_theoraOut.e_o_s || _fileStream->eos()) {
+				_videoTrack->setEndOfVideo();
+			} else {
+				bufferData();
+				while (ogg_sync_pageout(&_oggSync, &_oggPage) > 0)
+					queuePage(&_oggPage);
+			}
+
+			queueAudio();
+		}
+	}
+
+	ensureAudioBufferSize();
+	return packet;
+}
+
+TheoraDecoder::TheoraVideoPacket::TheoraVideoPacket(const ogg_packet &oggPacket) : packet(oggPacket) {
+	// The data belongs to the ogg stream, which reuses it for the next packets
+	packet.packet = (unsigned char *)malloc(oggPacket.bytes);
+	memcpy(packet.packet, oggPacket.packet, oggPacket.bytes);
+}
+
+TheoraDecoder::TheoraVideoPacket::~TheoraVideoPacket() {
+	free(packet.packet);
+}
+
+TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &format, th_info &theoraInfo, th_setup_info *theoraSetup) :
+		_frameStats("video.frames") {
 	_theoraDecode = th_decode_alloc(&theoraInfo, theoraSetup);
 
 	if (theoraInfo.pixel_fmt != TH_PF_420)
@@ -260,6 +299,7 @@ TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &f
 	th_decode_ctl(_theoraDecode, TH_DECCTL_SET_PPLEVEL, &postProcessingMax, sizeof(postProcessingMax));
 
 	_surface.create(theoraInfo.frame_width, theoraInfo.frame_height, format);
+	_frameStats.allocated(_surface.pitch * _surface.h);
 
 	// Set up a display surface
 	_displaySurface.init(theoraInfo.pic_width, theoraInfo.pic_height, _surface.pitch,
@@ -276,34 +316,54 @@ TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &f
 TheoraDecoder::TheoraVideoTrack::~TheoraVideoTrack() {
 	th_decode_free(_theoraDecode);
 
+	_frameStats.freed(_surface.pitch * _surface.h);
 	_surface.free();
 	_displaySurface.setPixels(0);
 }
 
 bool TheoraDecoder::TheoraVideoTrack::decodePacket(ogg_packet &oggPacket) {
 	if (th_decode_packetin(_theoraDecode, &oggPacket, 0) == 0) {
-		_curFrame++;
+		convertFrame();
+		increaseCurFrame(oggPacket.granulepos);
+		return true;
+	}
+
+	return false;
+}
 
-		// Convert YUV data to RGB data
-		th_ycbcr_buffer yuv;
-		th_decode_ycbcr_out(_theoraDecode, yuv);
-		translateYUVtoRGBA(yuv);
+const Graphics::Surface *TheoraDecoder::TheoraVideoTrack::decodeVideoPacket(VideoPacket *packet) {
+	if (th_decode_packetin(_theoraDecode, &((TheoraVideoPacket *)packet)->packet, 0) == 0)
+		convertFrame();
 
-		double time = th_granule_time(_theoraDecode, oggPacket.granulepos);
+	return &_displaySurface;
+}
 
-		// We need to calculate when the next frame should be shown
-		// This is all in floating point because that's what the Ogg code gives us
-		// Ogg is a lossy container format, so it doesn't always list the time to the
-		// next frame. In such cases, we need to calculate it ourselves.
-		if (time == -1.0)
-			_nextFrameStartTime += _frameRate.getInverse().toDouble();
-		else
-			_nextFrameStartTime = time;
+void TheoraDecoder::TheoraVideoTrack::prepareDecodeAhead() {
+	YUVToRGBMan.prepare(_surface.format, Graphics::YUVToRGBManager::kScaleITU);
+}
 
-		return true;
-	}
+void TheoraDecoder::TheoraVideoTrack::increaseCurFrame(ogg_int64_t granulePos) {
+	_curFrame++;
+
+	// This only reads the stream info of the decoder, so it does not get in
+	// the way of frames decoded ahead
+	double time = th_granule_time(_theoraDecode, granulePos);
+
+	// We need to calculate when the next frame should be shown
+	// This is all in floating point because that's what the Ogg code gives us
+	// Ogg is a lossy container format, so it doesn't always list the time to the
+	// next frame. In such cases, we need to calculate it ourselves.
+	if (time == -1.0)
+		_nextFrameStartTime += _frameRate.getInverse().toDouble();
+	else
+		_nextFrameStartTime = time;
+}
 
-	return false;
+void TheoraDecoder::TheoraVideoTrack::convertFrame() {
+	// Convert YUV data to RGB data
+	th_ycbcr_buffer yuv;
+	th_decode_ycbcr_out(_theoraDecode, yuv);
+	translateYUVtoRGBA(yuv);
 }
 
 enum TheoraYUVBuffers {
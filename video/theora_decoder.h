@@ -27,6 +27,7 @@
 #ifndef VIDEO_THEORA_DECODER_H
 #define VIDEO_THEORA_DECODER_H
 
+#include "common/memory-stats.h"
 #include "common/rational.h"
 #include "video/video_decoder.h"
 #include "audio/mixer.h"
@@ -73,8 +74,18 @@ public:
 
 protected:
 	void readNextPacket();
+	bool supportsDecodeAhead() const { return true; }
+	VideoPacket *readNextVideoPacket();
 
 private:
+	/** A copy of a video packet, read ahead of its decoding. */
+	struct TheoraVideoPacket : public VideoPacket {
+		ogg_packet packet;
+
+		TheoraVideoPacket(const ogg_packet &oggPacket);
+		~TheoraVideoPacket();
+	};
+
 	class TheoraVideoTrack : public VideoTrack {
 	public:
 		TheoraVideoTrack(const Graphics::PixelFormat &format, th_info &theoraInfo, th_setup_info *theoraSetup);
@@ -89,6 +100,11 @@ private:
 		const Graphics::Surface *decodeNextFrame() { return &_displaySurface; }
 
 		bool decodePacket(ogg_packet &oggPacket);
+		const Graphics::Surface *decodeVideoPacket(VideoPacket *packet);
+		void prepareDecodeAhead();
+
+		/** Move to the frame of a packet, which ends at the given granule position */
+		void increaseCurFrame(ogg_int64_t granulePos);
 		void setEndOfVideo() { _endOfVideo = true; }
 
 	private:
@@ -99,9 +115,11 @@ private:
 
 		Graphics::Surface _surface;
 		Graphics::Surface _displaySurface;
+		Common::MemoryCounter _frameStats;
 
 		th_dec_ctx *_theoraDecode;
 
+		void convertFrame();
 		void translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer);
 	};
 
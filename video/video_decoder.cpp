@@ -27,12 +27,75 @@
 
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/rect.h"
 #include "common/system.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+/**
+ * Frames decoded ahead by the worker thread, in a ring of size frames + 1.
+ * The caller reads the packets into the ring, and posts packetsReady for
+ * each. The worker decodes them in order, and posts framesReady for each.
+ * The slot before the read position holds the frame returned last, which
+ * the caller may still be using, so it is never refilled.
+ */
+struct VideoDecoder::DecodeAheadQueue {
+	struct Frame {
+		Graphics::Surface surface;
+		bool hasSurface;
+		bool hasPalette;
+		byte palette[256 * 3];
+
+		// Handed to the worker, which deletes it once decoded
+		VideoPacket *packet;
+
+		// State of the track after reading the packet
+		int curFrame;
+		uint32 nextFrameStartTime;
+		bool endOfTrack;
+
+		Frame() : hasSurface(false), hasPalette(false), packet(0), curFrame(-1), nextFrameStartTime(0), endOfTrack(false) {}
+	};
+
+	Common::Array<Frame> frames;
+
+	// The track being decoded ahead, or 0
+	VideoTrack *track;
+
+	// State of the track after the last frame returned to the caller
+	int curFrame;
+	uint32 nextFrameStartTime;
+	bool endOfTrack;
+	byte palette[256 * 3];
+
+	OSystem::ThreadRef thread;
+	OSystem::SemaphoreRef packetsReady;
+	OSystem::SemaphoreRef framesReady;
+
+	// Used by the caller only: the next frame to return, the number of
+	// packets read since, and whether the track has no packet left
+	uint read;
+	uint count;
+	bool end;
+
+	// Used by the worker only: the next frame to decode
+	uint decode;
+
+	// Set by the caller before a last post of packetsReady
+	bool stop;
+
+	DecodeAheadQueue() : track(0), curFrame(-1), nextFrameStartTime(0), endOfTrack(false), thread(0),
+		packetsReady(0), framesReady(0), read(0), count(0), end(false), decode(0), stop(false) {}
+
+	~DecodeAheadQueue() {
+		for (uint i = 0; i < frames.size(); i++)
+			frames[i].surface.free();
+	}
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -49,15 +112,27 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAheadFrames = 0;
+	_decodeAheadFailed = false;
+	_decodeAhead = 0;
 
-	// Find the best format for output
-	_defaultHighColorFormat = g_system->getScreenFormat();
+	// Find the best format for output. Without a system, e.g. in the unit
+	// tests, fall back to 32bpp.
+	if (g_system)
+		_defaultHighColorFormat = g_system->getScreenFormat();
 
-	if (_defaultHighColorFormat.bytesPerPixel == 1)
+	if (_defaultHighColorFormat.bytesPerPixel <= 1)
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	deleteDecodeAhead();
+}
+
 void VideoDecoder::close() {
+	// The worker must be done with the tracks before they are stopped
+	deleteDecodeAhead();
+
 	if (isPlaying())
 		stop();
 
@@ -185,6 +260,9 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if ((isDecodingAhead() || startDecodeAhead()) && fillDecodeAhead())
+		return dequeueFrame();
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -210,6 +288,10 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames decoded ahead are always decoded forwards
+	if (isDecodingAhead())
+		return !reverse;
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -230,6 +312,9 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (isDecodingAhead())
+		return _decodeAhead->curFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -275,7 +360,7 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getTrackNextFrameStartTime(_nextVideoTrack);
 
 	if (_nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
@@ -296,8 +381,8 @@ bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && getTrackNextFrameStartTime((const VideoTrack *)track) >= (uint)_endTime.msecs();
+		bool endReached = isTrackEnded(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return false;
 	}
@@ -320,6 +405,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	stopDecodeAhead();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -354,6 +441,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	stopDecodeAhead();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -861,7 +950,7 @@ const VideoDecoder::Track *VideoDecoder::getTrack(uint track) const {
 
 bool VideoDecoder::endOfVideoTracks() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack())
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !isTrackEnded(*it))
 			return false;
 
 	return true;
@@ -872,9 +961,9 @@ VideoDecoder::VideoTrack *VideoDecoder::findNextVideoTrack() {
 	uint32 bestTime = 0xFFFFFFFF;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack()) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !isTrackEnded(*it)) {
 			VideoTrack *track = (VideoTrack *)*it;
-			uint32 time = track->getNextFrameStartTime();
+			uint32 time = getTrackNextFrameStartTime(track);
 
 			if (time < bestTime) {
 				bestTime = time;
@@ -921,8 +1010,8 @@ bool VideoDecoder::hasFramesLeft() const {
 
 		const VideoTrack *track = (const VideoTrack *)*it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && getTrackNextFrameStartTime(track) >= (uint)_endTime.msecs();
+		bool endReached = isTrackEnded(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return true;
 	}
@@ -955,4 +1044,235 @@ void VideoDecoder::eraseTrack(Track *track) {
 	}
 }
 
+bool VideoDecoder::isDecodingAhead() const {
+	return _decodeAhead && _decodeAhead->track;
+}
+
+bool VideoDecoder::startDecodeAhead() {
+	if (_decodeAheadFrames == 0 || _decodeAheadFailed || !supportsDecodeAhead())
+		return false;
+
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// Frames of several video tracks would have to be interleaved
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track || track->isReversed() || track->endOfTrack())
+		return false;
+
+	if (!_decodeAhead)
+		_decodeAhead = new DecodeAheadQueue();
+
+	DecodeAheadQueue &queue = *_decodeAhead;
+
+	// The worker is started once, and then waits for packets until the
+	// video is closed
+	if (!queue.thread) {
+		queue.packetsReady = g_system->createSemaphore(0);
+		queue.framesReady = g_system->createSemaphore(0);
+
+		if (queue.packetsReady && queue.framesReady)
+			queue.thread = g_system->createThread(decodeAheadThread, this);
+
+		// Without threads, decoding into the ring would only add a copy, so
+		// decode directly from now on
+		if (!queue.thread) {
+			_decodeAheadFailed = true;
+			deleteDecodeAhead();
+			return false;
+		}
+	}
+
+	// Allocate the ring up front, the worker only resizes the surfaces if
+	// the track returns frames of another size
+	if (queue.frames.size() != _decodeAheadFrames + 1) {
+		for (uint i = 0; i < queue.frames.size(); i++)
+			queue.frames[i].surface.free();
+
+		queue.frames.resize(_decodeAheadFrames + 1);
+	}
+
+	for (uint i = 0; i < queue.frames.size(); i++) {
+		Graphics::Surface &surface = queue.frames[i].surface;
+
+		if (surface.w != track->getWidth() || surface.h != track->getHeight() || surface.format != track->getPixelFormat()) {
+			surface.free();
+			surface.create(track->getWidth(), track->getHeight(), track->getPixelFormat());
+		}
+	}
+
+	track->prepareDecodeAhead();
+
+	// The worker is idle, and posted framesReady for every packet it was
+	// handed, so it can be reset from here
+	queue.track = track;
+	queue.curFrame = track->getCurFrame();
+	queue.nextFrameStartTime = track->getNextFrameStartTime();
+	queue.endOfTrack = false;
+	queue.read = 0;
+	queue.count = 0;
+	queue.end = false;
+	queue.decode = 0;
+	return true;
+}
+
+bool VideoDecoder::fillDecodeAhead() {
+	DecodeAheadQueue &queue = *_decodeAhead;
+	VideoTrack *track = queue.track;
+
+	while (!queue.end && queue.count < queue.frames.size() - 1) {
+		VideoPacket *packet = readNextVideoPacket();
+
+		if (!packet) {
+			queue.end = true;
+			break;
+		}
+
+		DecodeAheadQueue::Frame &frame = queue.frames[(queue.read + queue.count) % queue.frames.size()];
+		frame.packet = packet;
+		frame.curFrame = track->getCurFrame();
+		frame.nextFrameStartTime = track->getNextFrameStartTime();
+		frame.endOfTrack = track->endOfTrack();
+
+		queue.end = frame.endOfTrack;
+		queue.count++;
+		g_system->postSemaphore(queue.packetsReady);
+	}
+
+	if (queue.count == 0) {
+		// The track ended without another frame, which the caller then
+		// gets from the track directly
+		stopDecodeAhead();
+		return false;
+	}
+
+	return true;
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	if (!isDecodingAhead())
+		return;
+
+	DecodeAheadQueue &queue = *_decodeAhead;
+
+	// Let the worker finish the packets it was handed, after which it is
+	// done with the track. The frames left in the ring are dropped, so the
+	// tracks are ahead of the caller unless they are seeked or have been
+	// fully presented.
+	for (; queue.count > 0; queue.count--)
+		g_system->waitSemaphore(queue.framesReady);
+
+	queue.track = 0;
+}
+
+void VideoDecoder::deleteDecodeAhead() {
+	if (!_decodeAhead)
+		return;
+
+	stopDecodeAhead();
+
+	DecodeAheadQueue &queue = *_decodeAhead;
+
+	if (queue.thread) {
+		queue.stop = true;
+		g_system->postSemaphore(queue.packetsReady);
+		g_system->joinThread(queue.thread);
+	}
+
+	if (queue.packetsReady)
+		g_system->deleteSemaphore(queue.packetsReady);
+	if (queue.framesReady)
+		g_system->deleteSemaphore(queue.framesReady);
+
+	delete _decodeAhead;
+	_decodeAhead = 0;
+}
+
+void VideoDecoder::decodeAheadThread(void *data) {
+	DecodeAheadQueue &queue = *((VideoDecoder *)data)->_decodeAhead;
+
+	while (true) {
+		g_system->waitSemaphore(queue.packetsReady);
+
+		if (queue.stop)
+			return;
+
+		DecodeAheadQueue::Frame &frame = queue.frames[queue.decode];
+		queue.decode = (queue.decode + 1) % queue.frames.size();
+
+		VideoTrack *track = queue.track;
+		const Graphics::Surface *surface = track->decodeVideoPacket(frame.packet);
+
+		delete frame.packet;
+		frame.packet = 0;
+
+		frame.hasSurface = surface != 0;
+		if (surface) {
+			if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+				frame.surface.free();
+				frame.surface.create(surface->w, surface->h, surface->format);
+			}
+
+			frame.surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+		}
+
+		frame.hasPalette = track->hasDirtyPalette();
+		if (frame.hasPalette)
+			memcpy(frame.palette, track->getPalette(), sizeof(frame.palette));
+
+		g_system->postSemaphore(queue.framesReady);
+	}
+}
+
+const Graphics::Surface *VideoDecoder::dequeueFrame() {
+	DecodeAheadQueue &queue = *_decodeAhead;
+
+	// Wait for the worker to finish the frame, rather than for a timer,
+	// which may cost a whole frame
+	g_system->waitSemaphore(queue.framesReady);
+
+	const DecodeAheadQueue::Frame &frame = queue.frames[queue.read];
+	queue.read = (queue.read + 1) % queue.frames.size();
+	queue.count--;
+
+	queue.curFrame = frame.curFrame;
+	queue.nextFrameStartTime = frame.nextFrameStartTime;
+	queue.endOfTrack = frame.endOfTrack;
+
+	if (frame.hasPalette) {
+		memcpy(queue.palette, frame.palette, sizeof(queue.palette));
+		_palette = queue.palette;
+		_dirtyPalette = true;
+	}
+
+	if (queue.endOfTrack) {
+		// The caller caught up with the track, so go back to using it directly
+		stopDecodeAhead();
+		findNextVideoTrack();
+	}
+
+	return frame.hasSurface ? &frame.surface : 0;
+}
+
+bool VideoDecoder::isTrackEnded(const Track *track) const {
+	if (isDecodingAhead() && track == _decodeAhead->track)
+		return _decodeAhead->endOfTrack;
+
+	return track->endOfTrack();
+}
+
+uint32 VideoDecoder::getTrackNextFrameStartTime(const VideoTrack *track) const {
+	if (isDecodingAhead() && track == _decodeAhead->track)
+		return _decodeAhead->nextFrameStartTime;
+
+	return track->getNextFrameStartTime();
+}
+
 } // End of namespace Video
@@ -52,7 +52,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -396,6 +396,31 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Decode frames ahead of time on a worker thread.
+	 *
+	 * Up to the given number of frames are decoded into a ring of surfaces
+	 * while the previous ones are shown, and decodeNextFrame() then only
+	 * hands over the next decoded frame. This smooths playback when decoding
+	 * a frame takes a good part of its display time.
+	 *
+	 * Packets are still read, and their audio queued, by decodeNextFrame().
+	 * The worker thread only decodes the video frames, and may log through
+	 * warning() and debug(), but must not use the rest of the OSystem API.
+	 *
+	 * This only has an effect on formats supporting it, for videos with a
+	 * single video track played forwards, on backends supporting threads.
+	 * Otherwise, frames are decoded when decodeNextFrame() is called.
+	 * Subclasses which override readNextPacket(), or access the video track
+	 * in decodeNextFrame(), must not enable this.
+	 *
+	 * This should be called before the first decodeNextFrame() call, and
+	 * remains set when another video is loaded.
+	 *
+	 * @param frames The number of frames to decode ahead, 0 to disable
+	 */
+	void setDecodeAhead(uint frames) { _decodeAheadFrames = frames; }
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -550,6 +575,15 @@ protected:
 		bool _paused;
 	};
 
+	/**
+	 * The data of a video frame, read by readNextVideoPacket() to be
+	 * decoded later by VideoTrack::decodeVideoPacket().
+	 */
+	class VideoPacket {
+	public:
+		virtual ~VideoPacket() {}
+	};
+
 	/**
 	 * An abstract representation of a video track.
 	 */
@@ -645,6 +679,24 @@ protected:
 		 * Activate dithering mode with a palette
 		 */
 		virtual void setDither(const byte *palette) {}
+
+		/**
+		 * Prepare for decoding frames ahead, before the worker thread is
+		 * started. Tracks build any tables their decoding creates lazily
+		 * here, e.g. those of YUVToRGBMan.
+		 */
+		virtual void prepareDecodeAhead() {}
+
+		/**
+		 * Decode a packet returned by VideoDecoder::readNextVideoPacket().
+		 *
+		 * This is called on the worker thread decoding frames ahead, while
+		 * the caller keeps reading the next packets. It must only use the
+		 * state needed to decode the pixels and the palette of the frame.
+		 *
+		 * @return the decoded frame, as returned by decodeNextFrame()
+		 */
+		virtual const Graphics::Surface *decodeVideoPacket(VideoPacket *packet) { return 0; }
 	};
 
 	/**
@@ -826,6 +878,28 @@ protected:
 	 */
 	virtual void readNextPacket() {}
 
+	/**
+	 * Does this video format support decoding frames ahead?
+	 *
+	 * Returning true implies readNextVideoPacket() and the
+	 * VideoTrack::decodeVideoPacket() of the video track are implemented.
+	 *
+	 * @see setDecodeAhead()
+	 */
+	virtual bool supportsDecodeAhead() const { return false; }
+
+	/**
+	 * Read the next packet for decoding frames ahead.
+	 *
+	 * This works like readNextPacket(), including queueing the audio and
+	 * moving the video track to the next frame, except that the video
+	 * frame is returned for the worker thread to decode, instead of being
+	 * decoded.
+	 *
+	 * @return the video packet, or 0 at the end of the video track
+	 */
+	virtual VideoPacket *readNextVideoPacket() { return 0; }
+
 	/**
 	 * Define a track to be used by this class.
 	 *
@@ -964,6 +1038,24 @@ private:
 	Audio::Mixer::SoundType _soundType;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Decoding frames ahead on a worker thread
+	struct DecodeAheadQueue;
+	uint _decodeAheadFrames;
+	bool _decodeAheadFailed;
+	DecodeAheadQueue *_decodeAhead;
+
+	bool isDecodingAhead() const;
+	bool startDecodeAhead();
+	bool fillDecodeAhead();
+	void stopDecodeAhead();
+	void deleteDecodeAhead();
+	const Graphics::Surface *dequeueFrame();
+	static void decodeAheadThread(void *data);
+
+	// Track state as seen by the caller, which lags behind while decoding ahead
+	bool isTrackEnded(const Track *track) const;
+	uint32 getTrackNextFrameStartTime(const VideoTrack *track) const;
 };
 
 } // End of namespace Video